@@ -759,6 +759,17 @@ DI_DEF size_t di_bit_length(di_int big);
  */
 DI_DEF size_t di_limb_count(di_int big);
 
+/**
+ * @brief Read-only view of the limbs of an integer's magnitude
+ * @param big Integer to query
+ * @param count Receives the number of limbs in use (0 for zero)
+ * @return Little-endian limbs, valid until big is modified or released
+ * @since 1.1.0
+ *
+ * @note Lets callers scan bits without building temporaries
+ */
+DI_DEF const di_limb_t* di_limbs(di_int big, size_t* count);
+
 /**
  * @brief Reserve capacity for an integer (performance optimization)
  * @param big Integer to resize (may be NULL)
@@ -1084,6 +1095,9 @@ static void di_resize_internal(struct di_int_internal* big, size_t new_capacity)
 /* Creation functions */
 
 DI_IMPL di_int di_from_int32(int32_t value) {
+#if DI_LIMB_BITS < 32
+    return di_from_int64(value);
+#else
     struct di_int_internal* big = di_alloc(1);
     DI_ASSERT(big && "di_from_int32: allocation failed");
     
@@ -1101,37 +1115,22 @@ DI_IMPL di_int di_from_int32(int32_t value) {
     big->limb_count = (value != 0) ? 1 : 0;
     
     return big;
+#endif
 }
 
 DI_IMPL di_int di_from_int64(int64_t value) {
-    struct di_int_internal* big = di_alloc(2);
+    // Magnitude via unsigned negation, which also covers INT64_MIN
+    uint64_t uval = value < 0 ? (uint64_t)0 - (uint64_t)value : (uint64_t)value;
+    di_int big = di_from_uint64(uval);
     DI_ASSERT(big && "di_from_int64: allocation failed");
-    
-    if (value < 0) {
-        big->is_negative = true;
-        // Handle INT64_MIN carefully
-        if (value == INT64_MIN) {
-            uint64_t uval = (uint64_t)INT64_MAX + 1;
-            big->limbs[0] = (di_limb_t)(uval & DI_LIMB_MAX);
-            big->limbs[1] = (di_limb_t)(uval >> DI_LIMB_BITS);
-        } else {
-            uint64_t uval = (uint64_t)(-value);
-            big->limbs[0] = (di_limb_t)(uval & DI_LIMB_MAX);
-            big->limbs[1] = (di_limb_t)(uval >> DI_LIMB_BITS);
-        }
-    } else {
-        uint64_t uval = (uint64_t)value;
-        big->limbs[0] = (di_limb_t)(uval & DI_LIMB_MAX);
-        big->limbs[1] = (di_limb_t)(uval >> DI_LIMB_BITS);
-    }
-    
-    big->limb_count = 2;
-    di_normalize(big);
-    
+    big->is_negative = value < 0;
     return big;
 }
 
 DI_IMPL di_int di_from_uint32(uint32_t value) {
+#if DI_LIMB_BITS < 32
+    return di_from_uint64(value);
+#else
     struct di_int_internal* big = di_alloc(1);
     DI_ASSERT(big && "di_from_uint32: allocation failed");
     
@@ -1140,15 +1139,19 @@ DI_IMPL di_int di_from_uint32(uint32_t value) {
     big->is_negative = false;
     
     return big;
+#endif
 }
 
 DI_IMPL di_int di_from_uint64(uint64_t value) {
-    struct di_int_internal* big = di_alloc(2);
+    size_t limbs = (64 + DI_LIMB_BITS - 1) / DI_LIMB_BITS;
+    struct di_int_internal* big = di_alloc(limbs);
     DI_ASSERT(big && "di_from_uint64: allocation failed");
     
-    big->limbs[0] = (di_limb_t)(value & DI_LIMB_MAX);
-    big->limbs[1] = (di_limb_t)(value >> DI_LIMB_BITS);
-    big->limb_count = 2;
+    for (size_t i = 0; i < limbs; i++) {
+        big->limbs[i] = (di_limb_t)(value & DI_LIMB_MAX);
+        value >>= DI_LIMB_BITS;
+    }
+    big->limb_count = limbs;
     big->is_negative = false;
     di_normalize(big);
     
@@ -1375,6 +1378,18 @@ DI_IMPL bool di_is_one(di_int big) {
 
 /* Conversion functions */
 
+// Magnitude as uint64_t, or false if it needs more than 64 bits
+static bool di_magnitude_u64(di_int big, uint64_t* result) {
+    if (big->limb_count > 64 / DI_LIMB_BITS) return false;
+    
+    uint64_t val = 0;
+    for (size_t i = 0; i < big->limb_count; i++) {
+        val |= (uint64_t)big->limbs[i] << (i * DI_LIMB_BITS);
+    }
+    *result = val;
+    return true;
+}
+
 DI_IMPL bool di_to_int32(di_int big, int32_t* result) {
     DI_ASSERT(big && "di_to_int32: integer cannot be NULL");
     DI_ASSERT(result && "di_to_int32: result pointer cannot be NULL");
@@ -1384,13 +1399,12 @@ DI_IMPL bool di_to_int32(di_int big, int32_t* result) {
         return true;
     }
     
-    if (big->limb_count > 1) return false;
-    
-    di_limb_t val = big->limbs[0];
+    uint64_t val;
+    if (!di_magnitude_u64(big, &val)) return false;
     
     if (big->is_negative) {
-        if (val > (di_limb_t)INT32_MAX + 1) return false;
-        if (val == (di_limb_t)INT32_MAX + 1) {
+        if (val > (uint64_t)INT32_MAX + 1) return false;
+        if (val == (uint64_t)INT32_MAX + 1) {
             *result = INT32_MIN;
         } else {
             *result = -(int32_t)val;
@@ -1412,12 +1426,8 @@ DI_IMPL bool di_to_int64(di_int big, int64_t* result) {
         return true;
     }
     
-    if (big->limb_count > 2) return false;
-    
-    uint64_t val = big->limbs[0];
-    if (big->limb_count == 2) {
-        val |= ((uint64_t)big->limbs[1] << DI_LIMB_BITS);
-    }
+    uint64_t val;
+    if (!di_magnitude_u64(big, &val)) return false;
     
     if (big->is_negative) {
         if (val > (uint64_t)INT64_MAX + 1) return false;
@@ -1477,15 +1487,7 @@ DI_IMPL bool di_to_uint64(di_int big, uint64_t* result) {
     if (big->is_negative) return false;
     
     // Check if value fits in uint64
-    if (big->limb_count > 2) return false;
-    
-    uint64_t val = big->limbs[0];
-    if (big->limb_count == 2) {
-        val |= ((uint64_t)big->limbs[1] << DI_LIMB_BITS);
-    }
-    
-    *result = val;
-    return true;
+    return di_magnitude_u64(big, result);
 }
 
 DI_IMPL double di_to_double(di_int big) {
@@ -2618,6 +2620,14 @@ DI_IMPL size_t di_limb_count(di_int big) {
     return big->limb_count;
 }
 
+// Limbs in use, read in place
+DI_IMPL const di_limb_t* di_limbs(di_int big, size_t* count) {
+    DI_ASSERT(big && "di_limbs: operand cannot be NULL");
+    DI_ASSERT(count && "di_limbs: count cannot be NULL");
+    *count = big->limb_count;
+    return big->limbs;
+}
+
 // Extended Euclidean Algorithm: finds gcd(a,b) and coefficients x,y such that ax + by = gcd(a,b)
 DI_IMPL di_int di_extended_gcd(di_int a, di_int b, di_int* x, di_int* y) {
     DI_ASSERT(a && "di_extended_gcd: first operand cannot be NULL");
@@ -0,0 +1,239 @@
+/**
+ * @file df_replay.c
+ * @brief Re-execute a DF_TRACE recording and report throughput per opcode
+ *
+ * Usage: df_replay TRACE [ROUNDS]
+ *
+ * The trace is loaded into memory and replayed ROUNDS times (default 1)
+ * against the library this tool is built with. Comparison results are
+ * checked against the recorded ones, so a replay also catches behavior
+ * changes. The exit status is nonzero for a malformed trace or any
+ * mismatch.
+ */
+
+#define DF_IMPLEMENTATION
+#define DI_IMPLEMENTATION
+#include "dynamic_fraction.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+    const uint8_t* pos;
+    const uint8_t* end;
+    bool bad;
+} reader;
+
+typedef struct {
+    df_frac* slots;
+    size_t capacity;
+} frac_table;
+
+static const char* const op_names[DF_TRACE_OP_COUNT] = {
+    "", "value", "add", "sub", "mul", "div", "negate", "abs", "reciprocal", "cmp", "eq", "release",
+};
+
+// Helper: Monotonic time in nanoseconds
+static uint64_t now_ns(void) {
+    struct timespec ts;
+#ifdef CLOCK_MONOTONIC
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+    timespec_get(&ts, TIME_UTC);
+#endif
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// Helper: Read a LEB128 varint
+static uint64_t read_varint(reader* r) {
+    uint64_t v = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        if (r->pos >= r->end) break;
+        uint8_t byte = *r->pos++;
+        v |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return v;
+    }
+    r->bad = true;
+    return 0;
+}
+
+static int64_t read_zigzag(reader* r) {
+    uint64_t v = read_varint(r);
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+// Helper: Slot for an id, growing the table as ids appear
+static df_frac* table_slot(frac_table* t, uint64_t id) {
+    if (id >= t->capacity) {
+        size_t capacity = t->capacity ? t->capacity : 1024;
+        while (capacity <= id) capacity *= 2;
+        t->slots = (df_frac*)realloc(t->slots, sizeof(df_frac) * capacity);
+        if (!t->slots) {
+            fprintf(stderr, "df_replay: out of memory\n");
+            exit(2);
+        }
+        memset(t->slots + t->capacity, 0, sizeof(df_frac) * (capacity - t->capacity));
+        t->capacity = capacity;
+    }
+    return &t->slots[id];
+}
+
+// Helper: Operand by id, or NULL (and the trace marked bad) if unknown
+static df_frac table_get(frac_table* t, reader* r, uint64_t id) {
+    df_frac f = id < t->capacity ? t->slots[id] : NULL;
+    if (!f) r->bad = true;
+    return f;
+}
+
+// Helper: Bind a result to its id; a recorded id that is still bound was a
+// shared instance, so the recomputed copy is dropped
+static void table_bind(frac_table* t, uint64_t id, df_frac f) {
+    df_frac* slot = table_slot(t, id);
+    if (*slot) {
+        df_release(&f);
+    } else {
+        *slot = f;
+    }
+}
+
+// Helper: Read the value of a DF_TRACE_VALUE record
+static df_frac read_value(reader* r) {
+    uint8_t kind = r->pos < r->end ? *r->pos++ : 0xff;
+    if (kind == 0) {
+        int64_t num = read_zigzag(r);
+        int64_t den = read_zigzag(r);
+        if (r->bad || den == 0) return NULL;
+        return df_from_ints(num, den);
+    }
+    if (kind == 1) {
+        uint64_t len = read_varint(r);
+        if (r->bad || len > (uint64_t)(r->end - r->pos)) return NULL;
+        char* text = (char*)malloc(len + 1);
+        memcpy(text, r->pos, len);
+        text[len] = '\0';
+        r->pos += len;
+        df_frac f = df_from_string(text);
+        free(text);
+        return f;
+    }
+    return NULL;
+}
+
+// Helper: Replay one pass, adding time and counts per opcode
+static bool replay(const uint8_t* data, size_t size, uint64_t* counts, uint64_t* ns, uint64_t* mismatches) {
+    reader r = {data + 8, data + size, false};
+    frac_table t = {NULL, 0};
+
+    while (r.pos < r.end && !r.bad) {
+        uint8_t op = *r.pos++;
+        if (op == DF_TRACE_VALUE) {
+            uint64_t id = read_varint(&r);
+            df_frac f = read_value(&r);
+            if (!f) {
+                r.bad = true;
+                break;
+            }
+            table_bind(&t, id, f);
+            continue;
+        }
+        if (op == DF_TRACE_RELEASE) {
+            uint64_t id = read_varint(&r);
+            df_release(table_slot(&t, id));
+            continue;
+        }
+
+        uint64_t ia = read_varint(&r);
+        bool binary = (op >= DF_TRACE_ADD && op <= DF_TRACE_DIV) || op == DF_TRACE_CMP || op == DF_TRACE_EQ;
+        uint64_t ib = binary ? read_varint(&r) : 0;
+        uint64_t last = read_varint(&r);
+        df_frac a = table_get(&t, &r, ia);
+        df_frac b = ib ? table_get(&t, &r, ib) : NULL;
+        if (r.bad) break;
+
+        df_frac result = NULL;
+        int outcome = 0;
+        uint64_t start = now_ns();
+        switch (op) {
+            case DF_TRACE_ADD: result = df_add(a, b); break;
+            case DF_TRACE_SUB: result = df_sub(a, b); break;
+            case DF_TRACE_MUL: result = df_mul(a, b); break;
+            case DF_TRACE_DIV: result = df_div(a, b); break;
+            case DF_TRACE_NEGATE: result = df_negate(a); break;
+            case DF_TRACE_ABS: result = df_abs(a); break;
+            case DF_TRACE_RECIPROCAL: result = df_reciprocal(a); break;
+            case DF_TRACE_CMP: outcome = df_cmp(a, b); break;
+            case DF_TRACE_EQ: outcome = df_eq(a, b); break;
+            default: r.bad = true; continue;
+        }
+        ns[op] += now_ns() - start;
+        counts[op]++;
+
+        if (op == DF_TRACE_CMP || op == DF_TRACE_EQ) {
+            int64_t recorded = (int64_t)(last >> 1) ^ -(int64_t)(last & 1);
+            if (recorded != outcome) (*mismatches)++;
+        } else {
+            table_bind(&t, last, result);
+        }
+    }
+
+    for (size_t i = 0; i < t.capacity; i++) df_release(&t.slots[i]);
+    free(t.slots);
+    return !r.bad;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "usage: %s TRACE [ROUNDS]\n", argv[0]);
+        return 2;
+    }
+    long rounds = argc == 3 ? strtol(argv[2], NULL, 10) : 1;
+    if (rounds < 1) rounds = 1;
+
+    FILE* in = fopen(argv[1], "rb");
+    if (!in) {
+        perror(argv[1]);
+        return 2;
+    }
+    fseek(in, 0, SEEK_END);
+    long size = ftell(in);
+    rewind(in);
+    uint8_t* data = (uint8_t*)malloc(size > 0 ? (size_t)size : 1);
+    if (size < 8 || fread(data, 1, (size_t)size, in) != (size_t)size || memcmp(data, "DFTRACE1", 8) != 0) {
+        fprintf(stderr, "%s: not a dynamic_fraction trace\n", argv[1]);
+        fclose(in);
+        free(data);
+        return 2;
+    }
+    fclose(in);
+
+    uint64_t counts[DF_TRACE_OP_COUNT] = {0};
+    uint64_t ns[DF_TRACE_OP_COUNT] = {0};
+    uint64_t mismatches = 0;
+    for (long i = 0; i < rounds; i++) {
+        if (!replay(data, (size_t)size, counts, ns, &mismatches)) {
+            fprintf(stderr, "%s: malformed trace\n", argv[1]);
+            free(data);
+            return 2;
+        }
+    }
+    free(data);
+
+    uint64_t total_count = 0, total_ns = 0;
+    printf("%-12s %12s %12s %10s %14s\n", "op", "count", "total ms", "ns/op", "ops/s");
+    for (int op = DF_TRACE_ADD; op < DF_TRACE_RELEASE; op++) {
+        if (counts[op] == 0) continue;
+        total_count += counts[op];
+        total_ns += ns[op];
+        printf("%-12s %12llu %12.3f %10.1f %14.0f\n", op_names[op], (unsigned long long)counts[op],
+               (double)ns[op] / 1e6, (double)ns[op] / (double)counts[op],
+               (double)counts[op] * 1e9 / (ns[op] ? (double)ns[op] : 1.0));
+    }
+    printf("%-12s %12llu %12.3f\n", "total", (unsigned long long)total_count, (double)total_ns / 1e6);
+
+    if (mismatches) {
+        printf("%llu comparison results differ from the trace\n", (unsigned long long)mismatches);
+        return 1;
+    }
+    return 0;
+}
@@ -20,6 +20,7 @@
  * @code
  * #define DF_MALLOC malloc         // custom allocator
  * #define DF_FREE free             // custom deallocator
+ * #define DF_REALLOC realloc       // custom reallocator
  * #define DF_ASSERT assert         // custom assert macro
  *
  * #define DF_IMPLEMENTATION
@@ -64,10 +65,30 @@
 #define DF_FREE free
 #endif
 
+#ifndef DF_REALLOC
+#define DF_REALLOC realloc
+#endif
+
 #ifndef DF_ASSERT
 #define DF_ASSERT assert
 #endif
 
+// Latency histograms live in the per-thread statistics blocks
+#if defined(DF_LATENCY) && !defined(DF_STATS)
+#define DF_STATS
+#endif
+
+// Interned instances are shared by every holder of a value, and reference
+// counts are not atomic
+#if defined(DF_INTERN) && defined(DF_THREADS)
+#error "DF_INTERN cannot be combined with DF_THREADS"
+#endif
+
+// Trace ids and the trace file are global and unsynchronized
+#if defined(DF_TRACE) && defined(DF_THREADS)
+#error "DF_TRACE cannot be combined with DF_THREADS"
+#endif
+
 // API macros
 #ifdef DF_STATIC
 #define DF_DEF static
@@ -87,11 +108,36 @@
  *
  * Represents a fraction as numerator/denominator with reference counting.
  * The fraction is always kept in reduced form (lowest terms).
+ *
+ * A double approximation with an absolute error bound is computed lazily
+ * the first time it is needed. Comparisons use it as a filter and only fall
+ * back to exact cross-multiplication when the two intervals overlap.
+ *
+ * Fractions whose denominator is a power of two (integers included) are
+ * flagged as dyadic. Arithmetic between dyadic fractions aligns exponents
+ * with shifts and reduces by stripping trailing zero bits, skipping
+ * di_gcd() and di_div() entirely.
+ *
+ * When compiled with DF_INTERN, every constructed fraction is looked up
+ * in a global table and deduplicated, so each value has exactly one live
+ * instance. df_eq() becomes pointer equality and df_hash() a cached
+ * field. An entry leaves the table when its last reference is released.
+ * The table is not synchronized, so DF_INTERN excludes DF_THREADS.
  */
 struct df_frac_internal {
     di_int numerator;    /**< Numerator (can be negative) */
     di_int denominator;  /**< Denominator (always positive) */
     size_t ref_count;    /**< Reference count for memory management */
+    double approx;       /**< Cached double approximation (valid when has_approx) */
+    double approx_err;   /**< Absolute error bound of approx (INFINITY if unusable) */
+    bool has_approx;     /**< True once approx and approx_err are computed */
+    bool is_dyadic;      /**< Denominator is a power of two */
+    size_t den_log2;     /**< log2(denominator) when is_dyadic */
+    uint64_t hash;       /**< Cached df_hash() (0 until computed) */
+#ifdef DF_TRACE
+    uint64_t trace_id;   /**< Id in the open trace (valid when trace_session matches) */
+    uint64_t trace_session; /**< Trace the id belongs to (0 for none) */
+#endif
 };
 
 /**
@@ -159,6 +205,15 @@ DF_DEF df_frac df_retain(df_frac f);
  */
 DF_DEF void df_release(df_frac* f);
 
+#ifdef DF_INTERN
+/**
+ * @brief Number of distinct values currently interned
+ * @return Live entries in the global table (DF_INTERN builds only)
+ * @since 1.1.0
+ */
+DF_DEF size_t df_intern_size(void);
+#endif
+
 /** @} */ // end of lifecycle
 
 /**
@@ -426,6 +481,29 @@ DF_DEF df_frac df_neg_one(void);
  */
 DF_DEF df_frac df_pow(df_frac base, int64_t exponent);
 
+/**
+ * @brief Multiply a fraction by a power of two
+ * @param f Input fraction
+ * @param exp Binary exponent (may be negative)
+ * @return New df_frac with f * 2^exp
+ *
+ * Factors of two are cancelled against the other component with shifts,
+ * so no multiplication, division or GCD is performed.
+ * @since 1.1.0
+ */
+DF_DEF df_frac df_ldexp(df_frac f, int64_t exp);
+
+/**
+ * @brief Split a fraction into a mantissa and a power of two
+ * @param f Input fraction
+ * @param exp Receives the binary exponent
+ * @return New df_frac m with 1/2 <= |m| < 1 and f == m * 2^exp
+ *
+ * Like C frexp(), zero yields a zero mantissa and an exponent of 0.
+ * @since 1.1.0
+ */
+DF_DEF df_frac df_frexp(df_frac f, int64_t* exp);
+
 /**
  * @brief Floor function - greatest integer ≤ f
  * @param f Input fraction
@@ -490,6 +568,10 @@ DF_DEF df_frac df_max(df_frac a, df_frac b);
  * @param f Input fraction
  * @return Hash value suitable for hash tables
  * @since 1.1.0
+ *
+ * Equal values hash equally, and the value does not depend on
+ * DI_LIMB_BITS. It may change between library versions, so do not persist
+ * it.
  */
 DF_DEF uint64_t df_hash(df_frac f);
 
@@ -536,803 +618,7842 @@ DF_DEF df_frac df_fractional_part(df_frac f);
 /** @} */ // end of extended
 
 // ============================================================================
-// IMPLEMENTATION
+// SERIES SUMMATION
 // ============================================================================
 
-#ifdef DF_IMPLEMENTATION
+/**
+ * @defgroup series Exact Series Summation
+ * @brief Binary-splitting evaluation of exact rational series
+ *
+ * Summing a series term by term with df_add() pays a full GCD per term and
+ * lets operands grow quadratically. These functions instead combine ranges
+ * of terms as unreduced integer triples (P, Q, T) over a balanced recursion
+ * tree and perform a single reduction at the end.
+ *
+ * Term callbacks receive the index k and a user context pointer. The
+ * di_int flavour must return a new reference (released by the engine).
+ * With the int64_t flavour, ranges are combined in machine integers and
+ * only move to di_int once a product or sum would overflow.
+ *
+ * @code
+ * static int64_t one(int64_t k, void* ctx) { return 1; }
+ * static int64_t square(int64_t k, void* ctx) { return k * k; }
+ *
+ * df_frac s = df_series_sum_i64(1, 11, one, square, NULL);  // sum 1/k^2, k=1..10
+ * df_release(&s);
+ * @endcode
+ * @{
+ */
 
-#include <stdlib.h>
-#include <string.h>
-#include <math.h>
-#include <assert.h>
-#include <stdio.h>
+/**
+ * @typedef df_term_fn
+ * @brief Series term callback returning an arbitrary precision integer
+ *
+ * Must return a new di_int reference for index k; the engine releases it.
+ */
+typedef di_int (*df_term_fn)(int64_t k, void* ctx);
 
-// Helper: Allocate a new fraction structure
-static df_frac df_alloc(void) {
-    df_frac f = (df_frac)DF_MALLOC(sizeof(struct df_frac_internal));
-    DF_ASSERT(f && "df_alloc: memory allocation failed");
-    f->numerator = NULL;
-    f->denominator = NULL;
-    f->ref_count = 1;
-    return f;
-}
+/**
+ * @typedef df_term_i64_fn
+ * @brief Series term callback returning a machine integer
+ */
+typedef int64_t (*df_term_i64_fn)(int64_t k, void* ctx);
 
-// Helper: Reduce fraction to lowest terms
-static void df_reduce(df_frac f) {
-    DF_ASSERT(f && "df_reduce: fraction cannot be NULL");
-    DF_ASSERT(f->numerator && "df_reduce: numerator cannot be NULL");
-    DF_ASSERT(f->denominator && "df_reduce: denominator cannot be NULL");
+/**
+ * @brief Sum p(k)/q(k) for k in [a, b)
+ * @param a First index (inclusive)
+ * @param b Last index (exclusive)
+ * @param p Numerator callback
+ * @param q Denominator callback (must never return zero)
+ * @param ctx User context passed to both callbacks
+ * @return New df_frac with the exact sum (zero for an empty range)
+ * @since 1.1.0
+ */
+DF_DEF df_frac df_series_sum(int64_t a, int64_t b, df_term_fn p, df_term_fn q, void* ctx);
 
-    // Get GCD of numerator and denominator
-    di_int gcd = di_gcd(f->numerator, f->denominator);
-    if (!gcd || di_is_one(gcd)) {
-        di_release(&gcd);
-        return;
-    }
+/**
+ * @brief Sum p(k)/q(k) for k in [a, b) with int64_t callbacks
+ * @param a First index (inclusive)
+ * @param b Last index (exclusive)
+ * @param p Numerator callback
+ * @param q Denominator callback (must never return zero)
+ * @param ctx User context passed to both callbacks
+ * @return New df_frac with the exact sum (zero for an empty range)
+ * @since 1.1.0
+ */
+DF_DEF df_frac df_series_sum_i64(int64_t a, int64_t b, df_term_i64_fn p, df_term_i64_fn q, void* ctx);
 
-    // Divide both by GCD
-    di_int new_num = di_div(f->numerator, gcd);
-    di_int new_den = di_div(f->denominator, gcd);
+/**
+ * @brief Sum a hypergeometric-style series given by its term ratio
+ * @param a First index (inclusive)
+ * @param b Last index (exclusive)
+ * @param p Ratio numerator callback
+ * @param q Ratio denominator callback (must never return zero)
+ * @param ctx User context passed to both callbacks
+ * @return New df_frac with the exact sum (zero for an empty range)
+ * @since 1.1.0
+ *
+ * Evaluates sum over k in [a, b) of prod over j in [a, k] of p(j)/q(j),
+ * i.e. a series whose first term is p(a)/q(a) and whose consecutive terms
+ * have ratio p(k)/q(k).
+ */
+DF_DEF df_frac df_series_hypergeometric(int64_t a, int64_t b, df_term_fn p, df_term_fn q, void* ctx);
 
-    di_release(&f->numerator);
-    di_release(&f->denominator);
-    f->numerator = new_num;
-    f->denominator = new_den;
+/**
+ * @brief Hypergeometric-style series with int64_t ratio callbacks
+ * @param a First index (inclusive)
+ * @param b Last index (exclusive)
+ * @param p Ratio numerator callback
+ * @param q Ratio denominator callback (must never return zero)
+ * @param ctx User context passed to both callbacks
+ * @return New df_frac with the exact sum (zero for an empty range)
+ * @since 1.1.0
+ */
+DF_DEF df_frac df_series_hypergeometric_i64(int64_t a, int64_t b, df_term_i64_fn p, df_term_i64_fn q,
+                                            void* ctx);
 
-    di_release(&gcd);
-}
+/**
+ * @brief Harmonic number H(n) = 1 + 1/2 + ... + 1/n
+ * @param n Number of terms (H(n) = 0 for n <= 0)
+ * @return New df_frac with H(n)
+ * @since 1.1.0
+ */
+DF_DEF df_frac df_harmonic(int64_t n);
 
-// Helper: Ensure denominator is positive (move sign to numerator)
-static void df_normalize_sign(df_frac f) {
-    DF_ASSERT(f && "df_normalize_sign: fraction cannot be NULL");
-    DF_ASSERT(f->denominator && "df_normalize_sign: denominator cannot be NULL");
+/**
+ * @brief Bernoulli number B(n)
+ * @param n Index (B(1) = -1/2 convention)
+ * @return New df_frac with B(n)
+ * @since 1.1.0
+ */
+DF_DEF df_frac df_bernoulli(uint32_t n);
 
-    if (di_is_negative(f->denominator)) {
-        di_int neg_num = di_negate(f->numerator);
-        di_int neg_den = di_negate(f->denominator);
+/** @} */ // end of series
 
-        di_release(&f->numerator);
-        di_release(&f->denominator);
-        f->numerator = neg_num;
-        f->denominator = neg_den;
-    }
-}
+// ============================================================================
+// CONTINUED FRACTIONS
+// ============================================================================
 
-// Create fraction from int64 values
-DF_IMPL df_frac df_from_ints(int64_t numerator, int64_t denominator) {
-    DF_ASSERT(denominator != 0 && "df_from_ints: denominator cannot be zero");
+/**
+ * @defgroup contfrac Continued Fractions
+ * @brief Continued-fraction expansion and convergents
+ *
+ * Expansions are in canonical form [a0; a1, a2, ...] with a0 = floor(f)
+ * and a1, a2, ... >= 1. The Euclidean steps run on machine integers as
+ * soon as the remaining numerator and denominator fit in int64_t.
+ *
+ * @code
+ * df_frac f = df_from_ints(415, 93);
+ * df_cf_iter it;
+ * di_int term;
+ * df_frac conv;
+ *
+ * df_cf_iter_init(&it, f);
+ * while (df_cf_iter_next(&it, &term, &conv)) {
+ *     // term: 4, 2, 6, 7   conv: 4, 9/2, 58/13, 415/93
+ *     di_release(&term);
+ *     df_release(&conv);
+ * }
+ * df_cf_iter_free(&it);
+ * df_release(&f);
+ * @endcode
+ * @{
+ */
 
-    df_frac f = df_alloc();
-    DF_ASSERT(f && "df_from_ints: allocation failed");
+/**
+ * @struct df_cf_iter
+ * @brief Incremental continued-fraction state
+ *
+ * Holds the Euclidean remainder pair and the last two convergents. Each pair
+ * is kept in int64_t form while it fits and as di_int otherwise.
+ */
+typedef struct df_cf_iter {
+    di_int num;              /**< Remaining numerator (big form, or NULL) */
+    di_int den;              /**< Remaining denominator (big form, or NULL) */
+    int64_t small_num;       /**< Remaining numerator (small form) */
+    int64_t small_den;       /**< Remaining denominator (small form) */
+    di_int h[2];             /**< Convergent numerators h(n-2), h(n-1) (big form, or NULL) */
+    di_int k[2];             /**< Convergent denominators k(n-2), k(n-1) (big form, or NULL) */
+    int64_t small_h[2];      /**< Convergent numerators (small form) */
+    int64_t small_k[2];      /**< Convergent denominators (small form) */
+    bool done;               /**< True once the expansion is exhausted */
+} df_cf_iter;
 
-    f->numerator = di_from_int64(numerator);
-    f->denominator = di_from_int64(denominator);
+/**
+ * @brief Expand a fraction into its continued fraction
+ * @param f Fraction to expand
+ * @param terms_out Array receiving partial quotients (caller releases each)
+ * @param max Capacity of terms_out
+ * @return Number of terms written (the expansion is truncated at max)
+ * @since 1.1.0
+ */
+DF_DEF size_t df_to_cf(df_frac f, di_int* terms_out, size_t max);
 
-    if (!f->numerator || !f->denominator) {
-        di_release(&f->numerator);
-        di_release(&f->denominator);
-        DF_FREE(f);
-        return NULL;
-    }
+/**
+ * @brief Rebuild a fraction from continued-fraction terms
+ * @param terms Partial quotients [a0; a1, ..., a(n-1)]
+ * @param n Number of terms (must be at least 1)
+ * @return New df_frac with the value of the continued fraction
+ * @since 1.1.0
+ *
+ * Uses a balanced product tree of the 2x2 term matrices. The result is
+ * already in lowest terms, so no GCD is computed.
+ */
+DF_DEF df_frac df_from_cf(const di_int* terms, size_t n);
 
-    df_normalize_sign(f);
-    df_reduce(f);
-    return f;
-}
+/**
+ * @brief Start iterating the continued fraction of f
+ * @param it Iterator to initialize
+ * @param f Fraction to expand
+ * @since 1.1.0
+ */
+DF_DEF void df_cf_iter_init(df_cf_iter* it, df_frac f);
 
-// Create fraction from di_int values
-DF_IMPL df_frac df_from_di(di_int numerator, di_int denominator) {
-    DF_ASSERT(numerator && "df_from_di: numerator cannot be NULL");
-    DF_ASSERT(denominator && !di_is_zero(denominator) && "df_from_di: denominator cannot be zero");
+/**
+ * @brief Produce the next partial quotient and convergent
+ * @param it Iterator
+ * @param term Receives the partial quotient (may be NULL; caller releases)
+ * @param convergent Receives the convergent (may be NULL; caller releases)
+ * @return false once the expansion is exhausted
+ * @since 1.1.0
+ */
+DF_DEF bool df_cf_iter_next(df_cf_iter* it, di_int* term, df_frac* convergent);
 
-    df_frac f = df_alloc();
-    DF_ASSERT(f && "df_from_ints: allocation failed");
+/**
+ * @brief Release resources held by an iterator
+ * @param it Iterator
+ * @since 1.1.0
+ */
+DF_DEF void df_cf_iter_free(df_cf_iter* it);
 
-    f->numerator = di_retain(numerator);
-    f->denominator = di_retain(denominator);
+/** @} */ // end of contfrac
 
-    df_normalize_sign(f);
-    df_reduce(f);
-    return f;
-}
+// ============================================================================
+// DECIMAL FIXED-SCALE NUMBERS
+// ============================================================================
 
-// Create fraction from integer
-DF_IMPL df_frac df_from_int(int64_t value) {
-    return df_from_ints(value, 1);
-}
+/**
+ * @defgroup decimal Decimal Fixed-Scale Numbers
+ * @brief Exact decimals (denominator 10^k) with integer-speed arithmetic
+ *
+ * A df_decimal stores a coefficient and a scale and represents
+ * coefficient * 10^-scale. Addition aligns scales by powers of ten and
+ * results are normalized by stripping trailing zeros, so no GCD is ever
+ * computed. The coefficient stays in int64_t while it fits and moves to a
+ * di_int otherwise. Decimals are reference counted like df_frac.
+ *
+ * @code
+ * df_decimal price = df_decimal_from_string("19.99");
+ * df_decimal qty = df_decimal_from_int(3, 0);
+ * df_decimal total = df_decimal_mul(price, qty);   // 59.97
+ *
+ * char* str = df_decimal_to_string(total);
+ * free(str);
+ *
+ * df_decimal_release(&price);
+ * df_decimal_release(&qty);
+ * df_decimal_release(&total);
+ * @endcode
+ * @{
+ */
 
-// Create fraction from double using continued fractions
-DF_IMPL df_frac df_from_double(double value, int64_t max_denominator) {
-    if (isnan(value) || isinf(value)) return NULL;
-    if (max_denominator <= 0) max_denominator = INT64_MAX;
+/**
+ * @struct df_decimal_internal
+ * @brief Internal structure for a decimal number
+ *
+ * Always normalized: scale >= 0, no trailing zeros in the coefficient while
+ * scale > 0, and big == NULL whenever the coefficient fits in int64_t.
+ */
+struct df_decimal_internal {
+    int64_t coeff;       /**< Coefficient when it fits (big == NULL) */
+    di_int big;          /**< Coefficient in big form, or NULL */
+    int32_t scale;       /**< Number of decimal places */
+    size_t ref_count;    /**< Reference count for memory management */
+};
 
-    // Handle negative values
-    bool negative = value < 0;
-    if (negative) value = -value;
+/**
+ * @typedef df_decimal
+ * @brief Opaque pointer to a decimal number
+ */
+typedef struct df_decimal_internal* df_decimal;
 
-    // Continued fraction algorithm
-    int64_t h0 = 0, h1 = 1;
-    int64_t k0 = 1, k1 = 0;
-    double x = value;
+/**
+ * @brief Create a decimal coeff * 10^-scale
+ * @param coeff Coefficient
+ * @param scale Number of decimal places (must be >= 0)
+ * @return New df_decimal
+ * @since 1.1.0
+ */
+DF_DEF df_decimal df_decimal_from_int(int64_t coeff, int32_t scale);
 
-    while (k1 <= max_denominator) {
-        int64_t a = (int64_t)floor(x);
-        int64_t h2 = a * h1 + h0;
-        int64_t k2 = a * k1 + k0;
+/**
+ * @brief Parse a decimal string such as "-12.340"
+ * @param str String to parse (optional sign, digits, optional fraction)
+ * @return New df_decimal or NULL on parse error
+ * @since 1.1.0
+ */
+DF_DEF df_decimal df_decimal_from_string(const char* str);
 
-        if (k2 > max_denominator) break;
+/**
+ * @brief Convert a fraction whose denominator divides a power of ten
+ * @param f Fraction to convert
+ * @return New df_decimal, or NULL if f has no finite decimal expansion
+ * @since 1.1.0
+ */
+DF_DEF df_decimal df_decimal_from_frac(df_frac f);
 
-        h0 = h1; h1 = h2;
-        k0 = k1; k1 = k2;
+/**
+ * @brief Convert a decimal to a fraction
+ * @param d Decimal to convert
+ * @return New df_frac with the same value
+ * @since 1.1.0
+ */
+DF_DEF df_frac df_decimal_to_frac(df_decimal d);
 
-        if (fabs(value - (double)h1 / (double)k1) < 1e-15) break;
+/**
+ * @brief Convert to string
+ * @param d Decimal to convert
+ * @return Allocated string such as "-0.005" (caller must free)
+ * @since 1.1.0
+ */
+DF_DEF char* df_decimal_to_string(df_decimal d);
 
-        x = 1.0 / (x - a);
-        if (x > 1e15) break; // Avoid overflow
-    }
+/**
+ * @brief Get the coefficient
+ * @param d Decimal
+ * @return Coefficient as di_int (caller must release)
+ * @since 1.1.0
+ */
+DF_DEF di_int df_decimal_coefficient(df_decimal d);
 
-    return df_from_ints(negative ? -h1 : h1, k1);
-}
+/**
+ * @brief Get the scale (number of decimal places after normalization)
+ * @param d Decimal
+ * @return Scale
+ * @since 1.1.0
+ */
+DF_DEF int32_t df_decimal_scale(df_decimal d);
 
-// Copy a fraction
-DF_IMPL df_frac df_copy(df_frac f) {
-    DF_ASSERT(f && "df_copy: fraction cannot be NULL");
-    di_int num = di_retain(f->numerator);
-    di_int den = di_retain(f->denominator);
-    df_frac result = df_from_di(num, den);
-    di_release(&num);
-    di_release(&den);
-    return result;
-}
+/**
+ * @brief Add two decimals
+ * @param a First decimal
+ * @param b Second decimal
+ * @return New df_decimal with a + b
+ * @since 1.1.0
+ */
+DF_DEF df_decimal df_decimal_add(df_decimal a, df_decimal b);
 
-// Retain (increase reference count)
-DF_IMPL df_frac df_retain(df_frac f) {
-    DF_ASSERT(f && "df_retain: fraction cannot be NULL");
-    f->ref_count++;
-    return f;
+/**
+ * @brief Subtract two decimals
+ * @param a First decimal
+ * @param b Second decimal
+ * @return New df_decimal with a - b
+ * @since 1.1.0
+ */
+DF_DEF df_decimal df_decimal_sub(df_decimal a, df_decimal b);
+
+/**
+ * @brief Multiply two decimals
+ * @param a First decimal
+ * @param b Second decimal
+ * @return New df_decimal with a * b
+ * @since 1.1.0
+ */
+DF_DEF df_decimal df_decimal_mul(df_decimal a, df_decimal b);
+
+/**
+ * @brief Negate a decimal
+ * @param d Decimal
+ * @return New df_decimal with -d
+ * @since 1.1.0
+ */
+DF_DEF df_decimal df_decimal_negate(df_decimal d);
+
+/**
+ * @brief Compare two decimals
+ * @param a First decimal
+ * @param b Second decimal
+ * @return -1 if a < b, 0 if a == b, 1 if a > b
+ * @since 1.1.0
+ */
+DF_DEF int df_decimal_cmp(df_decimal a, df_decimal b);
+
+/**
+ * @brief Test if a decimal is zero
+ * @param d Decimal
+ * @return true if d == 0
+ * @since 1.1.0
+ */
+DF_DEF bool df_decimal_is_zero(df_decimal d);
+
+/**
+ * @brief Increase reference count
+ * @param d Decimal to retain
+ * @return The same decimal pointer
+ * @since 1.1.0
+ */
+DF_DEF df_decimal df_decimal_retain(df_decimal d);
+
+/**
+ * @brief Decrease reference count and free if zero
+ * @param d Pointer to decimal (will be set to NULL)
+ * @since 1.1.0
+ */
+DF_DEF void df_decimal_release(df_decimal* d);
+
+/** @} */ // end of decimal
+
+// ============================================================================
+// EXACT FLOATING-POINT ACCUMULATION
+// ============================================================================
+
+/**
+ * @defgroup superacc Exact Floating-Point Accumulation
+ * @brief Exact sums and dot products of double arrays
+ *
+ * Every finite double is an integer times a power of two, so a sum of
+ * doubles (or of pairwise products) is a dyadic rational. These functions
+ * add each mantissa into a fixed-point superaccumulator wide enough for the
+ * whole double exponent range and build a single df_frac at the end, with
+ * no per-element allocation, GCD or rounding.
+ *
+ * @code
+ * double x[] = {1e100, 1.0, -1e100};
+ * df_frac s = df_sum_doubles(x, 3);   // exactly 1
+ * df_release(&s);
+ * @endcode
+ * @{
+ */
+
+/**
+ * @brief Exact sum of an array of doubles
+ * @param x Array of values (may be NULL when n is 0)
+ * @param n Number of elements
+ * @return The exact rational sum, or NULL if any element is inf or NaN
+ *
+ * @since 1.1.0
+ */
+DF_DEF df_frac df_sum_doubles(const double* x, size_t n);
+
+/**
+ * @brief Exact dot product of two double arrays
+ * @param x First array (may be NULL when n is 0)
+ * @param y Second array (may be NULL when n is 0)
+ * @param n Number of elements in each array
+ * @return The exact rational value of sum(x[i] * y[i]), or NULL if any
+ *         element is inf or NaN
+ *
+ * Products are formed exactly from the two 53-bit mantissas, so the result
+ * is exact even where x[i] * y[i] would overflow or underflow in double.
+ *
+ * @since 1.1.0
+ */
+DF_DEF df_frac df_dot_doubles(const double* x, const double* y, size_t n);
+
+/** @} */ // end of superacc
+
+// ============================================================================
+// ROUNDING AND RESCALING
+// ============================================================================
+
+/**
+ * @defgroup rescale Rounding and Rescaling
+ * @brief Exact integer rescaling with explicit rounding modes
+ *
+ * df_rescale_i64() computes x * num / den rounded to an integer, the
+ * operation behind timestamp and currency conversion, without building any
+ * df_frac. The product is formed in 128 bits, so the result is exact
+ * whenever it fits in int64_t.
+ *
+ * @code
+ * // 90 kHz ticks to milliseconds, rounded to nearest
+ * int64_t ms;
+ * if (df_rescale_i64(pts, 1000, 90000, DF_ROUND_HALF_EVEN, &ms)) {
+ *     // use ms
+ * }
+ * @endcode
+ * @{
+ */
+
+/**
+ * @brief Rounding modes for integer results
+ */
+typedef enum {
+    DF_ROUND_FLOOR,      /**< Toward negative infinity */
+    DF_ROUND_CEIL,       /**< Toward positive infinity */
+    DF_ROUND_TRUNC,      /**< Toward zero */
+    DF_ROUND_AWAY,       /**< Away from zero */
+    DF_ROUND_HALF_EVEN,  /**< Nearest, ties to even (as df_round) */
+    DF_ROUND_HALF_AWAY   /**< Nearest, ties away from zero */
+} df_rounding;
+
+/**
+ * @brief Compute x * num / den rounded to an integer
+ * @param x Value to rescale
+ * @param num Scale numerator
+ * @param den Scale denominator (must not be zero)
+ * @param mode Rounding mode
+ * @param result Receives the rounded quotient
+ * @return true if the result fits in int64_t, false otherwise
+ *
+ * @since 1.1.0
+ */
+DF_DEF bool df_rescale_i64(int64_t x, int64_t num, int64_t den, df_rounding mode, int64_t* result);
+
+/**
+ * @brief Rescale an array by a fixed ratio
+ * @param x Input values
+ * @param out Output values (may alias x)
+ * @param n Number of elements
+ * @param num Scale numerator
+ * @param den Scale denominator (must not be zero)
+ * @param mode Rounding mode
+ * @return true if every result fits in int64_t; entries that do not are
+ *         set to 0
+ *
+ * Each out[i] equals df_rescale_i64(x[i], num, den, mode). A reciprocal
+ * for the fixed divisor is precomputed once, so products that fit in 64
+ * bits are divided with a multiply and shifts.
+ *
+ * @since 1.1.0
+ */
+DF_DEF bool df_rescale_many(const int64_t* x, int64_t* out, size_t n, int64_t num, int64_t den,
+                            df_rounding mode);
+
+/**
+ * @brief Round a fraction to a multiple of 1/den
+ * @param f Fraction to quantize
+ * @param den Quantum denominator (must be positive)
+ * @param mode Rounding mode
+ * @param result Receives k such that k/den is f rounded to the grid
+ * @return true if k fits in int64_t, false otherwise
+ *
+ * When the fraction's components fit in int64_t this is one 128-bit
+ * multiply and one division, with no allocation.
+ *
+ * @code
+ * int64_t ticks;
+ * df_quantize(price, 100, DF_ROUND_HALF_EVEN, &ticks);  // whole cents
+ * @endcode
+ * @since 1.1.0
+ */
+DF_DEF bool df_quantize(df_frac f, int64_t den, df_rounding mode, int64_t* result);
+
+/**
+ * @brief Quantize an array of fractions to the same grid
+ * @param f Input fractions
+ * @param n Number of elements
+ * @param den Quantum denominator (must be positive)
+ * @param mode Rounding mode
+ * @param out Output values; entries that do not fit are set to 0
+ * @return true if every result fits in int64_t
+ * @since 1.1.0
+ */
+DF_DEF bool df_quantize_many(const df_frac* f, size_t n, int64_t den, df_rounding mode, int64_t* out);
+
+/** @} */ // end of rescale
+
+// ============================================================================
+// GEOMETRIC PREDICATES
+// ============================================================================
+
+/**
+ * @defgroup geometry Geometric Predicates
+ * @brief Exact determinant signs for computational geometry
+ *
+ * Each predicate first evaluates its determinant in double precision with
+ * a running error bound, seeded from the cached approximation of each
+ * coordinate. Only when the bound cannot certify the sign is the
+ * determinant evaluated exactly, on integer numerators over a common
+ * denominator. Only the sign is returned; no df_frac is constructed.
+ *
+ * The _d variants take double coordinates and are likewise exact.
+ *
+ * @code
+ * double a[2] = {0, 0}, b[2] = {1, 0}, c[2] = {0, 1};
+ * int turn = df_orient2d_d(a, b, c);   // 1: counterclockwise
+ * @endcode
+ * @{
+ */
+
+/**
+ * @brief Orientation of three points in the plane
+ * @param a First point (x, y)
+ * @param b Second point
+ * @param c Third point
+ * @return 1 if a, b, c turn counterclockwise, -1 if clockwise, 0 if collinear
+ * @since 1.1.0
+ */
+DF_DEF int df_orient2d(const df_frac a[2], const df_frac b[2], const df_frac c[2]);
+
+/**
+ * @brief Orientation of four points in space
+ * @param a First point (x, y, z)
+ * @param b Second point
+ * @param c Third point
+ * @param d Query point
+ * @return 1 if d lies below the plane through a, b, c (counterclockwise
+ *         seen from above), -1 if above, 0 if coplanar
+ * @since 1.1.0
+ */
+DF_DEF int df_orient3d(const df_frac a[3], const df_frac b[3], const df_frac c[3], const df_frac d[3]);
+
+/**
+ * @brief Position of a point relative to a circle
+ * @param a First point on the circle (x, y)
+ * @param b Second point on the circle
+ * @param c Third point on the circle
+ * @param d Query point
+ * @return For counterclockwise a, b, c: 1 if d is inside the circle, -1 if
+ *         outside, 0 if on it (signs flip for clockwise a, b, c)
+ * @since 1.1.0
+ */
+DF_DEF int df_incircle(const df_frac a[2], const df_frac b[2], const df_frac c[2], const df_frac d[2]);
+
+/**
+ * @brief df_orient2d() over double coordinates (must be finite)
+ * @since 1.1.0
+ */
+DF_DEF int df_orient2d_d(const double a[2], const double b[2], const double c[2]);
+
+/**
+ * @brief df_orient3d() over double coordinates (must be finite)
+ * @since 1.1.0
+ */
+DF_DEF int df_orient3d_d(const double a[3], const double b[3], const double c[3], const double d[3]);
+
+/**
+ * @brief df_incircle() over double coordinates (must be finite)
+ * @since 1.1.0
+ */
+DF_DEF int df_incircle_d(const double a[2], const double b[2], const double c[2], const double d[2]);
+
+/** @} */ // end of geometry
+
+// ============================================================================
+// COLUMNAR STORAGE
+// ============================================================================
+
+/**
+ * @defgroup column Columnar Fraction Vectors
+ * @brief Structure-of-arrays storage for large numbers of fractions
+ *
+ * A df_column keeps fractions whose numerator fits in int64_t and whose
+ * denominator fits in uint64_t inline, in parallel num[] and den[] arrays,
+ * so scans touch contiguous memory. Larger values are flagged in an
+ * overflow bitmap and held in a side table of di_int pairs. Entries may
+ * also be null. Values are always stored in lowest terms.
+ *
+ * @code
+ * df_column col = df_column_new(0);
+ * df_column_append_ints(col, 1, 3);
+ * df_column_append(col, some_frac);
+ * df_column_append(col, NULL);          // null entry
+ *
+ * df_frac first = df_column_get(col, 0);  // 1/3
+ * df_release(&first);
+ * df_column_release(&col);
+ * @endcode
+ * @{
+ */
+
+/**
+ * @struct df_column_internal
+ * @brief Internal structure for a fraction column
+ *
+ * Entry i is null when den[i] == 0 and its overflow bit is clear. When the
+ * overflow bit is set, num[i] indexes big_num/big_den instead.
+ */
+struct df_column_internal {
+    int64_t* num;        /**< Inline numerators */
+    uint64_t* den;       /**< Inline denominators (0 = null) */
+    uint64_t* overflow;  /**< Bitmap of entries held in the side table */
+    size_t length;       /**< Number of entries */
+    size_t capacity;     /**< Allocated entries */
+    di_int* big_num;     /**< Side table numerators */
+    di_int* big_den;     /**< Side table denominators */
+    size_t big_count;    /**< Side table entries handed out */
+    size_t big_capacity; /**< Allocated side table entries */
+    size_t* big_free;    /**< Released side table slots, reused first */
+    size_t free_count;   /**< Entries in big_free */
+    size_t ref_count;    /**< Reference count for memory management */
+};
+
+/**
+ * @typedef df_column
+ * @brief Opaque pointer to a fraction column
+ */
+typedef struct df_column_internal* df_column;
+
+/**
+ * @brief Create an empty column
+ * @param capacity Initial number of entries to reserve (may be 0)
+ * @return New column with reference count 1
+ * @since 1.1.0
+ */
+DF_DEF df_column df_column_new(size_t capacity);
+
+/**
+ * @brief Create a column from an array of fractions
+ * @param values Fractions to copy (NULL elements become null entries)
+ * @param n Number of elements
+ * @return New column with reference count 1
+ * @since 1.1.0
+ */
+DF_DEF df_column df_column_from_fracs(const df_frac* values, size_t n);
+
+/**
+ * @brief Increment reference count
+ * @param c Column to retain
+ * @return The same column
+ * @since 1.1.0
+ */
+DF_DEF df_column df_column_retain(df_column c);
+
+/**
+ * @brief Decrement reference count and free if zero
+ * @param c Pointer to column (set to NULL after release)
+ * @since 1.1.0
+ */
+DF_DEF void df_column_release(df_column* c);
+
+/**
+ * @brief Number of entries in a column
+ * @since 1.1.0
+ */
+DF_DEF size_t df_column_length(df_column c);
+
+/**
+ * @brief Append a fraction
+ * @param c Column to extend
+ * @param f Fraction to store, or NULL for a null entry
+ * @since 1.1.0
+ */
+DF_DEF void df_column_append(df_column c, df_frac f);
+
+/**
+ * @brief Append num/den without creating a df_frac
+ * @param c Column to extend
+ * @param num Numerator
+ * @param den Denominator (must not be zero)
+ *
+ * The value is reduced with a 64-bit GCD and stored inline.
+ * @since 1.1.0
+ */
+DF_DEF void df_column_append_ints(df_column c, int64_t num, int64_t den);
+
+/**
+ * @brief Read an entry
+ * @param c Column
+ * @param i Index (must be < length)
+ * @return New df_frac, or NULL for a null entry
+ * @since 1.1.0
+ */
+DF_DEF df_frac df_column_get(df_column c, size_t i);
+
+/**
+ * @brief Overwrite an entry
+ * @param c Column
+ * @param i Index (must be < length)
+ * @param f New value, or NULL for a null entry
+ * @since 1.1.0
+ */
+DF_DEF void df_column_set(df_column c, size_t i, df_frac f);
+
+/**
+ * @brief Check whether an entry is null
+ * @since 1.1.0
+ */
+DF_DEF bool df_column_is_null(df_column c, size_t i);
+
+/**
+ * @brief Copy every entry out as a df_frac
+ * @param c Column
+ * @param out Array of at least df_column_length(c) elements; receives new
+ *            references (NULL for null entries)
+ * @since 1.1.0
+ */
+DF_DEF void df_column_to_fracs(df_column c, df_frac* out);
+
+/**
+ * @brief Exact sum of the non-null entries
+ * @param c Column
+ * @return New df_frac (zero for an empty or all-null column)
+ *
+ * Inline entries are accumulated as a 128-bit numerator over a running
+ * 64-bit common denominator. Blocks that share that denominator reduce to
+ * plain integer additions. The accumulator is folded into a df_frac only
+ * when the common denominator or numerator would overflow.
+ * @since 1.1.0
+ */
+DF_DEF df_frac df_column_sum(df_column c);
+
+/**
+ * @brief Exact mean of the non-null entries
+ * @param c Column
+ * @return New df_frac, or NULL if there are no non-null entries
+ * @since 1.1.0
+ */
+DF_DEF df_frac df_column_mean(df_column c);
+
+/**
+ * @brief Smallest non-null entry
+ * @param c Column
+ * @return New df_frac, or NULL if there are no non-null entries
+ * @since 1.1.0
+ */
+DF_DEF df_frac df_column_min(df_column c);
+
+/**
+ * @brief Largest non-null entry
+ * @param c Column
+ * @return New df_frac, or NULL if there are no non-null entries
+ * @since 1.1.0
+ */
+DF_DEF df_frac df_column_max(df_column c);
+
+/**
+ * @brief Index of the first smallest non-null entry
+ * @param c Column
+ * @return Index, or SIZE_MAX if there are no non-null entries
+ *
+ * Inline entries are compared exactly by 128-bit cross-multiplication.
+ * Only comparisons involving side table entries use di_int.
+ * @since 1.1.0
+ */
+DF_DEF size_t df_column_argmin(df_column c);
+
+/**
+ * @brief Index of the first largest non-null entry
+ * @param c Column
+ * @return Index, or SIZE_MAX if there are no non-null entries
+ * @since 1.1.0
+ */
+DF_DEF size_t df_column_argmax(df_column c);
+
+/** @} */ // end of column
+
+// ============================================================================
+// BULK REDUCTION
+// ============================================================================
+
+/**
+ * @defgroup reduction Bulk Reduction
+ * @brief Sums and products over arrays of fractions
+ *
+ * df_sum() picks its strategy from the data. Real-world sums usually draw
+ * their denominators from a tiny set (cents, thirds, powers of two), so
+ * terms are first bucketed by denominator and their numerators added as
+ * plain integers, with no GCD per term. Each bucket becomes one fraction
+ * at the end. If the number of distinct denominators exceeds
+ * DF_SUM_MAX_BUCKETS, the remaining terms are summed by the general
+ * strategy instead.
+ *
+ * The general strategy, and df_prod(), combine terms pairwise in a
+ * balanced tree so both operands of every operation grow at the same
+ * rate. When compiled with DF_THREADS (POSIX threads), the top of the tree
+ * is split across threads. The tree shape depends only on n, and results
+ * are in lowest terms, so the output is identical for any thread count.
+ * @{
+ */
+
+#ifndef DF_SUM_MAX_BUCKETS
+#define DF_SUM_MAX_BUCKETS 64
+#endif
+
+#ifndef DF_PARALLEL_MIN
+#define DF_PARALLEL_MIN 256  /**< Fewest terms worth handing to another thread */
+#endif
+
+/**
+ * @brief Exact sum of an array of fractions
+ * @param values Fractions to add (none may be NULL)
+ * @param n Number of elements
+ * @param threads Maximum threads to use (values below 2, or builds
+ *                without DF_THREADS, run on the calling thread)
+ * @return New df_frac with the sum (zero when n is 0)
+ *
+ * @code
+ * df_frac prices[3] = {df_from_ints(199, 100), df_from_ints(1, 2), df_from_ints(1, 3)};
+ * df_frac total = df_sum(prices, 3, 1);   // 2.49 + 1/3 = 847/300
+ * @endcode
+ * @since 1.1.0
+ */
+DF_DEF df_frac df_sum(const df_frac* values, size_t n, int threads);
+
+/**
+ * @brief Exact product of an array of fractions
+ * @param values Fractions to multiply (none may be NULL)
+ * @param n Number of elements
+ * @param threads Maximum threads to use, as for df_sum()
+ * @return New df_frac with the product (one when n is 0)
+ * @since 1.1.0
+ */
+DF_DEF df_frac df_prod(const df_frac* values, size_t n, int threads);
+
+/**
+ * @brief Running totals of an array of fractions
+ * @param in Fractions to accumulate (none may be NULL)
+ * @param out Receives n new fractions, out[i] = in[0] + ... + in[i];
+ *            must not overlap in
+ * @param n Number of elements
+ * @param threads Maximum threads to use, as for df_sum()
+ *
+ * Terms are accumulated over a shared 64-bit common denominator while
+ * the running numerator fits in 128 bits, so each output costs one
+ * reduction rather than the cross-multiplication and GCD of df_add().
+ * With DF_THREADS the scan runs in two passes over contiguous blocks:
+ * block totals in parallel, a serial scan of those totals, then every
+ * block's running sums in parallel from its starting offset.
+ *
+ * @code
+ * df_frac balance[3];
+ * df_prefix_sum(entries, balance, 3, 1);
+ * // entries {1/2, 1/3, 1/6} give balance {1/2, 5/6, 1}
+ * @endcode
+ * @since 1.1.0
+ */
+DF_DEF void df_prefix_sum(const df_frac* in, df_frac* out, size_t n, int threads);
+
+/** @} */ // end of reduction
+
+// ============================================================================
+// FRACTION ARRAYS
+// ============================================================================
+
+/**
+ * @defgroup arrays Fraction Arrays
+ * @brief Whole-array conversion, sorting, selection and bucketing
+ *
+ * An array of fractions can be rewritten over a single common
+ * denominator. Integer kernels (matrix products, sparse products,
+ * sorting) can then run on the numerators with no rational overhead, and
+ * the results convert back with one GCD per entry.
+ *
+ * Sorting and selection work mostly on double approximations. Exact
+ * comparisons are made only where the approximations cannot decide the
+ * order.
+ * @{
+ */
+
+/**
+ * @brief Rewrite an array over its least common denominator
+ * @param xs Fractions to rewrite (none may be NULL)
+ * @param n Number of elements
+ * @param ints Array of n elements; receives new di_int numerators with
+ *             xs[i] = ints[i] / *den
+ * @param den Receives the least common denominator as a new di_int
+ *            (one when n is 0)
+ *
+ * The LCM is built in 64-bit arithmetic for as long as it fits. Larger
+ * partial LCMs are then combined in a balanced tree. Each numerator is
+ * scaled with at most one division, and repeated denominators share it.
+ *
+ * @code
+ * // {1/2, 1/3, 5/6} becomes {3, 2, 5} over 6
+ * df_common_denominator(xs, 3, ints, &den);
+ * @endcode
+ * @since 1.1.0
+ */
+DF_DEF void df_common_denominator(const df_frac* xs, size_t n, di_int* ints, di_int* den);
+
+/**
+ * @brief Build fractions from numerators over a shared denominator
+ * @param ints Numerators (none may be NULL)
+ * @param n Number of elements
+ * @param den Shared denominator (must be positive)
+ * @param out Array of n elements; receives new df_frac values ints[i] / den
+ *            in lowest terms
+ * @since 1.1.0
+ */
+DF_DEF void df_from_common_denominator(const di_int* ints, size_t n, di_int den, df_frac* out);
+
+/**
+ * @brief Sort an array of fractions in place, ascending
+ * @param xs Fractions to sort (none may be NULL)
+ * @param n Number of elements
+ *
+ * Each element's cached double approximation and error bound give a
+ * sort key. Keys are radix sorted, and only runs whose error intervals
+ * overlap are ordered with exact comparisons. Equal values keep their
+ * original order.
+ * @since 1.1.0
+ */
+DF_DEF void df_sort(df_frac* xs, size_t n);
+
+/**
+ * @brief Stable ascending order of an array of fractions
+ * @param xs Fractions to order (none may be NULL)
+ * @param n Number of elements
+ * @param idx Array of n elements; receives indices such that
+ *            xs[idx[0]] <= xs[idx[1]] <= ...
+ * @since 1.1.0
+ */
+DF_DEF void df_argsort(const df_frac* xs, size_t n, size_t* idx);
+
+/**
+ * @brief The k-th smallest element of an array
+ * @param xs Fractions to search (none may be NULL)
+ * @param n Number of elements
+ * @param k Zero-based rank (must be < n)
+ * @return New reference to the element of rank k
+ *
+ * Quickselect on the lower and upper error bounds of the double
+ * approximations brackets the answer in expected linear time. Only the
+ * elements inside that bracket are compared exactly.
+ * @since 1.1.0
+ */
+DF_DEF df_frac df_select_kth(const df_frac* xs, size_t n, size_t k);
+
+/**
+ * @brief Exact median of an array
+ * @param xs Fractions (none may be NULL)
+ * @param n Number of elements (must be positive)
+ * @return New df_frac with the middle element, or the mean of the two
+ *         middle elements when n is even
+ * @since 1.1.0
+ */
+DF_DEF df_frac df_median(const df_frac* xs, size_t n);
+
+/**
+ * @brief Assign each value to an interval between sorted boundaries
+ * @param values Fractions to classify (none may be NULL)
+ * @param n Number of values
+ * @param boundaries Boundaries in ascending order (none may be NULL)
+ * @param m Number of boundaries
+ * @param out_idx Array of n elements; receives the number of boundaries
+ *                less than or equal to each value, so bucket 0 lies below
+ *                boundaries[0] and bucket m at or above boundaries[m-1]
+ *
+ * When the boundaries share a 64-bit common denominator D, they are
+ * rewritten once as integers over D. Each 64-bit value p/q then needs a
+ * single 128-bit division, floor(p * D / q), and an integer binary
+ * search. Other values take a binary search with df_cmp().
+ *
+ * @code
+ * // Tax brackets at 10000, 40000 and 85000
+ * df_bucketize(incomes, n, brackets, 3, bracket_of);
+ * @endcode
+ * @since 1.1.0
+ */
+DF_DEF void df_bucketize(const df_frac* values, size_t n, const df_frac* boundaries, size_t m, size_t* out_idx);
+
+/**
+ * @brief Exact sum of the values falling in each bucket
+ * @param values Fractions to classify and add (none may be NULL)
+ * @param n Number of values
+ * @param boundaries Boundaries in ascending order, as for df_bucketize()
+ * @param m Number of boundaries
+ * @param sums Array of m + 1 elements; receives a new df_frac per bucket
+ *             (zero for empty buckets)
+ * @since 1.1.0
+ */
+DF_DEF void df_bucket_sum(const df_frac* values, size_t n, const df_frac* boundaries, size_t m, df_frac* sums);
+
+/** @} */ // end of arrays
+
+// ============================================================================
+// HASH MAP
+// ============================================================================
+
+/**
+ * @defgroup map Fraction-Keyed Hash Map
+ * @brief Open-addressing dictionary from fractions to pointers
+ *
+ * df_map uses Robin Hood probing with backward-shift deletion and caches
+ * each entry's hash. Keys whose components fit 64 bits are stored inline,
+ * so looking them up compares two integers and allocates nothing. Larger
+ * keys are retained and compared component by component. Values are
+ * opaque pointers that the map never dereferences or frees.
+ *
+ * @code
+ * df_map memo = df_map_new();
+ * bool inserted;
+ * void** slot = df_map_slot(memo, x, &inserted);
+ * if (inserted) *slot = compute(x);
+ * df_map_release(&memo);
+ * @endcode
+ * @{
+ */
+
+/**
+ * @struct df_map_entry
+ * @brief One slot of a df_map
+ */
+typedef struct {
+    uint64_t hash;  /**< Cached df_hash() of the key (0 = empty slot) */
+    int64_t num;    /**< Inline key numerator */
+    uint64_t den;   /**< Inline key denominator (0 when big holds the key) */
+    df_frac big;    /**< Retained key too large to store inline */
+    void* value;    /**< Caller's value */
+} df_map_entry;
+
+/**
+ * @struct df_map_internal
+ * @brief Internal structure for a fraction-keyed hash map
+ */
+struct df_map_internal {
+    df_map_entry* entries;  /**< Slots (capacity is zero or a power of two) */
+    size_t capacity;        /**< Number of slots */
+    size_t size;            /**< Number of keys */
+    size_t ref_count;       /**< Reference count for memory management */
+};
+
+/**
+ * @typedef df_map
+ * @brief Opaque pointer to a fraction-keyed hash map
+ */
+typedef struct df_map_internal* df_map;
+
+/**
+ * @brief Create an empty map
+ * @return New map with reference count 1
+ * @since 1.1.0
+ */
+DF_DEF df_map df_map_new(void);
+
+/**
+ * @brief Increment reference count
+ * @param m Map to retain
+ * @return The same map
+ * @since 1.1.0
+ */
+DF_DEF df_map df_map_retain(df_map m);
+
+/**
+ * @brief Decrement reference count and free if zero
+ * @param m Pointer to map (set to NULL after release)
+ *
+ * Keys are released. Values are left to the caller.
+ * @since 1.1.0
+ */
+DF_DEF void df_map_release(df_map* m);
+
+/**
+ * @brief Number of keys in a map
+ * @since 1.1.0
+ */
+DF_DEF size_t df_map_size(df_map m);
+
+/**
+ * @brief Look up a key
+ * @param m Map
+ * @param key Key to find
+ * @param value Receives the value when found (may be NULL)
+ * @return true if the key is present
+ * @since 1.1.0
+ */
+DF_DEF bool df_map_get(df_map m, df_frac key, void** value);
+
+/**
+ * @brief Look up the key num/den without building a df_frac
+ * @param m Map
+ * @param num Key numerator
+ * @param den Key denominator (must not be zero)
+ * @param value Receives the value when found (may be NULL)
+ * @return true if the key is present
+ * @since 1.1.0
+ */
+DF_DEF bool df_map_get_ints(df_map m, int64_t num, int64_t den, void** value);
+
+/**
+ * @brief Insert a key or replace its value
+ * @param m Map
+ * @param key Key (retained by the map if not stored inline)
+ * @param value Value to associate
+ * @since 1.1.0
+ */
+DF_DEF void df_map_put(df_map m, df_frac key, void* value);
+
+/**
+ * @brief Find or insert a key, returning its value slot
+ * @param m Map
+ * @param key Key (retained by the map if inserted and not stored inline)
+ * @param inserted Receives true if the key was absent and has been added
+ *                 with a NULL value (may be NULL)
+ * @return Pointer to the value, valid until the map is next modified
+ *
+ * One probe serves both the lookup and the insertion, which suits
+ * memoization.
+ * @since 1.1.0
+ */
+DF_DEF void** df_map_slot(df_map m, df_frac key, bool* inserted);
+
+/**
+ * @brief Remove a key
+ * @param m Map
+ * @param key Key to remove
+ * @param value Receives the removed value when found (may be NULL)
+ * @return true if the key was present
+ * @since 1.1.0
+ */
+DF_DEF bool df_map_remove(df_map m, df_frac key, void** value);
+
+/**
+ * @brief Step through the entries of a map
+ * @param m Map
+ * @param iter Cursor, set to 0 before the first call
+ * @param key Receives a new reference to the key (may be NULL)
+ * @param value Receives the value (may be NULL)
+ * @return false once every entry has been visited
+ *
+ * @code
+ * size_t it = 0;
+ * df_frac k;
+ * void* v;
+ * while (df_map_next(m, &it, &k, &v)) {
+ *     // ...
+ *     df_release(&k);
+ * }
+ * @endcode
+ * @since 1.1.0
+ */
+DF_DEF bool df_map_next(df_map m, size_t* iter, df_frac* key, void** value);
+
+/** @} */ // end of map
+
+// ============================================================================
+// ORDERED CONTAINERS
+// ============================================================================
+
+/**
+ * @defgroup ordered Ordered Containers
+ * @brief Priority queue and ordered map keyed by exact fractions
+ *
+ * Both containers cache an interval [lo, hi] around each key's value,
+ * taken from its double approximation and error bound. Two keys are
+ * compared exactly with df_cmp() only when their intervals overlap, which
+ * for distinct keys almost never happens. Pushing and popping allocate
+ * nothing beyond amortized node storage.
+ *
+ * df_heap is a binary min-heap that suits event queues. Equal keys pop in
+ * the order they were pushed or last updated. Each push returns a handle
+ * that later identifies the entry for decrease-key or removal.
+ *
+ * df_ordmap is a B-tree map with unique keys and in-order range
+ * iteration.
+ * @{
+ */
+
+/**
+ * @struct df_heap_node
+ * @brief One entry of a df_heap
+ */
+typedef struct {
+    double lo;      /**< Lower bound of the key's value */
+    double hi;      /**< Upper bound of the key's value */
+    df_frac key;    /**< Retained key */
+    void* value;    /**< Caller's value */
+    uint64_t seq;   /**< Insertion order, breaks ties between equal keys */
+    size_t handle;  /**< Handle returned by df_heap_push() */
+} df_heap_node;
+
+/**
+ * @struct df_heap_internal
+ * @brief Internal structure for a fraction-keyed min-heap
+ */
+struct df_heap_internal {
+    df_heap_node* nodes;     /**< Heap-ordered entries */
+    size_t size;             /**< Number of entries */
+    size_t capacity;         /**< Allocated entries */
+    size_t* position;        /**< Heap index of each handle (SIZE_MAX = free) */
+    size_t* free_handles;    /**< Stack of handles available for reuse */
+    size_t free_count;       /**< Entries on the free stack */
+    size_t handle_capacity;  /**< Handles allocated so far */
+    uint64_t next_seq;       /**< Next insertion sequence number */
+    size_t ref_count;        /**< Reference count for memory management */
+};
+
+/**
+ * @typedef df_heap
+ * @brief Opaque pointer to a fraction-keyed min-heap
+ */
+typedef struct df_heap_internal* df_heap;
+
+/**
+ * @brief Create an empty heap
+ * @return New heap with reference count 1
+ * @since 1.1.0
+ */
+DF_DEF df_heap df_heap_new(void);
+
+/**
+ * @brief Increment reference count
+ * @param h Heap to retain
+ * @return The same heap
+ * @since 1.1.0
+ */
+DF_DEF df_heap df_heap_retain(df_heap h);
+
+/**
+ * @brief Decrement reference count and free if zero
+ * @param h Pointer to heap (set to NULL after release)
+ *
+ * Keys are released. Values are left to the caller.
+ * @since 1.1.0
+ */
+DF_DEF void df_heap_release(df_heap* h);
+
+/**
+ * @brief Number of entries in a heap
+ * @since 1.1.0
+ */
+DF_DEF size_t df_heap_size(df_heap h);
+
+/**
+ * @brief Add an entry
+ * @param h Heap
+ * @param key Priority (retained by the heap)
+ * @param value Caller's value
+ * @return Handle identifying the entry until it is popped or removed
+ * @since 1.1.0
+ */
+DF_DEF size_t df_heap_push(df_heap h, df_frac key, void* value);
+
+/**
+ * @brief Look at the entry with the smallest key
+ * @param h Heap
+ * @param key Receives a new reference to the key (may be NULL)
+ * @param value Receives the value (may be NULL)
+ * @return false if the heap is empty
+ * @since 1.1.0
+ */
+DF_DEF bool df_heap_peek(df_heap h, df_frac* key, void** value);
+
+/**
+ * @brief Remove the entry with the smallest key
+ * @param h Heap
+ * @param key Receives the key, which the caller must release (may be NULL)
+ * @param value Receives the value (may be NULL)
+ * @return false if the heap is empty
+ * @since 1.1.0
+ */
+DF_DEF bool df_heap_pop(df_heap h, df_frac* key, void** value);
+
+/**
+ * @brief Change the key of an entry (decrease-key or increase-key)
+ * @param h Heap
+ * @param handle Handle from df_heap_push() of an entry still in the heap
+ * @param key New priority (retained by the heap)
+ * @since 1.1.0
+ */
+DF_DEF void df_heap_update(df_heap h, size_t handle, df_frac key);
+
+/**
+ * @brief Remove an entry by handle
+ * @param h Heap
+ * @param handle Handle from df_heap_push()
+ * @param key Receives the key, which the caller must release (may be NULL)
+ * @param value Receives the value (may be NULL)
+ * @return false if the handle does not name an entry in the heap
+ * @since 1.1.0
+ */
+DF_DEF bool df_heap_remove(df_heap h, size_t handle, df_frac* key, void** value);
+
+/**
+ * @struct df_ordmap_internal
+ * @brief Internal structure for a fraction-keyed ordered map
+ */
+struct df_ordmap_internal {
+    struct df_ordmap_node* root;  /**< B-tree root (NULL when empty) */
+    size_t size;                  /**< Number of keys */
+    size_t ref_count;             /**< Reference count for memory management */
+};
+
+/**
+ * @typedef df_ordmap
+ * @brief Opaque pointer to a fraction-keyed ordered map
+ */
+typedef struct df_ordmap_internal* df_ordmap;
+
+/**
+ * @typedef df_ordmap_visit_fn
+ * @brief Range iteration callback
+ *
+ * Receives a borrowed key and its value; returns false to stop.
+ */
+typedef bool (*df_ordmap_visit_fn)(df_frac key, void* value, void* ctx);
+
+/**
+ * @brief Create an empty ordered map
+ * @return New map with reference count 1
+ * @since 1.1.0
+ */
+DF_DEF df_ordmap df_ordmap_new(void);
+
+/**
+ * @brief Increment reference count
+ * @param m Map to retain
+ * @return The same map
+ * @since 1.1.0
+ */
+DF_DEF df_ordmap df_ordmap_retain(df_ordmap m);
+
+/**
+ * @brief Decrement reference count and free if zero
+ * @param m Pointer to map (set to NULL after release)
+ *
+ * Keys are released. Values are left to the caller.
+ * @since 1.1.0
+ */
+DF_DEF void df_ordmap_release(df_ordmap* m);
+
+/**
+ * @brief Number of keys in an ordered map
+ * @since 1.1.0
+ */
+DF_DEF size_t df_ordmap_size(df_ordmap m);
+
+/**
+ * @brief Look up a key
+ * @param m Map
+ * @param key Key to find
+ * @param value Receives the value when found (may be NULL)
+ * @return true if the key is present
+ * @since 1.1.0
+ */
+DF_DEF bool df_ordmap_get(df_ordmap m, df_frac key, void** value);
+
+/**
+ * @brief Insert a key or replace its value
+ * @param m Map
+ * @param key Key (retained by the map when inserted)
+ * @param value Value to associate
+ * @since 1.1.0
+ */
+DF_DEF void df_ordmap_put(df_ordmap m, df_frac key, void* value);
+
+/**
+ * @brief Remove a key
+ * @param m Map
+ * @param key Key to remove
+ * @param value Receives the removed value when found (may be NULL)
+ * @return true if the key was present
+ * @since 1.1.0
+ */
+DF_DEF bool df_ordmap_remove(df_ordmap m, df_frac key, void** value);
+
+/**
+ * @brief Visit keys in [lo, hi) in ascending order
+ * @param m Map
+ * @param lo Inclusive lower bound, or NULL for no bound
+ * @param hi Exclusive upper bound, or NULL for no bound
+ * @param visit Callback; returning false stops the iteration
+ * @param ctx Passed through to visit
+ *
+ * The map must not be modified during the iteration.
+ *
+ * @code
+ * // Events scheduled before t = 5/2
+ * df_ordmap_range(events, NULL, deadline, print_event, NULL);
+ * @endcode
+ * @since 1.1.0
+ */
+DF_DEF void df_ordmap_range(df_ordmap m, df_frac lo, df_frac hi, df_ordmap_visit_fn visit, void* ctx);
+
+/** @} */ // end of ordered
+
+#ifdef DF_STATS
+
+// ============================================================================
+// INSTRUMENTATION
+// ============================================================================
+
+#include <stdio.h>
+
+/**
+ * @defgroup stats Operation Statistics
+ * @brief Counters compiled in with DF_STATS
+ *
+ * When the library is compiled with DF_STATS, each thread counts into its
+ * own block. The counters cover calls to every public function except
+ * those of the statistics, latency and tracing groups, the di_gcd(),
+ * di_mul(), di_div() and di_mod() calls the library makes, how often
+ * reduction skipped or ran a GCD, and the fraction objects allocated and
+ * freed. Calls to the arithmetic and comparison operations and to the
+ * dynamic_int functions also record the size class of their operands in
+ * limbs.
+ *
+ * Blocks outlive their threads, so df_stats_snapshot() sums every thread
+ * that has ever counted. Taking a snapshot while other threads are running
+ * is safe, but the result is not a single consistent instant. Without
+ * DF_STATS none of this is compiled and the counting sites vanish.
+ *
+ * DF_LATENCY, which implies DF_STATS, also times df_add(), df_sub(),
+ * df_mul(), df_div() and df_cmp() and files each call in a log-bucketed
+ * histogram keyed by operation and operand size class. A timed call costs
+ * two reads of CLOCK_MONOTONIC, small next to a GCD of even one limb.
+ * @{
+ */
+
+/**
+ * @brief Counter list as X(id, name)
+ *
+ * Each entry defines DF_STAT_<id>, and df_stat_name() returns its name.
+ * Entries named after a public function count its calls, including those
+ * the library makes itself. cmp_filtered counts the df_cmp() calls decided
+ * by the double filter. The remaining entries count reductions to lowest
+ * terms, reductions that skipped (dyadic) or computed a GCD and GCDs that
+ * came out as one, the di_gcd(), di_mul(), di_div() and di_mod() calls the
+ * library makes, and fraction objects allocated and freed with their bytes.
+ */
+#define DF_STAT_COUNTERS(X)                                            \
+    /* Public entry points */                                          \
+    X(ADD, "df_add")                                                   \
+    X(SUB, "df_sub")                                                   \
+    X(MUL, "df_mul")                                                   \
+    X(DIV, "df_div")                                                   \
+    X(CMP, "df_cmp")                                                   \
+    X(CMP_FILTERED, "cmp_filtered")                                    \
+    X(EQ, "df_eq")                                                     \
+    X(HASH, "df_hash")                                                 \
+    X(FROM_INTS, "df_from_ints")                                       \
+    X(FROM_DI, "df_from_di")                                           \
+    X(FROM_INT, "df_from_int")                                         \
+    X(FROM_DOUBLE, "df_from_double")                                   \
+    X(COPY, "df_copy")                                                 \
+    X(RETAIN, "df_retain")                                             \
+    X(RELEASE, "df_release")                                           \
+    X(INTERN_SIZE, "df_intern_size")                                   \
+    X(NEGATE, "df_negate")                                             \
+    X(ABS, "df_abs")                                                   \
+    X(RECIPROCAL, "df_reciprocal")                                     \
+    X(NE, "df_ne")                                                     \
+    X(LT, "df_lt")                                                     \
+    X(LE, "df_le")                                                     \
+    X(GT, "df_gt")                                                     \
+    X(GE, "df_ge")                                                     \
+    X(IS_ZERO, "df_is_zero")                                           \
+    X(IS_ONE, "df_is_one")                                             \
+    X(IS_NEGATIVE, "df_is_negative")                                   \
+    X(IS_POSITIVE, "df_is_positive")                                   \
+    X(IS_INTEGER, "df_is_integer")                                     \
+    X(TO_DOUBLE, "df_to_double")                                       \
+    X(TO_INT64, "df_to_int64")                                         \
+    X(TO_STRING, "df_to_string")                                       \
+    X(FROM_STRING, "df_from_string")                                   \
+    X(NUMERATOR, "df_numerator")                                       \
+    X(DENOMINATOR, "df_denominator")                                   \
+    X(ZERO, "df_zero")                                                 \
+    X(ONE, "df_one")                                                   \
+    X(NEG_ONE, "df_neg_one")                                           \
+    X(POW, "df_pow")                                                   \
+    X(LDEXP, "df_ldexp")                                               \
+    X(FREXP, "df_frexp")                                               \
+    X(FLOOR, "df_floor")                                               \
+    X(CEIL, "df_ceil")                                                 \
+    X(TRUNC, "df_trunc")                                               \
+    X(ROUND, "df_round")                                               \
+    X(SIGN, "df_sign")                                                 \
+    X(MIN, "df_min")                                                   \
+    X(MAX, "df_max")                                                   \
+    X(FITS_INT32, "df_fits_int32")                                     \
+    X(FITS_INT64, "df_fits_int64")                                     \
+    X(FITS_DOUBLE, "df_fits_double")                                   \
+    X(WHOLE_PART, "df_whole_part")                                     \
+    X(FRACTIONAL_PART, "df_fractional_part")                           \
+    X(SERIES_SUM, "df_series_sum")                                     \
+    X(SERIES_SUM_I64, "df_series_sum_i64")                             \
+    X(SERIES_HYPERGEOMETRIC, "df_series_hypergeometric")               \
+    X(SERIES_HYPERGEOMETRIC_I64, "df_series_hypergeometric_i64")       \
+    X(HARMONIC, "df_harmonic")                                         \
+    X(BERNOULLI, "df_bernoulli")                                       \
+    X(TO_CF, "df_to_cf")                                               \
+    X(FROM_CF, "df_from_cf")                                           \
+    X(CF_ITER_INIT, "df_cf_iter_init")                                 \
+    X(CF_ITER_NEXT, "df_cf_iter_next")                                 \
+    X(CF_ITER_FREE, "df_cf_iter_free")                                 \
+    X(DECIMAL_FROM_INT, "df_decimal_from_int")                         \
+    X(DECIMAL_FROM_STRING, "df_decimal_from_string")                   \
+    X(DECIMAL_FROM_FRAC, "df_decimal_from_frac")                       \
+    X(DECIMAL_TO_FRAC, "df_decimal_to_frac")                           \
+    X(DECIMAL_TO_STRING, "df_decimal_to_string")                       \
+    X(DECIMAL_COEFFICIENT, "df_decimal_coefficient")                   \
+    X(DECIMAL_SCALE, "df_decimal_scale")                               \
+    X(DECIMAL_ADD, "df_decimal_add")                                   \
+    X(DECIMAL_SUB, "df_decimal_sub")                                   \
+    X(DECIMAL_MUL, "df_decimal_mul")                                   \
+    X(DECIMAL_NEGATE, "df_decimal_negate")                             \
+    X(DECIMAL_CMP, "df_decimal_cmp")                                   \
+    X(DECIMAL_IS_ZERO, "df_decimal_is_zero")                           \
+    X(DECIMAL_RETAIN, "df_decimal_retain")                             \
+    X(DECIMAL_RELEASE, "df_decimal_release")                           \
+    X(SUM_DOUBLES, "df_sum_doubles")                                   \
+    X(DOT_DOUBLES, "df_dot_doubles")                                   \
+    X(RESCALE_I64, "df_rescale_i64")                                   \
+    X(RESCALE_MANY, "df_rescale_many")                                 \
+    X(QUANTIZE, "df_quantize")                                         \
+    X(QUANTIZE_MANY, "df_quantize_many")                               \
+    X(ORIENT2D, "df_orient2d")                                         \
+    X(ORIENT3D, "df_orient3d")                                         \
+    X(INCIRCLE, "df_incircle")                                         \
+    X(ORIENT2D_D, "df_orient2d_d")                                     \
+    X(ORIENT3D_D, "df_orient3d_d")                                     \
+    X(INCIRCLE_D, "df_incircle_d")                                     \
+    X(COLUMN_NEW, "df_column_new")                                     \
+    X(COLUMN_FROM_FRACS, "df_column_from_fracs")                       \
+    X(COLUMN_RETAIN, "df_column_retain")                               \
+    X(COLUMN_RELEASE, "df_column_release")                             \
+    X(COLUMN_LENGTH, "df_column_length")                               \
+    X(COLUMN_APPEND, "df_column_append")                               \
+    X(COLUMN_APPEND_INTS, "df_column_append_ints")                     \
+    X(COLUMN_GET, "df_column_get")                                     \
+    X(COLUMN_SET, "df_column_set")                                     \
+    X(COLUMN_IS_NULL, "df_column_is_null")                             \
+    X(COLUMN_TO_FRACS, "df_column_to_fracs")                           \
+    X(COLUMN_SUM, "df_column_sum")                                     \
+    X(COLUMN_MEAN, "df_column_mean")                                   \
+    X(COLUMN_MIN, "df_column_min")                                     \
+    X(COLUMN_MAX, "df_column_max")                                     \
+    X(COLUMN_ARGMIN, "df_column_argmin")                               \
+    X(COLUMN_ARGMAX, "df_column_argmax")                               \
+    X(SUM, "df_sum")                                                   \
+    X(PROD, "df_prod")                                                 \
+    X(PREFIX_SUM, "df_prefix_sum")                                     \
+    X(COMMON_DENOMINATOR, "df_common_denominator")                     \
+    X(FROM_COMMON_DENOMINATOR, "df_from_common_denominator")           \
+    X(SORT, "df_sort")                                                 \
+    X(ARGSORT, "df_argsort")                                           \
+    X(SELECT_KTH, "df_select_kth")                                     \
+    X(MEDIAN, "df_median")                                             \
+    X(BUCKETIZE, "df_bucketize")                                       \
+    X(BUCKET_SUM, "df_bucket_sum")                                     \
+    X(MAP_NEW, "df_map_new")                                           \
+    X(MAP_RETAIN, "df_map_retain")                                     \
+    X(MAP_RELEASE, "df_map_release")                                   \
+    X(MAP_SIZE, "df_map_size")                                         \
+    X(MAP_GET, "df_map_get")                                           \
+    X(MAP_GET_INTS, "df_map_get_ints")                                 \
+    X(MAP_PUT, "df_map_put")                                           \
+    X(MAP_SLOT, "df_map_slot")                                         \
+    X(MAP_REMOVE, "df_map_remove")                                     \
+    X(MAP_NEXT, "df_map_next")                                         \
+    X(HEAP_NEW, "df_heap_new")                                         \
+    X(HEAP_RETAIN, "df_heap_retain")                                   \
+    X(HEAP_RELEASE, "df_heap_release")                                 \
+    X(HEAP_SIZE, "df_heap_size")                                       \
+    X(HEAP_PUSH, "df_heap_push")                                       \
+    X(HEAP_PEEK, "df_heap_peek")                                       \
+    X(HEAP_POP, "df_heap_pop")                                         \
+    X(HEAP_UPDATE, "df_heap_update")                                   \
+    X(HEAP_REMOVE, "df_heap_remove")                                   \
+    X(ORDMAP_NEW, "df_ordmap_new")                                     \
+    X(ORDMAP_RETAIN, "df_ordmap_retain")                               \
+    X(ORDMAP_RELEASE, "df_ordmap_release")                             \
+    X(ORDMAP_SIZE, "df_ordmap_size")                                   \
+    X(ORDMAP_GET, "df_ordmap_get")                                     \
+    X(ORDMAP_PUT, "df_ordmap_put")                                     \
+    X(ORDMAP_REMOVE, "df_ordmap_remove")                               \
+    X(ORDMAP_RANGE, "df_ordmap_range")                                 \
+    /* Reduction, dynamic_int calls made by the library, allocation */ \
+    X(REDUCE, "reduce")                                                \
+    X(GCD_SKIPPED, "gcd_skipped")                                      \
+    X(GCD_EXECUTED, "gcd_executed")                                    \
+    X(GCD_TRIVIAL, "gcd_trivial")                                      \
+    X(DI_GCD, "di_gcd")                                                \
+    X(DI_MUL, "di_mul")                                                \
+    X(DI_DIV, "di_div")                                                \
+    X(DI_MOD, "di_mod")                                                \
+    X(ALLOC, "alloc")                                                  \
+    X(ALLOC_BYTES, "alloc_bytes")                                      \
+    X(FREE, "free")                                                    \
+    X(FREE_BYTES, "free_bytes")                                        
+
+/**
+ * @enum df_stat_counter
+ * @brief Counter identifiers
+ */
+typedef enum {
+#define DF_STAT_ENUM(id, name) DF_STAT_##id,
+    DF_STAT_COUNTERS(DF_STAT_ENUM)
+#undef DF_STAT_ENUM
+    DF_STAT_COUNT /**< Number of counters */
+} df_stat_counter;
+
+/**
+ * @brief Number of operand size classes
+ *
+ * Class 0 holds operands of at most one limb, class k those of
+ * 2^(k-1) + 1 to 2^k limbs, and the last class everything larger.
+ */
+#define DF_STATS_LIMB_CLASSES 8
+
+/**
+ * @struct df_stats
+ * @brief Aggregated counters
+ *
+ * For a fraction operand the size is that of its larger component.
+ */
+typedef struct {
+    uint64_t count[DF_STAT_COUNT];                        /**< Counter values */
+    uint64_t limbs[DF_STAT_COUNT][DF_STATS_LIMB_CLASSES]; /**< Operand size histogram per counter */
+} df_stats;
+
+/**
+ * @brief Sum the counters of every thread
+ * @param out Receives the totals
+ * @since 1.1.0
+ */
+DF_DEF void df_stats_snapshot(df_stats* out);
+
+/**
+ * @brief Zero the counters of every thread
+ *
+ * The reset is exact only while no other thread is running library
+ * operations. Counters are updated without atomic read-modify-writes, so
+ * an increment racing with the reset can store its pre-reset value plus
+ * one over the zero.
+ * @since 1.1.0
+ */
+DF_DEF void df_stats_reset(void);
+
+/**
+ * @brief Name of a counter
+ * @param counter Counter identifier
+ * @return Static string such as "df_add" or "gcd_skipped"
+ * @since 1.1.0
+ */
+DF_DEF const char* df_stat_name(df_stat_counter counter);
+
+/**
+ * @brief Write a snapshot as text or JSON
+ * @param out Stream to write to
+ * @param json true for a JSON object, false for aligned text
+ *
+ * Counters that are zero are left out of the text form.
+ *
+ * @code
+ * df_stats_dump(stderr, false);
+ * @endcode
+ * @since 1.1.0
+ */
+DF_DEF void df_stats_dump(FILE* out, bool json);
+
+#ifdef DF_LATENCY
+
+/**
+ * @brief Operations timed under DF_LATENCY
+ *
+ * df_add(), df_sub(), df_mul(), df_div() and df_cmp(), which are the first
+ * counters of df_stat_counter and are indexed by it.
+ */
+#define DF_LATENCY_OPS 5
+
+/**
+ * @brief Number of latency buckets
+ *
+ * Latencies in nanoseconds are bucketed with three significant bits, so
+ * each power of two is split into eight buckets and a bucket's width is at
+ * most 1/8 of its lower bound. Values below 8 ns have a bucket each, and
+ * the last bucket collects everything from about 17 seconds up.
+ */
+#define DF_LATENCY_BUCKETS 256
+
+/**
+ * @struct df_latency
+ * @brief Latency histograms per operation and operand size class
+ *
+ * The size class of a sample is that of its larger operand, as in
+ * df_stats.
+ */
+typedef struct {
+    uint64_t count[DF_LATENCY_OPS][DF_STATS_LIMB_CLASSES][DF_LATENCY_BUCKETS]; /**< Samples per bucket */
+    uint64_t max_ns[DF_LATENCY_OPS][DF_STATS_LIMB_CLASSES];                    /**< Slowest sample */
+} df_latency;
+
+/**
+ * @brief Merge the latency histograms of every thread
+ * @param out Receives the merged histograms (about 80 KB, so best not on
+ *            a small stack)
+ *
+ * df_stats_reset() clears the histograms along with the counters.
+ * @since 1.1.0
+ */
+DF_DEF void df_latency_snapshot(df_latency* out);
+
+/**
+ * @brief Latency at a quantile of one histogram
+ * @param h Histograms from df_latency_snapshot()
+ * @param op One of DF_STAT_ADD, DF_STAT_SUB, DF_STAT_MUL, DF_STAT_DIV,
+ *           DF_STAT_CMP
+ * @param size_class Operand size class below DF_STATS_LIMB_CLASSES
+ * @param q Quantile in [0, 1]
+ * @return Upper bound in nanoseconds of the bucket holding the quantile
+ *         (the exact maximum for q = 1), or 0 without samples
+ * @since 1.1.0
+ */
+DF_DEF uint64_t df_latency_quantile(const df_latency* h, df_stat_counter op, size_t size_class, double q);
+
+/**
+ * @brief Write the latency histograms as text or JSON
+ * @param out Stream to write to
+ * @param json true for a JSON array, false for aligned text
+ *
+ * Only operation and size class pairs with samples are written. The text
+ * form gives the count, median, p90, p99, p99.9 and maximum; the JSON form
+ * adds the nonzero buckets as [upper bound in ns, count] pairs.
+ * @since 1.1.0
+ */
+DF_DEF void df_latency_dump(FILE* out, bool json);
+
+/**
+ * @brief Dump the histograms periodically
+ * @param out Stream to write to, or NULL to stop
+ * @param interval_ms Minimum time between dumps
+ * @param json Format passed to df_latency_dump()
+ *
+ * There is no background thread: the first timed operation to finish
+ * after each interval has elapsed writes the dump, outside its own
+ * measurement.
+ *
+ * @code
+ * df_latency_dump_every(stderr, 60000, true);  // once a minute
+ * @endcode
+ * @since 1.1.0
+ */
+DF_DEF void df_latency_dump_every(FILE* out, uint64_t interval_ms, bool json);
+
+#endif // DF_LATENCY
+
+/** @} */ // end of stats
+
+#endif // DF_STATS
+
+// ============================================================================
+// OPERATION TRACING
+// ============================================================================
+
+/**
+ * @defgroup trace Operation Tracing
+ * @brief Record operations to a file for offline replay
+ *
+ * When compiled with DF_TRACE, df_trace_open() starts writing every
+ * arithmetic, comparison and sign operation to a binary trace. The
+ * df_replay tool re-executes a trace against whatever build it is
+ * compiled with and reports throughput per opcode, so a production
+ * workload captured once can benchmark later versions of the library.
+ *
+ * A trace starts with the 8 bytes "DFTRACE1". Integers after that are
+ * LEB128 varints, and signed ones are zigzag encoded first. Each record
+ * is an opcode byte followed by its fields:
+ *
+ * - DF_TRACE_VALUE: id, then 0 with zigzag numerator and denominator, or
+ *   1 with a length and that many characters of "num/den" in decimal
+ * - DF_TRACE_ADD, _SUB, _MUL, _DIV: operand ids a and b, result id
+ * - DF_TRACE_NEGATE, _ABS, _RECIPROCAL: operand id, result id
+ * - DF_TRACE_CMP, _EQ: operand ids a and b, zigzag result
+ * - DF_TRACE_RELEASE: id of a fraction that was freed
+ *
+ * Fractions get ids from 1 up as they are first seen. An operand seen for
+ * the first time is written as a DF_TRACE_VALUE record just before the
+ * operation. A result that is already known, such as a shared interned
+ * instance, keeps its id.
+ *
+ * Trace ids are global and unsynchronized, so DF_TRACE excludes
+ * DF_THREADS.
+ * @{
+ */
+
+/**
+ * @enum df_trace_op
+ * @brief Trace record opcodes
+ */
+typedef enum {
+    DF_TRACE_VALUE = 1,   /**< A fraction's value on first sight */
+    DF_TRACE_ADD,         /**< df_add() */
+    DF_TRACE_SUB,         /**< df_sub() */
+    DF_TRACE_MUL,         /**< df_mul() */
+    DF_TRACE_DIV,         /**< df_div() */
+    DF_TRACE_NEGATE,      /**< df_negate() */
+    DF_TRACE_ABS,         /**< df_abs() */
+    DF_TRACE_RECIPROCAL,  /**< df_reciprocal() */
+    DF_TRACE_CMP,         /**< df_cmp() */
+    DF_TRACE_EQ,          /**< df_eq() */
+    DF_TRACE_RELEASE,     /**< Last reference released */
+    DF_TRACE_OP_COUNT     /**< One past the last opcode */
+} df_trace_op;
+
+#ifdef DF_TRACE
+
+/**
+ * @brief Start recording to a file
+ * @param path File to create or truncate
+ * @return true if the file was opened; a trace already open is closed first
+ * @since 1.1.0
+ */
+DF_DEF bool df_trace_open(const char* path);
+
+/**
+ * @brief Stop recording and close the file
+ * @since 1.1.0
+ */
+DF_DEF void df_trace_close(void);
+
+#endif // DF_TRACE
+
+/** @} */ // end of trace
+
+// ============================================================================
+// IMPLEMENTATION
+// ============================================================================
+
+#ifdef DF_IMPLEMENTATION
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include <stdio.h>
+#include <float.h>
+#include <time.h>
+
+#ifdef DF_THREADS
+#include <pthread.h>
+#endif
+
+#ifdef DF_STATS
+
+// One block of counters per thread, linked into a list that only grows.
+// With DF_THREADS, the block of an exiting thread keeps its counts and is
+// handed to the next thread that starts counting, so the list is as long
+// as the peak number of threads counting at once.
+typedef struct df_stats_block {
+    df_stats stats;
+#ifdef DF_LATENCY
+    df_latency latency;
+#endif
+    struct df_stats_block* next;
+    struct df_stats_block* next_free;
+} df_stats_block;
+
+static df_stats_block* df_stats_blocks = NULL;
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_THREADS__)
+static _Thread_local df_stats_block* df_stats_local = NULL;
+#else
+static __thread df_stats_block* df_stats_local = NULL;
+#endif
+
+// Helper: Relaxed accesses keep concurrent snapshots free of data races
+// without making the owning thread's increments atomic read-modify-writes
+static inline uint64_t df_stats_load(const uint64_t* c) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_load_n(c, __ATOMIC_RELAXED);
+#else
+    return *c;
+#endif
+}
+
+static inline void df_stats_store(uint64_t* c, uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_store_n(c, v, __ATOMIC_RELAXED);
+#else
+    *c = v;
+#endif
+}
+
+#ifdef DF_THREADS
+static pthread_key_t df_stats_key;
+static pthread_once_t df_stats_key_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t df_stats_free_lock = PTHREAD_MUTEX_INITIALIZER;
+static df_stats_block* df_stats_free = NULL;
+
+// Helper: Thread exit destructor. The block stays on the list with its
+// counts, which remain part of every snapshot, and waits for a new owner.
+static void df_stats_retire(void* p) {
+    df_stats_block* block = (df_stats_block*)p;
+    df_stats_local = NULL;
+    pthread_mutex_lock(&df_stats_free_lock);
+    block->next_free = df_stats_free;
+    df_stats_free = block;
+    pthread_mutex_unlock(&df_stats_free_lock);
+}
+
+static void df_stats_key_create(void) {
+    pthread_key_create(&df_stats_key, df_stats_retire);
+}
+
+// Helper: Adopt the block of a finished thread, or NULL if there is none.
+// The lock orders the new owner's increments after the old owner's.
+static df_stats_block* df_stats_adopt(void) {
+    pthread_once(&df_stats_key_once, df_stats_key_create);
+    pthread_mutex_lock(&df_stats_free_lock);
+    df_stats_block* block = df_stats_free;
+    if (block) df_stats_free = block->next_free;
+    pthread_mutex_unlock(&df_stats_free_lock);
+    return block;
+}
+#endif
+
+// Helper: The calling thread's block, registered on first use
+static df_stats_block* df_stats_thread_block(void) {
+    df_stats_block* block = df_stats_local;
+    if (block) return block;
+
+#ifdef DF_THREADS
+    block = df_stats_adopt();
+    if (block) {
+        df_stats_local = block;
+        pthread_setspecific(df_stats_key, block);
+        return block;
+    }
+#endif
+    block = (df_stats_block*)DF_MALLOC(sizeof(df_stats_block));
+    DF_ASSERT(block && "df_stats: allocation failed");
+    memset(block, 0, sizeof(df_stats_block));
+#if defined(__GNUC__) || defined(__clang__)
+    block->next = __atomic_load_n(&df_stats_blocks, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&df_stats_blocks, &block->next, block, true,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+    }
+#else
+    block->next = df_stats_blocks;
+    df_stats_blocks = block;
+#endif
+    df_stats_local = block;
+#ifdef DF_THREADS
+    pthread_setspecific(df_stats_key, block);
+#endif
+    return block;
+}
+
+// Helper: Size class of an operand of the given limb count
+static inline size_t df_stats_class(size_t limbs) {
+    size_t k = 0;
+    while (k + 1 < DF_STATS_LIMB_CLASSES && ((size_t)1 << k) < limbs) k++;
+    return k;
+}
+
+// Helper: Label of a size class
+static const char* df_stats_class_label(size_t k) {
+    static const char* const labels[DF_STATS_LIMB_CLASSES] = {"<=1", "2", "<=4", "<=8", "<=16", "<=32", "<=64", ">64"};
+    return labels[k];
+}
+
+// Helper: Add n to a counter of the calling thread
+static inline void df_stats_add(df_stat_counter c, uint64_t n) {
+    df_stats* s = &df_stats_thread_block()->stats;
+    df_stats_store(&s->count[c], df_stats_load(&s->count[c]) + n);
+}
+
+// Helper: Record the size class of one operand in the histogram of c (the
+// call itself is counted by df_stats_add)
+static inline void df_stats_operand(df_stat_counter c, size_t limbs) {
+    uint64_t* slot = &df_stats_thread_block()->stats.limbs[c][df_stats_class(limbs)];
+    df_stats_store(slot, df_stats_load(slot) + 1);
+}
+
+// Helper: Size of a fraction operand, that of its larger component
+static inline size_t df_stats_frac_limbs(df_frac f) {
+    size_t num = di_limb_count(f->numerator);
+    size_t den = di_limb_count(f->denominator);
+    return num > den ? num : den;
+}
+
+// Helper: Count a binary operation on two fractions
+static inline void df_stats_fracs(df_stat_counter c, df_frac a, df_frac b) {
+    df_stats_add(c, 1);
+    df_stats_operand(c, df_stats_frac_limbs(a));
+    df_stats_operand(c, df_stats_frac_limbs(b));
+}
+
+// Helper: Count a binary operation on two integers
+static inline void df_stats_ints(df_stat_counter c, di_int a, di_int b) {
+    df_stats_add(c, 1);
+    df_stats_operand(c, di_limb_count(a));
+    df_stats_operand(c, di_limb_count(b));
+}
+
+#define DF_STAT(c) df_stats_add((c), 1)
+#define DF_STAT_N(c, n) df_stats_add((c), (n))
+#define DF_STAT_FRACS(c, a, b) df_stats_fracs((c), (a), (b))
+#define DF_STAT_INTS(c, a, b) df_stats_ints((c), (a), (b))
+
+DF_IMPL void df_stats_snapshot(df_stats* out) {
+    DF_ASSERT(out && "df_stats_snapshot: output cannot be NULL");
+    memset(out, 0, sizeof(df_stats));
+
+    df_stats_block* block;
+#if defined(__GNUC__) || defined(__clang__)
+    block = __atomic_load_n(&df_stats_blocks, __ATOMIC_ACQUIRE);
+#else
+    block = df_stats_blocks;
+#endif
+    for (; block; block = block->next) {
+        for (size_t c = 0; c < DF_STAT_COUNT; c++) {
+            out->count[c] += df_stats_load(&block->stats.count[c]);
+            for (size_t k = 0; k < DF_STATS_LIMB_CLASSES; k++) {
+                out->limbs[c][k] += df_stats_load(&block->stats.limbs[c][k]);
+            }
+        }
+    }
+}
+
+DF_IMPL void df_stats_reset(void) {
+    df_stats_block* block;
+#if defined(__GNUC__) || defined(__clang__)
+    block = __atomic_load_n(&df_stats_blocks, __ATOMIC_ACQUIRE);
+#else
+    block = df_stats_blocks;
+#endif
+    for (; block; block = block->next) {
+        for (size_t c = 0; c < DF_STAT_COUNT; c++) {
+            df_stats_store(&block->stats.count[c], 0);
+            for (size_t k = 0; k < DF_STATS_LIMB_CLASSES; k++) {
+                df_stats_store(&block->stats.limbs[c][k], 0);
+            }
+        }
+#ifdef DF_LATENCY
+        for (size_t op = 0; op < DF_LATENCY_OPS; op++) {
+            for (size_t k = 0; k < DF_STATS_LIMB_CLASSES; k++) {
+                for (size_t b = 0; b < DF_LATENCY_BUCKETS; b++) df_stats_store(&block->latency.count[op][k][b], 0);
+                df_stats_store(&block->latency.max_ns[op][k], 0);
+            }
+        }
+#endif
+    }
+}
+
+DF_IMPL const char* df_stat_name(df_stat_counter counter) {
+    static const char* const names[DF_STAT_COUNT] = {
+#define DF_STAT_NAME(id, name) name,
+        DF_STAT_COUNTERS(DF_STAT_NAME)
+#undef DF_STAT_NAME
+    };
+    DF_ASSERT((size_t)counter < DF_STAT_COUNT && "df_stat_name: unknown counter");
+    return names[counter];
+}
+
+DF_IMPL void df_stats_dump(FILE* out, bool json) {
+    DF_ASSERT(out && "df_stats_dump: stream cannot be NULL");
+    df_stats s;
+    df_stats_snapshot(&s);
+
+    if (json) {
+        fprintf(out, "{\"counters\": {");
+        for (size_t c = 0; c < DF_STAT_COUNT; c++) {
+            fprintf(out, "%s\"%s\": %llu", c ? ", " : "", df_stat_name((df_stat_counter)c),
+                    (unsigned long long)s.count[c]);
+        }
+        fprintf(out, "}, \"limbs\": {");
+        bool first = true;
+        for (size_t c = 0; c < DF_STAT_COUNT; c++) {
+            uint64_t total = 0;
+            for (size_t k = 0; k < DF_STATS_LIMB_CLASSES; k++) total += s.limbs[c][k];
+            if (total == 0) continue;
+            fprintf(out, "%s\"%s\": [", first ? "" : ", ", df_stat_name((df_stat_counter)c));
+            for (size_t k = 0; k < DF_STATS_LIMB_CLASSES; k++) {
+                fprintf(out, "%s%llu", k ? ", " : "", (unsigned long long)s.limbs[c][k]);
+            }
+            fprintf(out, "]");
+            first = false;
+        }
+        fprintf(out, "}}\n");
+        return;
+    }
+
+    fprintf(out, "%-28s %14s   operand limbs:", "counter", "value");
+    for (size_t k = 0; k < DF_STATS_LIMB_CLASSES; k++) fprintf(out, " %s", df_stats_class_label(k));
+    fprintf(out, "\n");
+    for (size_t c = 0; c < DF_STAT_COUNT; c++) {
+        if (s.count[c] == 0) continue;
+        fprintf(out, "%-28s %14llu", df_stat_name((df_stat_counter)c), (unsigned long long)s.count[c]);
+        uint64_t total = 0;
+        for (size_t k = 0; k < DF_STATS_LIMB_CLASSES; k++) total += s.limbs[c][k];
+        if (total) {
+            fprintf(out, "  ");
+            for (size_t k = 0; k < DF_STATS_LIMB_CLASSES; k++) {
+                fprintf(out, " %llu", (unsigned long long)s.limbs[c][k]);
+            }
+        }
+        fprintf(out, "\n");
+    }
+}
+
+#ifdef DF_LATENCY
+
+// Periodic dumping: the next deadline in nanoseconds (0 when disabled)
+static FILE* df_latency_dump_out = NULL;
+static uint64_t df_latency_dump_interval = 0;
+static uint64_t df_latency_dump_next = 0;
+static bool df_latency_dump_json = false;
+
+// Helper: Monotonic time in nanoseconds, falling back to the C11 wall clock
+static inline uint64_t df_latency_now(void) {
+    struct timespec ts;
+#ifdef CLOCK_MONOTONIC
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+    timespec_get(&ts, TIME_UTC);
+#endif
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// Helper: Bucket of a latency, with three significant bits
+static inline size_t df_latency_bucket(uint64_t ns) {
+    if (ns < 8) return (size_t)ns;
+#if defined(__GNUC__) || defined(__clang__)
+    size_t e = 63 - (size_t)__builtin_clzll(ns);
+#else
+    size_t e = 0;
+    while (ns >> (e + 1)) e++;
+#endif
+    size_t b = (e - 2) * 8 + (size_t)((ns >> (e - 3)) & 7);
+    return b < DF_LATENCY_BUCKETS ? b : DF_LATENCY_BUCKETS - 1;
+}
+
+// Helper: Largest latency that falls in a bucket
+static uint64_t df_latency_bucket_upper(size_t b) {
+    if (b < 8) return (uint64_t)b;
+    if (b == DF_LATENCY_BUCKETS - 1) return UINT64_MAX;
+    size_t e = b / 8 + 2;
+    return ((uint64_t)(8 + b % 8 + 1) << (e - 3)) - 1;
+}
+
+// Helper: File one sample and run a due periodic dump
+static void df_latency_record(df_stat_counter op, df_frac a, df_frac b, uint64_t start) {
+    uint64_t end = df_latency_now();
+    uint64_t ns = end > start ? end - start : 0;
+    size_t la = df_stats_frac_limbs(a);
+    size_t lb = df_stats_frac_limbs(b);
+    size_t size_class = df_stats_class(la > lb ? la : lb);
+
+    df_latency* h = &df_stats_thread_block()->latency;
+    uint64_t* slot = &h->count[op][size_class][df_latency_bucket(ns)];
+    df_stats_store(slot, df_stats_load(slot) + 1);
+    if (ns > df_stats_load(&h->max_ns[op][size_class])) df_stats_store(&h->max_ns[op][size_class], ns);
+
+    uint64_t next = df_stats_load(&df_latency_dump_next);
+    if (next == 0 || end < next) return;
+#if defined(__GNUC__) || defined(__clang__)
+    uint64_t interval = __atomic_load_n(&df_latency_dump_interval, __ATOMIC_RELAXED);
+    if (!__atomic_compare_exchange_n(&df_latency_dump_next, &next, end + interval, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+        return;
+    }
+    FILE* out = __atomic_load_n(&df_latency_dump_out, __ATOMIC_RELAXED);
+    bool json = __atomic_load_n(&df_latency_dump_json, __ATOMIC_RELAXED);
+#else
+    df_latency_dump_next = end + df_latency_dump_interval;
+    FILE* out = df_latency_dump_out;
+    bool json = df_latency_dump_json;
+#endif
+    if (out) df_latency_dump(out, json);
+}
+
+#define DF_TIMED(out, op, a, b, call)                  \
+    do {                                               \
+        uint64_t df_timed_start = df_latency_now();    \
+        out = call;                                    \
+        df_latency_record(op, a, b, df_timed_start);   \
+    } while (0)
+
+DF_IMPL void df_latency_snapshot(df_latency* out) {
+    DF_ASSERT(out && "df_latency_snapshot: output cannot be NULL");
+    memset(out, 0, sizeof(df_latency));
+
+    df_stats_block* block;
+#if defined(__GNUC__) || defined(__clang__)
+    block = __atomic_load_n(&df_stats_blocks, __ATOMIC_ACQUIRE);
+#else
+    block = df_stats_blocks;
+#endif
+    for (; block; block = block->next) {
+        for (size_t op = 0; op < DF_LATENCY_OPS; op++) {
+            for (size_t k = 0; k < DF_STATS_LIMB_CLASSES; k++) {
+                for (size_t b = 0; b < DF_LATENCY_BUCKETS; b++) {
+                    out->count[op][k][b] += df_stats_load(&block->latency.count[op][k][b]);
+                }
+                uint64_t max = df_stats_load(&block->latency.max_ns[op][k]);
+                if (max > out->max_ns[op][k]) out->max_ns[op][k] = max;
+            }
+        }
+    }
+}
+
+DF_IMPL uint64_t df_latency_quantile(const df_latency* h, df_stat_counter op, size_t size_class, double q) {
+    DF_ASSERT(h && "df_latency_quantile: histograms cannot be NULL");
+    DF_ASSERT((size_t)op < DF_LATENCY_OPS && "df_latency_quantile: operation is not timed");
+    DF_ASSERT(size_class < DF_STATS_LIMB_CLASSES && "df_latency_quantile: size class out of range");
+    DF_ASSERT(q >= 0.0 && q <= 1.0 && "df_latency_quantile: quantile must be in [0, 1]");
+
+    const uint64_t* buckets = h->count[op][size_class];
+    uint64_t total = 0;
+    for (size_t b = 0; b < DF_LATENCY_BUCKETS; b++) total += buckets[b];
+    if (total == 0) return 0;
+    if (q >= 1.0) return h->max_ns[op][size_class];
+
+    // The sample of rank ceil(q * total), counting from one
+    uint64_t rank = (uint64_t)ceil(q * (double)total);
+    if (rank == 0) rank = 1;
+    uint64_t seen = 0;
+    for (size_t b = 0; b < DF_LATENCY_BUCKETS; b++) {
+        seen += buckets[b];
+        if (seen >= rank) {
+            uint64_t upper = df_latency_bucket_upper(b);
+            return upper < h->max_ns[op][size_class] ? upper : h->max_ns[op][size_class];
+        }
+    }
+    return h->max_ns[op][size_class];
+}
+
+DF_IMPL void df_latency_dump(FILE* out, bool json) {
+    DF_ASSERT(out && "df_latency_dump: stream cannot be NULL");
+    df_latency* h = (df_latency*)DF_MALLOC(sizeof(df_latency));
+    DF_ASSERT(h && "df_latency_dump: allocation failed");
+    df_latency_snapshot(h);
+
+    bool first = true;
+    if (json) {
+        fprintf(out, "[");
+    } else {
+        fprintf(out, "%-8s %-6s %12s %10s %10s %10s %10s %12s\n", "op", "limbs", "count", "p50 ns", "p90 ns",
+                "p99 ns", "p99.9 ns", "max ns");
+    }
+    for (size_t op = 0; op < DF_LATENCY_OPS; op++) {
+        for (size_t k = 0; k < DF_STATS_LIMB_CLASSES; k++) {
+            uint64_t total = 0;
+            for (size_t b = 0; b < DF_LATENCY_BUCKETS; b++) total += h->count[op][k][b];
+            if (total == 0) continue;
+
+            df_stat_counter c = (df_stat_counter)op;
+            unsigned long long p50 = df_latency_quantile(h, c, k, 0.5);
+            unsigned long long p90 = df_latency_quantile(h, c, k, 0.9);
+            unsigned long long p99 = df_latency_quantile(h, c, k, 0.99);
+            unsigned long long p999 = df_latency_quantile(h, c, k, 0.999);
+            unsigned long long max = h->max_ns[op][k];
+            if (!json) {
+                fprintf(out, "%-8s %-6s %12llu %10llu %10llu %10llu %10llu %12llu\n", df_stat_name(c),
+                        df_stats_class_label(k), (unsigned long long)total, p50, p90, p99, p999, max);
+                continue;
+            }
+
+            fprintf(out,
+                    "%s{\"op\": \"%s\", \"limbs\": \"%s\", \"count\": %llu, \"p50\": %llu, \"p90\": %llu, "
+                    "\"p99\": %llu, \"p999\": %llu, \"max\": %llu, \"buckets\": [",
+                    first ? "" : ", ", df_stat_name(c), df_stats_class_label(k), (unsigned long long)total, p50,
+                    p90, p99, p999, max);
+            bool first_bucket = true;
+            for (size_t b = 0; b < DF_LATENCY_BUCKETS; b++) {
+                if (h->count[op][k][b] == 0) continue;
+                uint64_t upper = df_latency_bucket_upper(b);
+                fprintf(out, "%s[%llu, %llu]", first_bucket ? "" : ", ",
+                        (unsigned long long)(upper < max ? upper : max), (unsigned long long)h->count[op][k][b]);
+                first_bucket = false;
+            }
+            fprintf(out, "]}");
+            first = false;
+        }
+    }
+    if (json) fprintf(out, "]\n");
+    fflush(out);
+    DF_FREE(h);
+}
+
+DF_IMPL void df_latency_dump_every(FILE* out, uint64_t interval_ms, bool json) {
+    uint64_t interval = interval_ms * 1000000u;
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_store_n(&df_latency_dump_next, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&df_latency_dump_out, out, __ATOMIC_RELAXED);
+    __atomic_store_n(&df_latency_dump_json, json, __ATOMIC_RELAXED);
+    __atomic_store_n(&df_latency_dump_interval, interval, __ATOMIC_RELAXED);
+    if (out) __atomic_store_n(&df_latency_dump_next, df_latency_now() + interval, __ATOMIC_RELEASE);
+#else
+    df_latency_dump_out = out;
+    df_latency_dump_json = json;
+    df_latency_dump_interval = interval;
+    df_latency_dump_next = out ? df_latency_now() + interval : 0;
+#endif
+}
+
+#else
+
+#define DF_TIMED(out, op, a, b, call) ((out) = (call))
+
+#endif // DF_LATENCY
+
+#else
+
+#define DF_STAT(c) ((void)0)
+#define DF_STAT_N(c, n) ((void)0)
+#define DF_STAT_FRACS(c, a, b) ((void)0)
+#define DF_STAT_INTS(c, a, b) ((void)0)
+#define DF_TIMED(out, op, a, b, call) ((out) = (call))
+
+#endif // DF_STATS
+
+#ifdef DF_USDT
+
+// Static tracepoints of the "dynamic_fraction" provider. Each probe has a
+// semaphore that an attached tracer increments, and the probe's arguments
+// are only computed while it is nonzero. An idle probe costs one load and
+// a not-taken branch.
+#if defined(_SYS_SDT_H) && !defined(_SDT_HAS_SEMAPHORES)
+// sys/sdt.h was included earlier without semaphores, so the probes cannot
+// be gated and always evaluate their arguments
+#define DF_PROBE_ENABLED(name) 1
+#else
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+#define DF_PROBE_SEMAPHORE(name) \
+    __extension__ static unsigned short dynamic_fraction_##name##_semaphore __attribute__((used, section(".probes")))
+
+DF_PROBE_SEMAPHORE(alloc);
+DF_PROBE_SEMAPHORE(free);
+DF_PROBE_SEMAPHORE(reduce_entry);
+DF_PROBE_SEMAPHORE(reduce_exit);
+DF_PROBE_SEMAPHORE(di_gcd);
+DF_PROBE_SEMAPHORE(di_mul);
+DF_PROBE_SEMAPHORE(di_div);
+
+// The tracer writes the semaphore behind the compiler's back
+#define DF_PROBE_ENABLED(name) \
+    __builtin_expect(*(volatile unsigned short*)&dynamic_fraction_##name##_semaphore != 0, 0)
+#endif
+
+#define DF_PROBE2(name, a, b)                                                    \
+    do {                                                                         \
+        if (DF_PROBE_ENABLED(name)) DTRACE_PROBE2(dynamic_fraction, name, a, b); \
+    } while (0)
+#define DF_PROBE3(name, a, b, c)                                                    \
+    do {                                                                            \
+        if (DF_PROBE_ENABLED(name)) DTRACE_PROBE3(dynamic_fraction, name, a, b, c); \
+    } while (0)
+
+#else
+
+#define DF_PROBE_ENABLED(name) 0
+#define DF_PROBE2(name, a, b) ((void)0)
+#define DF_PROBE3(name, a, b, c) ((void)0)
+
+#endif // DF_USDT
+
+#if defined(DF_STATS) || defined(DF_USDT)
+
+// The integer operations the library calls are counted and traced through
+// wrappers; the macros are removed again at the end of the implementation
+static inline di_int df_probed_di_gcd(di_int a, di_int b) {
+    DF_STAT_INTS(DF_STAT_DI_GCD, a, b);
+    DF_PROBE2(di_gcd, di_limb_count(a), di_limb_count(b));
+    return di_gcd(a, b);
+}
+
+static inline di_int df_probed_di_mul(di_int a, di_int b) {
+    DF_STAT_INTS(DF_STAT_DI_MUL, a, b);
+    DF_PROBE2(di_mul, di_limb_count(a), di_limb_count(b));
+    return di_mul(a, b);
+}
+
+static inline di_int df_probed_di_div(di_int a, di_int b) {
+    DF_STAT_INTS(DF_STAT_DI_DIV, a, b);
+    DF_PROBE2(di_div, di_limb_count(a), di_limb_count(b));
+    return di_div(a, b);
+}
+
+static inline di_int df_probed_di_mod(di_int a, di_int b) {
+    DF_STAT_INTS(DF_STAT_DI_MOD, a, b);
+    return di_mod(a, b);
+}
+
+#define di_gcd(a, b) df_probed_di_gcd((a), (b))
+#define di_mul(a, b) df_probed_di_mul((a), (b))
+#define di_div(a, b) df_probed_di_div((a), (b))
+#define di_mod(a, b) df_probed_di_mod((a), (b))
+
+#endif
+
+#ifdef DF_TRACE
+
+// The open trace, the session it belongs to and the next id to hand out
+static FILE* df_trace_file = NULL;
+static uint64_t df_trace_session = 0;
+static uint64_t df_trace_next_id = 1;
+
+// Helper: Append a LEB128 varint to a record buffer
+static size_t df_trace_varint(uint8_t* buf, uint64_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        buf[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    buf[n++] = (uint8_t)v;
+    return n;
+}
+
+// Helper: Zigzag encoding, so small negative values stay short
+static inline uint64_t df_trace_zigzag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+// Helper: Id of f in the open trace, writing its value on first sight
+static uint64_t df_trace_operand(df_frac f) {
+    if (f->trace_session == df_trace_session) return f->trace_id;
+    f->trace_session = df_trace_session;
+    f->trace_id = df_trace_next_id++;
+
+    uint8_t buf[32];
+    size_t n = 0;
+    buf[n++] = DF_TRACE_VALUE;
+    n += df_trace_varint(buf + n, f->trace_id);
+
+    int64_t num;
+    int64_t den;
+    if (di_to_int64(f->numerator, &num) && di_to_int64(f->denominator, &den)) {
+        buf[n++] = 0;
+        n += df_trace_varint(buf + n, df_trace_zigzag(num));
+        n += df_trace_varint(buf + n, df_trace_zigzag(den));
+        fwrite(buf, 1, n, df_trace_file);
+        return f->trace_id;
+    }
+
+    char* num_str = di_to_string(f->numerator, 10);
+    char* den_str = di_to_string(f->denominator, 10);
+    size_t num_len = strlen(num_str);
+    size_t den_len = strlen(den_str);
+    buf[n++] = 1;
+    n += df_trace_varint(buf + n, num_len + 1 + den_len);
+    fwrite(buf, 1, n, df_trace_file);
+    fwrite(num_str, 1, num_len, df_trace_file);
+    fputc('/', df_trace_file);
+    fwrite(den_str, 1, den_len, df_trace_file);
+    free(num_str);
+    free(den_str);
+    return f->trace_id;
+}
+
+// Helper: Id for a result, keeping the one an already known result has
+static uint64_t df_trace_result(df_frac f) {
+    if (f->trace_session != df_trace_session) {
+        f->trace_session = df_trace_session;
+        f->trace_id = df_trace_next_id++;
+    }
+    return f->trace_id;
+}
+
+// Helper: Record an operation producing a fraction (b is NULL when unary)
+static void df_trace_op_frac(df_trace_op op, df_frac a, df_frac b, df_frac result) {
+    if (!df_trace_file) return;
+    uint64_t ia = df_trace_operand(a);
+    uint64_t ib = b ? df_trace_operand(b) : 0;
+    uint64_t ir = df_trace_result(result);
+
+    uint8_t buf[32];
+    size_t n = 0;
+    buf[n++] = (uint8_t)op;
+    n += df_trace_varint(buf + n, ia);
+    if (b) n += df_trace_varint(buf + n, ib);
+    n += df_trace_varint(buf + n, ir);
+    fwrite(buf, 1, n, df_trace_file);
+}
+
+// Helper: Record a comparison and its outcome
+static void df_trace_op_cmp(df_trace_op op, df_frac a, df_frac b, int result) {
+    if (!df_trace_file) return;
+    uint64_t ia = df_trace_operand(a);
+    uint64_t ib = df_trace_operand(b);
+
+    uint8_t buf[32];
+    size_t n = 0;
+    buf[n++] = (uint8_t)op;
+    n += df_trace_varint(buf + n, ia);
+    n += df_trace_varint(buf + n, ib);
+    n += df_trace_varint(buf + n, df_trace_zigzag(result));
+    fwrite(buf, 1, n, df_trace_file);
+}
+
+// Helper: Record that a traced fraction was freed
+static void df_trace_free(df_frac f) {
+    if (!df_trace_file || f->trace_session != df_trace_session) return;
+    uint8_t buf[16];
+    size_t n = 0;
+    buf[n++] = DF_TRACE_RELEASE;
+    n += df_trace_varint(buf + n, f->trace_id);
+    fwrite(buf, 1, n, df_trace_file);
+}
+
+DF_IMPL bool df_trace_open(const char* path) {
+    DF_ASSERT(path && "df_trace_open: path cannot be NULL");
+    df_trace_close();
+    df_trace_file = fopen(path, "wb");
+    if (!df_trace_file) return false;
+    fwrite("DFTRACE1", 1, 8, df_trace_file);
+
+    // Ids from an earlier trace must not leak into this one
+    df_trace_session++;
+    df_trace_next_id = 1;
+    return true;
+}
+
+DF_IMPL void df_trace_close(void) {
+    if (!df_trace_file) return;
+    fclose(df_trace_file);
+    df_trace_file = NULL;
+}
+
+#define DF_TRACE_FRAC(op, a, b, result) df_trace_op_frac((op), (a), (b), (result))
+#define DF_TRACE_CMP(op, a, b, result) df_trace_op_cmp((op), (a), (b), (result))
+#define DF_TRACE_FREE(f) df_trace_free(f)
+
+#else
+
+#define DF_TRACE_FRAC(op, a, b, result) ((void)0)
+#define DF_TRACE_CMP(op, a, b, result) ((void)0)
+#define DF_TRACE_FREE(f) ((void)0)
+
+#endif // DF_TRACE
+
+// Helper: Allocate a new fraction structure
+static df_frac df_alloc(void) {
+    df_frac f = (df_frac)DF_MALLOC(sizeof(struct df_frac_internal));
+    DF_ASSERT(f && "df_alloc: memory allocation failed");
+    DF_STAT(DF_STAT_ALLOC);
+    DF_STAT_N(DF_STAT_ALLOC_BYTES, sizeof(struct df_frac_internal));
+    DF_PROBE2(alloc, f, sizeof(struct df_frac_internal));
+    f->numerator = NULL;
+    f->denominator = NULL;
+    f->ref_count = 1;
+    f->has_approx = false;
+    f->is_dyadic = false;
+    f->den_log2 = 0;
+    f->hash = 0;
+#ifdef DF_TRACE
+    f->trace_id = 0;
+    f->trace_session = 0;
+#endif
+    return f;
+}
+
+// Helper: Free a fraction object whose components are already released,
+// pairing the free probe, trace record and counters with df_alloc's
+static void df_free(df_frac f) {
+    DF_PROBE2(free, f, sizeof(struct df_frac_internal));
+    DF_TRACE_FREE(f);
+    DF_FREE(f);
+    DF_STAT(DF_STAT_FREE);
+    DF_STAT_N(DF_STAT_FREE_BYTES, sizeof(struct df_frac_internal));
+}
+
+static uint64_t df_hash_parts(df_frac f, int64_t* num, uint64_t* den);
+
+#ifdef DF_INTERN
+
+// Global table of live fractions, each the only instance of its value.
+// Slots hold no references: df_release() removes an entry as its last
+// reference goes.
+static df_frac* df_intern_slots = NULL;
+static size_t df_intern_capacity = 0;
+static size_t df_intern_count = 0;
+
+// Helper: Double the table (load factor at most 1/2 for linear probing)
+static void df_intern_grow(void) {
+    df_frac* old = df_intern_slots;
+    size_t old_capacity = df_intern_capacity;
+    df_intern_capacity = old_capacity ? old_capacity * 2 : 1024;
+    df_intern_slots = (df_frac*)DF_MALLOC(sizeof(df_frac) * df_intern_capacity);
+    DF_ASSERT(df_intern_slots && "df_intern: allocation failed");
+    memset(df_intern_slots, 0, sizeof(df_frac) * df_intern_capacity);
+
+    size_t mask = df_intern_capacity - 1;
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (!old[i]) continue;
+        size_t j = (size_t)old[i]->hash & mask;
+        while (df_intern_slots[j]) j = (j + 1) & mask;
+        df_intern_slots[j] = old[i];
+    }
+    DF_FREE(old);
+}
+
+// Helper: Drop f from the table if present (backward-shift deletion)
+static void df_intern_remove(df_frac f) {
+    if (df_intern_capacity == 0) return;
+
+    size_t mask = df_intern_capacity - 1;
+    size_t i = (size_t)f->hash & mask;
+    while (df_intern_slots[i] != f) {
+        if (!df_intern_slots[i]) return;
+        i = (i + 1) & mask;
+    }
+
+    // Pull back each follower whose home is not between the hole and it
+    for (size_t j = (i + 1) & mask; df_intern_slots[j]; j = (j + 1) & mask) {
+        size_t home = (size_t)df_intern_slots[j]->hash & mask;
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+            df_intern_slots[i] = df_intern_slots[j];
+            i = j;
+        }
+    }
+    df_intern_slots[i] = NULL;
+    df_intern_count--;
+}
+
+// Helper: The unique instance of a newly built fraction, consuming f
+static df_frac df_unique(df_frac f) {
+    int64_t num;
+    uint64_t den;
+    f->hash = df_hash_parts(f, &num, &den);
+    if ((df_intern_count + 1) * 2 > df_intern_capacity) df_intern_grow();
+
+    size_t mask = df_intern_capacity - 1;
+    size_t i = (size_t)f->hash & mask;
+    for (df_frac g; (g = df_intern_slots[i]) != NULL; i = (i + 1) & mask) {
+        if (g->hash == f->hash && di_eq(g->numerator, f->numerator) && di_eq(g->denominator, f->denominator)) {
+            df_release(&f);
+            g->ref_count++;
+            return g;
+        }
+    }
+
+    df_intern_slots[i] = f;
+    df_intern_count++;
+    return f;
+}
+
+DF_IMPL size_t df_intern_size(void) {
+    DF_STAT(DF_STAT_INTERN_SIZE);
+    return df_intern_count;
+}
+
+#else
+
+// Helper: Identity unless fractions are interned
+static inline df_frac df_unique(df_frac f) {
+    return f;
+}
+
+#endif // DF_INTERN
+
+// Helper: Trailing zero bits of a nonzero 64-bit value
+static size_t df_ctz64(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (size_t)__builtin_ctzll(v);
+#else
+    size_t n = 0;
+    while ((v & 1) == 0) {
+        v >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+// Helper: n <= 64 bits of the magnitude of x starting at bit pos
+static uint64_t df_di_bits(di_int x, size_t pos, unsigned n) {
+    size_t count;
+    const di_limb_t* limbs = di_limbs(x, &count);
+    uint64_t v = 0;
+    for (unsigned got = 0; got < n;) {
+        size_t limb = (pos + got) / DI_LIMB_BITS;
+        unsigned offset = (unsigned)((pos + got) % DI_LIMB_BITS);
+        if (limb >= count) break;
+        unsigned take = DI_LIMB_BITS - offset;
+        if (take > n - got) take = n - got;
+        uint64_t chunk = ((uint64_t)limbs[limb] >> offset) & (take == 64 ? UINT64_MAX : (((uint64_t)1 << take) - 1));
+        v |= chunk << got;
+        got += take;
+    }
+    return v;
+}
+
+// Helper: Whether any bit of the magnitude of x below bit pos is set
+static bool df_di_any_below(di_int x, size_t pos) {
+    size_t count;
+    const di_limb_t* limbs = di_limbs(x, &count);
+    size_t full = pos / DI_LIMB_BITS;
+    for (size_t i = 0; i < full && i < count; i++) {
+        if (limbs[i]) return true;
+    }
+    unsigned rest = (unsigned)(pos % DI_LIMB_BITS);
+    return rest && full < count && ((uint64_t)limbs[full] & (((uint64_t)1 << rest) - 1)) != 0;
+}
+
+// Helper: Trailing zero bits in the magnitude of a nonzero di_int
+static size_t df_di_ctz(di_int x) {
+    DF_ASSERT(!di_is_zero(x) && "df_di_ctz: operand cannot be zero");
+
+    size_t count;
+    const di_limb_t* limbs = di_limbs(x, &count);
+    size_t i = 0;
+    while (limbs[i] == 0) i++;
+    return i * DI_LIMB_BITS + df_ctz64((uint64_t)limbs[i]);
+}
+
+// Helper: Set the dyadic flag from the (positive, reduced) denominator
+static void df_classify_dyadic(df_frac f) {
+    uint64_t den;
+    if (di_to_uint64(f->denominator, &den)) {
+        f->is_dyadic = (den & (den - 1)) == 0;
+        f->den_log2 = f->is_dyadic ? df_ctz64(den) : 0;
+        return;
+    }
+    // An odd denominator above one is never a power of two
+    size_t count;
+    if (di_limbs(f->denominator, &count)[0] & 1) {
+        f->is_dyadic = false;
+        f->den_log2 = 0;
+        return;
+    }
+    size_t twos = df_di_ctz(f->denominator);
+    f->is_dyadic = (twos + 1 == di_bit_length(f->denominator));
+    f->den_log2 = f->is_dyadic ? twos : 0;
+}
+
+// Helper: Build num / 2^exp in lowest terms, taking ownership of num
+static df_frac df_dyadic_make(di_int num, size_t exp) {
+    df_frac f = df_alloc();
+    f->is_dyadic = true;
+
+    if (di_is_zero(num)) {
+        f->numerator = num;
+        f->denominator = di_one();
+        return df_unique(f);
+    }
+
+    size_t shift = 0;
+    if (exp > 0) {
+        shift = df_di_ctz(num);
+        if (shift > exp) shift = exp;
+    }
+    if (shift > 0) {
+        di_int reduced = di_shift_right(num, shift);
+        di_release(&num);
+        num = reduced;
+    }
+
+    di_int one = di_one();
+    f->numerator = num;
+    f->denominator = di_shift_left(one, exp - shift);
+    f->den_log2 = exp - shift;
+    di_release(&one);
+    return df_unique(f);
+}
+
+// Helper: Numerator of a dyadic fraction scaled to denominator 2^exp
+static di_int df_dyadic_aligned(df_frac f, size_t exp) {
+    if (exp == f->den_log2) return di_retain(f->numerator);
+    return di_shift_left(f->numerator, exp - f->den_log2);
+}
+
+// Helper: a + b or a - b for dyadic operands
+static df_frac df_dyadic_add_sub(df_frac a, df_frac b, bool subtract) {
+    size_t exp = a->den_log2 > b->den_log2 ? a->den_log2 : b->den_log2;
+    di_int x = df_dyadic_aligned(a, exp);
+    di_int y = df_dyadic_aligned(b, exp);
+    di_int num = subtract ? di_sub(x, y) : di_add(x, y);
+    di_release(&x);
+    di_release(&y);
+    return df_dyadic_make(num, exp);
+}
+
+// Helper: Approximation for components too large for di_to_double
+//
+// Both components are truncated to their top 64 bits (relative error below
+// 2^-63 each) and the binary exponent difference is applied with ldexp,
+// which is exact unless the result underflows.
+static void df_approx_scaled(df_frac f, size_t num_bits, size_t den_bits) {
+    size_t num_shift = num_bits > 64 ? num_bits - 64 : 0;
+    size_t den_shift = den_bits > 64 ? den_bits - 64 : 0;
+    di_int num = di_shift_right(f->numerator, num_shift);
+    di_int den = di_shift_right(f->denominator, den_shift);
+
+    double exp = (double)num_shift - (double)den_shift;
+    if (exp > 4096) exp = 4096;
+    if (exp < -4096) exp = -4096;
+
+    f->approx = ldexp(di_to_double(num) / di_to_double(den), (int)exp);
+    f->approx_err = isfinite(f->approx) ? fabs(f->approx) * 8 * DBL_EPSILON + DBL_TRUE_MIN : INFINITY;
+    f->has_approx = true;
+
+    di_release(&num);
+    di_release(&den);
+}
+
+// Helper: Compute the cached double approximation and its error bound
+//
+// di_to_double sums limbs from the least significant end, so each conversion
+// is within (limbs - 1) rounding errors; the division adds one more. The
+// bound is doubled so that approx +/- err can itself be evaluated in double
+// without losing enclosure, and DBL_TRUE_MIN covers underflow of the quotient.
+static void df_approx(df_frac f) {
+    if (f->has_approx) return;
+
+    size_t num_bits = di_bit_length(f->numerator);
+    size_t den_bits = di_bit_length(f->denominator);
+    if (num_bits > 1000 || den_bits > 1000) {
+        df_approx_scaled(f, num_bits, den_bits);
+        return;
+    }
+
+    double num = di_to_double(f->numerator);
+    double den = di_to_double(f->denominator);
+    f->approx = num / den;
+
+    if (isfinite(num) && isfinite(den) && isfinite(f->approx)) {
+        double rounding_steps = (double)(di_limb_count(f->numerator) + di_limb_count(f->denominator) + 2);
+        f->approx_err = fabs(f->approx) * rounding_steps * DBL_EPSILON + DBL_TRUE_MIN;
+    } else {
+        f->approx_err = INFINITY;
+    }
+    f->has_approx = true;
+}
+
+// Helper: Correctly rounded double of a dyadic fraction num / 2^k
+//
+// The magnitude is rounded to nearest-even at the last bit a double can
+// hold, 53 significant bits or the 2^-1074 place for subnormals, so the
+// conversion and the scaling by ldexp() are both exact.
+static double df_dyadic_to_double(df_frac f) {
+    if (di_is_zero(f->numerator)) return 0.0;
+    size_t len = di_bit_length(f->numerator);
+    double k = (double)f->den_log2;
+
+    // Lowest kept bit position, relative to the numerator's bit 0
+    double drop = (double)len - 53;
+    if (drop - k < -1074) drop = k - 1074;
+
+    double magnitude;
+    if (drop <= 0) {
+        magnitude = (double)df_di_bits(f->numerator, 0, 64);
+    } else if (drop > (double)len) {
+        magnitude = 0.0;  // below half of the smallest subnormal
+    } else {
+        size_t d = (size_t)drop;
+        uint64_t kept = df_di_bits(f->numerator, d, 54);
+        bool half = (df_di_bits(f->numerator, d - 1, 1) & 1) != 0;
+        if (half && (df_di_any_below(f->numerator, d - 1) || (kept & 1))) kept++;
+        magnitude = (double)kept;
+    }
+
+    double exp = (drop > 0 ? drop : 0) - k;
+    if (exp > 4096) exp = 4096;
+    if (exp < -4096) exp = -4096;
+    double result = ldexp(magnitude, (int)exp);
+    return di_is_negative(f->numerator) ? -result : result;
+}
+
+// Helper: Wrap an already-reduced pair (positive denominator), taking ownership
+static df_frac df_from_reduced(di_int numerator, di_int denominator) {
+    DF_ASSERT(numerator && denominator && "df_from_reduced: components cannot be NULL");
+    df_frac f = df_alloc();
+    f->numerator = numerator;
+    f->denominator = denominator;
+    df_classify_dyadic(f);
+    return df_unique(f);
+}
+
+// Helper: Divide out the common factors of numerator and denominator
+static void df_reduce_terms(df_frac f) {
+    // A power-of-two denominator only shares factors of two with the numerator
+    df_classify_dyadic(f);
+    if (f->is_dyadic) {
+        DF_STAT(DF_STAT_GCD_SKIPPED);
+        if (f->den_log2 == 0) return;
+        if (di_is_zero(f->numerator)) {
+            di_release(&f->denominator);
+            f->denominator = di_one();
+            f->den_log2 = 0;
+            return;
+        }
+
+        size_t shift = df_di_ctz(f->numerator);
+        if (shift > f->den_log2) shift = f->den_log2;
+        if (shift > 0) {
+            di_int new_num = di_shift_right(f->numerator, shift);
+            di_int new_den = di_shift_right(f->denominator, shift);
+            di_release(&f->numerator);
+            di_release(&f->denominator);
+            f->numerator = new_num;
+            f->denominator = new_den;
+            f->den_log2 -= shift;
+        }
+        return;
+    }
+
+    // Get GCD of numerator and denominator
+    DF_STAT(DF_STAT_GCD_EXECUTED);
+    di_int gcd = di_gcd(f->numerator, f->denominator);
+    if (!gcd || di_is_one(gcd)) {
+        DF_STAT(DF_STAT_GCD_TRIVIAL);
+        di_release(&gcd);
+        return;
+    }
+
+    // Divide both by GCD
+    di_int new_num = di_div(f->numerator, gcd);
+    di_int new_den = di_div(f->denominator, gcd);
+
+    di_release(&f->numerator);
+    di_release(&f->denominator);
+    f->numerator = new_num;
+    f->denominator = new_den;
+    df_classify_dyadic(f);
+
+    di_release(&gcd);
+}
+
+// Helper: Reduce fraction to lowest terms
+static void df_reduce(df_frac f) {
+    DF_ASSERT(f && "df_reduce: fraction cannot be NULL");
+    DF_ASSERT(f->numerator && "df_reduce: numerator cannot be NULL");
+    DF_ASSERT(f->denominator && "df_reduce: denominator cannot be NULL");
+    DF_STAT(DF_STAT_REDUCE);
+    DF_PROBE3(reduce_entry, f, di_limb_count(f->numerator), di_limb_count(f->denominator));
+    df_reduce_terms(f);
+    DF_PROBE3(reduce_exit, f, di_limb_count(f->numerator), di_limb_count(f->denominator));
+}
+
+// Helper: Ensure denominator is positive (move sign to numerator)
+static void df_normalize_sign(df_frac f) {
+    DF_ASSERT(f && "df_normalize_sign: fraction cannot be NULL");
+    DF_ASSERT(f->denominator && "df_normalize_sign: denominator cannot be NULL");
+
+    if (di_is_negative(f->denominator)) {
+        di_int neg_num = di_negate(f->numerator);
+        di_int neg_den = di_negate(f->denominator);
+
+        di_release(&f->numerator);
+        di_release(&f->denominator);
+        f->numerator = neg_num;
+        f->denominator = neg_den;
+    }
+}
+
+// Create fraction from int64 values
+DF_IMPL df_frac df_from_ints(int64_t numerator, int64_t denominator) {
+    DF_ASSERT(denominator != 0 && "df_from_ints: denominator cannot be zero");
+    DF_STAT(DF_STAT_FROM_INTS);
+
+    df_frac f = df_alloc();
+    DF_ASSERT(f && "df_from_ints: allocation failed");
+
+    f->numerator = di_from_int64(numerator);
+    f->denominator = di_from_int64(denominator);
+
+    if (!f->numerator || !f->denominator) {
+        di_release(&f->numerator);
+        di_release(&f->denominator);
+        df_free(f);
+        return NULL;
+    }
+
+    df_normalize_sign(f);
+    df_reduce(f);
+    return df_unique(f);
+}
+
+// Create fraction from di_int values
+DF_IMPL df_frac df_from_di(di_int numerator, di_int denominator) {
+    DF_ASSERT(numerator && "df_from_di: numerator cannot be NULL");
+    DF_ASSERT(denominator && !di_is_zero(denominator) && "df_from_di: denominator cannot be zero");
+    DF_STAT(DF_STAT_FROM_DI);
+
+    df_frac f = df_alloc();
+    DF_ASSERT(f && "df_from_ints: allocation failed");
+
+    f->numerator = di_retain(numerator);
+    f->denominator = di_retain(denominator);
+
+    df_normalize_sign(f);
+    df_reduce(f);
+    return df_unique(f);
+}
+
+// Create fraction from integer
+DF_IMPL df_frac df_from_int(int64_t value) {
+    DF_STAT(DF_STAT_FROM_INT);
+    return df_from_ints(value, 1);
+}
+
+// Create fraction from double using continued fractions
+DF_IMPL df_frac df_from_double(double value, int64_t max_denominator) {
+    DF_STAT(DF_STAT_FROM_DOUBLE);
+    if (isnan(value) || isinf(value)) return NULL;
+    if (max_denominator <= 0) max_denominator = INT64_MAX;
+
+    // Handle negative values
+    bool negative = value < 0;
+    if (negative) value = -value;
+
+    // Continued fraction algorithm
+    int64_t h0 = 0, h1 = 1;
+    int64_t k0 = 1, k1 = 0;
+    double x = value;
+
+    while (k1 <= max_denominator) {
+        int64_t a = (int64_t)floor(x);
+        int64_t h2 = a * h1 + h0;
+        int64_t k2 = a * k1 + k0;
+
+        if (k2 > max_denominator) break;
+
+        h0 = h1; h1 = h2;
+        k0 = k1; k1 = k2;
+
+        if (fabs(value - (double)h1 / (double)k1) < 1e-15) break;
+
+        x = 1.0 / (x - a);
+        if (x > 1e15) break; // Avoid overflow
+    }
+
+    return df_from_ints(negative ? -h1 : h1, k1);
+}
+
+// Copy a fraction
+DF_IMPL df_frac df_copy(df_frac f) {
+    DF_ASSERT(f && "df_copy: fraction cannot be NULL");
+    DF_STAT(DF_STAT_COPY);
+    di_int num = di_retain(f->numerator);
+    di_int den = di_retain(f->denominator);
+    df_frac result = df_from_di(num, den);
+    di_release(&num);
+    di_release(&den);
+    return result;
+}
+
+// Retain (increase reference count)
+DF_IMPL df_frac df_retain(df_frac f) {
+    DF_ASSERT(f && "df_retain: fraction cannot be NULL");
+    DF_STAT(DF_STAT_RETAIN);
+    f->ref_count++;
+    return f;
+}
+
+// Release (decrease reference count)
+DF_IMPL void df_release(df_frac* f) {
+    DF_STAT(DF_STAT_RELEASE);
+    if (!f || !*f) return;
+
+    (*f)->ref_count--;
+    if ((*f)->ref_count == 0) {
+#ifdef DF_INTERN
+        df_intern_remove(*f);
+#endif
+        di_release(&(*f)->numerator);
+        di_release(&(*f)->denominator);
+        df_free(*f);
+    }
+    *f = NULL;
+}
+
+// Addition: a/b + c/d = (ad + bc) / bd
+static df_frac df_add_impl(df_frac a, df_frac b) {
+    if (a->is_dyadic && b->is_dyadic) return df_dyadic_add_sub(a, b, false);
+
+    // Calculate ad and bc
+    di_int ad = di_mul(a->numerator, b->denominator);
+    di_int bc = di_mul(b->numerator, a->denominator);
+    di_int num = di_add(ad, bc);
+
+    // Calculate bd
+    di_int den = di_mul(a->denominator, b->denominator);
+
+    df_frac result = df_from_di(num, den);
+
+    di_release(&ad);
+    di_release(&bc);
+    di_release(&num);
+    di_release(&den);
+
+    return result;
+}
+
+DF_IMPL df_frac df_add(df_frac a, df_frac b) {
+    DF_ASSERT(a && "df_add: first operand cannot be NULL");
+    DF_ASSERT(b && "df_add: second operand cannot be NULL");
+    DF_STAT_FRACS(DF_STAT_ADD, a, b);
+    df_frac result;
+    DF_TIMED(result, DF_STAT_ADD, a, b, df_add_impl(a, b));
+    DF_TRACE_FRAC(DF_TRACE_ADD, a, b, result);
+    return result;
+}
+
+// Subtraction: a/b - c/d = (ad - bc) / bd
+static df_frac df_sub_impl(df_frac a, df_frac b) {
+    if (a->is_dyadic && b->is_dyadic) return df_dyadic_add_sub(a, b, true);
+
+    // Calculate ad and bc
+    di_int ad = di_mul(a->numerator, b->denominator);
+    di_int bc = di_mul(b->numerator, a->denominator);
+    di_int num = di_sub(ad, bc);
+
+    // Calculate bd
+    di_int den = di_mul(a->denominator, b->denominator);
+
+    df_frac result = df_from_di(num, den);
+
+    di_release(&ad);
+    di_release(&bc);
+    di_release(&num);
+    di_release(&den);
+
+    return result;
+}
+
+DF_IMPL df_frac df_sub(df_frac a, df_frac b) {
+    DF_ASSERT(a && "df_sub: first operand cannot be NULL");
+    DF_ASSERT(b && "df_sub: second operand cannot be NULL");
+    DF_STAT_FRACS(DF_STAT_SUB, a, b);
+    df_frac result;
+    DF_TIMED(result, DF_STAT_SUB, a, b, df_sub_impl(a, b));
+    DF_TRACE_FRAC(DF_TRACE_SUB, a, b, result);
+    return result;
+}
+
+// Multiplication: (a/b) * (c/d) = ac / bd
+static df_frac df_mul_impl(df_frac a, df_frac b) {
+    if (a->is_dyadic && b->is_dyadic) {
+        return df_dyadic_make(di_mul(a->numerator, b->numerator), a->den_log2 + b->den_log2);
+    }
+
+    di_int num = di_mul(a->numerator, b->numerator);
+    di_int den = di_mul(a->denominator, b->denominator);
+
+    df_frac result = df_from_di(num, den);
+
+    di_release(&num);
+    di_release(&den);
+
+    return result;
+}
+
+DF_IMPL df_frac df_mul(df_frac a, df_frac b) {
+    DF_ASSERT(a && "df_mul: first operand cannot be NULL");
+    DF_ASSERT(b && "df_mul: second operand cannot be NULL");
+    DF_STAT_FRACS(DF_STAT_MUL, a, b);
+    df_frac result;
+    DF_TIMED(result, DF_STAT_MUL, a, b, df_mul_impl(a, b));
+    DF_TRACE_FRAC(DF_TRACE_MUL, a, b, result);
+    return result;
+}
+
+// Division: (a/b) / (c/d) = ad / bc
+static df_frac df_div_impl(df_frac a, df_frac b) {
+    di_int num = di_mul(a->numerator, b->denominator);
+    di_int den = di_mul(a->denominator, b->numerator);
+
+    df_frac result = df_from_di(num, den);
+
+    di_release(&num);
+    di_release(&den);
+
+    return result;
+}
+
+DF_IMPL df_frac df_div(df_frac a, df_frac b) {
+    DF_ASSERT(a && "df_div: dividend cannot be NULL");
+    DF_ASSERT(b && "df_div: divisor cannot be NULL");
+    DF_ASSERT(!df_is_zero(b) && "df_div: division by zero");
+    DF_STAT_FRACS(DF_STAT_DIV, a, b);
+    df_frac result;
+    DF_TIMED(result, DF_STAT_DIV, a, b, df_div_impl(a, b));
+    DF_TRACE_FRAC(DF_TRACE_DIV, a, b, result);
+    return result;
+}
+
+// Negate
+DF_IMPL df_frac df_negate(df_frac f) {
+    DF_ASSERT(f && "df_negate: operand cannot be NULL");
+    DF_STAT(DF_STAT_NEGATE);
+
+    di_int neg_num = di_negate(f->numerator);
+    di_int den = di_retain(f->denominator);
+    df_frac result = df_from_di(neg_num, den);
+    di_release(&neg_num);
+    di_release(&den);
+
+    DF_TRACE_FRAC(DF_TRACE_NEGATE, f, NULL, result);
+    return result;
+}
+
+// Absolute value
+DF_IMPL df_frac df_abs(df_frac f) {
+    DF_ASSERT(f && "df_abs: operand cannot be NULL");
+    DF_STAT(DF_STAT_ABS);
+
+    di_int abs_num = di_abs(f->numerator);
+    di_int den = di_retain(f->denominator);
+    df_frac result = df_from_di(abs_num, den);
+    di_release(&abs_num);
+    di_release(&den);
+
+    DF_TRACE_FRAC(DF_TRACE_ABS, f, NULL, result);
+    return result;
+}
+
+// Reciprocal
+DF_IMPL df_frac df_reciprocal(df_frac f) {
+    DF_ASSERT(f && "df_reciprocal: operand cannot be NULL");
+    DF_ASSERT(!df_is_zero(f) && "df_reciprocal: reciprocal of zero");
+    DF_STAT(DF_STAT_RECIPROCAL);
+
+    di_int num = di_retain(f->denominator);
+    di_int den = di_retain(f->numerator);
+    df_frac result = df_from_di(num, den);
+    di_release(&num);
+    di_release(&den);
+    DF_TRACE_FRAC(DF_TRACE_RECIPROCAL, f, NULL, result);
+    return result;
+}
+
+// Compare two fractions
+static int df_cmp_impl(df_frac a, df_frac b) {
+    if (a == b) return 0;
+
+    // Signs decide most mixed comparisons without touching the magnitudes
+    int sign_a = df_sign(a);
+    int sign_b = df_sign(b);
+    if (sign_a != sign_b) return sign_a < sign_b ? -1 : 1;
+    if (sign_a == 0) return 0;
+
+    // Floating-point filter: disjoint intervals decide the comparison
+    df_approx(a);
+    df_approx(b);
+    if (a->approx + a->approx_err < b->approx - b->approx_err) {
+        DF_STAT(DF_STAT_CMP_FILTERED);
+        return -1;
+    }
+    if (a->approx - a->approx_err > b->approx + b->approx_err) {
+        DF_STAT(DF_STAT_CMP_FILTERED);
+        return 1;
+    }
+
+    // Equal denominators only need the numerators compared
+    if (di_eq(a->denominator, b->denominator)) {
+        return di_compare(a->numerator, b->numerator);
+    }
+
+    // Dyadic operands align with a shift instead of two multiplications
+    if (a->is_dyadic && b->is_dyadic) {
+        size_t exp = a->den_log2 > b->den_log2 ? a->den_log2 : b->den_log2;
+        di_int x = df_dyadic_aligned(a, exp);
+        di_int y = df_dyadic_aligned(b, exp);
+        int result = di_compare(x, y);
+        di_release(&x);
+        di_release(&y);
+        return result;
+    }
+
+    // Compare a/b with c/d by comparing ad with bc
+    di_int ad = di_mul(a->numerator, b->denominator);
+    di_int bc = di_mul(b->numerator, a->denominator);
+
+    int result = di_compare(ad, bc);
+
+    di_release(&ad);
+    di_release(&bc);
+
+    return result;
+}
+
+DF_IMPL int df_cmp(df_frac a, df_frac b) {
+    DF_ASSERT(a && "df_cmp: first operand cannot be NULL");
+    DF_ASSERT(b && "df_cmp: second operand cannot be NULL");
+    DF_STAT_FRACS(DF_STAT_CMP, a, b);
+    int result;
+    DF_TIMED(result, DF_STAT_CMP, a, b, df_cmp_impl(a, b));
+    DF_TRACE_CMP(DF_TRACE_CMP, a, b, result);
+    return result;
+}
+
+// Equality test (reduced forms are canonical, so compare structurally)
+static bool df_eq_impl(df_frac a, df_frac b) {
+    if (a == b) return true;
+#ifdef DF_INTERN
+    return false;
+#else
+    return di_eq(a->numerator, b->numerator) && di_eq(a->denominator, b->denominator);
+#endif
+}
+
+DF_IMPL bool df_eq(df_frac a, df_frac b) {
+    DF_ASSERT(a && "df_eq: first operand cannot be NULL");
+    DF_ASSERT(b && "df_eq: second operand cannot be NULL");
+    DF_STAT_FRACS(DF_STAT_EQ, a, b);
+    bool result = df_eq_impl(a, b);
+    DF_TRACE_CMP(DF_TRACE_EQ, a, b, result);
+    return result;
+}
+
+// Inequality test
+DF_IMPL bool df_ne(df_frac a, df_frac b) {
+    DF_STAT(DF_STAT_NE);
+    return !df_eq(a, b);
+}
+
+// Less than
+DF_IMPL bool df_lt(df_frac a, df_frac b) {
+    DF_STAT(DF_STAT_LT);
+    return df_cmp(a, b) < 0;
+}
+
+// Less than or equal
+DF_IMPL bool df_le(df_frac a, df_frac b) {
+    DF_STAT(DF_STAT_LE);
+    return df_cmp(a, b) <= 0;
+}
+
+// Greater than
+DF_IMPL bool df_gt(df_frac a, df_frac b) {
+    DF_STAT(DF_STAT_GT);
+    return df_cmp(a, b) > 0;
+}
+
+// Greater than or equal
+DF_IMPL bool df_ge(df_frac a, df_frac b) {
+    DF_STAT(DF_STAT_GE);
+    return df_cmp(a, b) >= 0;
+}
+
+// Test if zero
+DF_IMPL bool df_is_zero(df_frac f) {
+    DF_ASSERT(f && "df_is_zero: operand cannot be NULL");
+    DF_STAT(DF_STAT_IS_ZERO);
+    return di_is_zero(f->numerator);
+}
+
+// Test if one
+DF_IMPL bool df_is_one(df_frac f) {
+    DF_ASSERT(f && "df_is_one: operand cannot be NULL");
+    DF_STAT(DF_STAT_IS_ONE);
+    return di_eq(f->numerator, f->denominator);
+}
+
+// Test if negative
+DF_IMPL bool df_is_negative(df_frac f) {
+    DF_ASSERT(f && "df_is_negative: operand cannot be NULL");
+    DF_STAT(DF_STAT_IS_NEGATIVE);
+    return di_is_negative(f->numerator);
+}
+
+// Test if positive
+DF_IMPL bool df_is_positive(df_frac f) {
+    DF_ASSERT(f && "df_is_positive: operand cannot be NULL");
+    DF_STAT(DF_STAT_IS_POSITIVE);
+    return !di_is_negative(f->numerator) && !di_is_zero(f->numerator);
+}
+
+// Test if integer
+DF_IMPL bool df_is_integer(df_frac f) {
+    DF_ASSERT(f && "df_is_integer: operand cannot be NULL");
+    DF_STAT(DF_STAT_IS_INTEGER);
+    return di_is_one(f->denominator);
+}
+
+// Convert to double
+DF_IMPL double df_to_double(df_frac f) {
+    DF_ASSERT(f && "df_to_double: operand cannot be NULL");
+    DF_STAT(DF_STAT_TO_DOUBLE);
+
+    if (f->is_dyadic) return df_dyadic_to_double(f);
+    df_approx(f);
+    return f->approx;
+}
+
+// Convert to int64 if possible
+DF_IMPL bool df_to_int64(df_frac f, int64_t* result) {
+    DF_ASSERT(f && "df_to_int64: fraction cannot be NULL");
+    DF_ASSERT(result && "df_to_int64: result pointer cannot be NULL");
+    DF_STAT(DF_STAT_TO_INT64);
+    if (!df_is_integer(f)) return false;
+
+    return di_to_int64(f->numerator, result);
+}
+
+// Convert to string
+DF_IMPL char* df_to_string(df_frac f) {
+    DF_ASSERT(f && "df_to_string: operand cannot be NULL");
+    DF_STAT(DF_STAT_TO_STRING);
+
+    char* num_str = di_to_string(f->numerator, 10);
+    DF_ASSERT(num_str && "df_to_string: numerator string conversion failed");
+
+    // If integer, just return the numerator string
+    if (df_is_integer(f)) {
+        return num_str;
+    }
+
+    char* den_str = di_to_string(f->denominator, 10);
+    if (!den_str) {
+        free(num_str);
+        return NULL;
+    }
+
+    // Allocate space for "num/den"
+    size_t len = strlen(num_str) + strlen(den_str) + 2;
+    char* result = (char*)DF_MALLOC(len);
+    DF_ASSERT(result && "df_to_string: result allocation failed");
+
+    snprintf(result, len, "%s/%s", num_str, den_str);
+
+    free(num_str);
+    free(den_str);
+
+    return result;
+}
+
+// Parse from string
+DF_IMPL df_frac df_from_string(const char* str) {
+    DF_ASSERT(str && "df_from_string: string cannot be NULL");
+    DF_STAT(DF_STAT_FROM_STRING);
+
+    // Look for '/' separator
+    const char* slash = strchr(str, '/');
+
+    if (!slash) {
+        // No slash, parse as integer
+        di_int num = di_from_string(str, 10);
+        DF_ASSERT(num && "df_from_string: numerator parsing failed");
+
+        di_int den = di_one();
+        df_frac result = df_from_di(num, den);
+
+        di_release(&num);
+        di_release(&den);
+
+        return result;
+    }
+
+    // Parse numerator and denominator
+    size_t num_len = slash - str;
+    char* num_str = (char*)DF_MALLOC(num_len + 1);
+    DF_ASSERT(num_str && "df_from_string: numerator string allocation failed");
+
+    strncpy(num_str, str, num_len);
+    num_str[num_len] = '\0';
+
+    di_int num = di_from_string(num_str, 10);
+    DF_FREE(num_str);
+
+    DF_ASSERT(num && "df_from_string: numerator parsing failed");
+
+    di_int den = di_from_string(slash + 1, 10);
+    DF_ASSERT(den && "df_from_string: denominator parsing failed");
+    DF_ASSERT(!di_is_zero(den) && "df_from_string: denominator cannot be zero");
+
+    df_frac result = df_from_di(num, den);
+
+    di_release(&num);
+    di_release(&den);
+
+    return result;
+}
+
+// Get numerator
+DF_IMPL di_int df_numerator(df_frac f) {
+    DF_ASSERT(f && "df_numerator: operand cannot be NULL");
+    DF_STAT(DF_STAT_NUMERATOR);
+    return di_retain(f->numerator);
+}
+
+// Get denominator
+DF_IMPL di_int df_denominator(df_frac f) {
+    DF_ASSERT(f && "df_denominator: operand cannot be NULL");
+    DF_STAT(DF_STAT_DENOMINATOR);
+    return di_retain(f->denominator);
+}
+
+// Create zero
+DF_IMPL df_frac df_zero(void) {
+    DF_STAT(DF_STAT_ZERO);
+    return df_from_ints(0, 1);
+}
+
+// Create one
+DF_IMPL df_frac df_one(void) {
+    DF_STAT(DF_STAT_ONE);
+    return df_from_ints(1, 1);
+}
+
+// Create negative one
+DF_IMPL df_frac df_neg_one(void) {
+    DF_STAT(DF_STAT_NEG_ONE);
+    return df_from_ints(-1, 1);
+}
+
+// ============================================================================
+// Extended Functions Implementation
+// ============================================================================
+
+// Power function
+DF_IMPL df_frac df_pow(df_frac base, int64_t exponent) {
+    DF_ASSERT(base && "df_pow: base cannot be NULL");
+    DF_STAT(DF_STAT_POW);
+
+    if (exponent == 0) {
+        return df_one();
+    }
+
+    if (exponent == 1) {
+        return df_copy(base);
+    }
+
+    if (df_is_zero(base)) {
+        DF_ASSERT(exponent > 0 && "df_pow: zero to negative power is undefined");
+        return df_zero();
+    }
+
+    // Handle negative exponents
+    if (exponent < 0) {
+        df_frac reciprocal = df_reciprocal(base);
+        df_frac result = df_pow(reciprocal, -exponent);
+        df_release(&reciprocal);
+        return result;
+    }
+
+    // Positive integer exponent - use exponentiation by squaring
+    df_frac result = df_one();
+    df_frac current_base = df_copy(base);
+
+    while (exponent > 0) {
+        if (exponent & 1) {  // If exponent is odd
+            df_frac new_result = df_mul(result, current_base);
+            df_release(&result);
+            result = new_result;
+        }
+        exponent >>= 1;
+        if (exponent > 0) {
+            df_frac new_base = df_mul(current_base, current_base);
+            df_release(&current_base);
+            current_base = new_base;
+        }
+    }
+
+    df_release(&current_base);
+    return result;
+}
+
+// Multiply by a power of two
+DF_IMPL df_frac df_ldexp(df_frac f, int64_t exp) {
+    DF_ASSERT(f && "df_ldexp: operand cannot be NULL");
+    DF_STAT(DF_STAT_LDEXP);
+
+    if (exp == 0 || di_is_zero(f->numerator)) return df_retain(f);
+
+    // Reduced input means only one side can hold factors of two, and
+    // cancelling those keeps the result reduced
+    bool up = exp > 0;
+    size_t bits = up ? (size_t)exp : (size_t)0 - (size_t)exp;
+    di_int shrink = up ? f->denominator : f->numerator;
+    di_int grow = up ? f->numerator : f->denominator;
+
+    size_t cancel = df_di_ctz(shrink);
+    if (cancel > bits) cancel = bits;
+
+    di_int shrunk = cancel ? di_shift_right(shrink, cancel) : di_retain(shrink);
+    di_int grown = bits > cancel ? di_shift_left(grow, bits - cancel) : di_retain(grow);
+
+    return up ? df_from_reduced(grown, shrunk) : df_from_reduced(shrunk, grown);
+}
+
+// Split into mantissa in [1/2, 1) and binary exponent
+DF_IMPL df_frac df_frexp(df_frac f, int64_t* exp) {
+    DF_ASSERT(f && "df_frexp: operand cannot be NULL");
+    DF_ASSERT(exp && "df_frexp: exponent pointer cannot be NULL");
+    DF_STAT(DF_STAT_FREXP);
+
+    if (di_is_zero(f->numerator)) {
+        *exp = 0;
+        return df_retain(f);
+    }
+
+    // 2^(e-1) <= |f| < 2^(e+1), so at most one correction step
+    int64_t e = (int64_t)di_bit_length(f->numerator) - (int64_t)di_bit_length(f->denominator);
+    df_frac m = df_ldexp(f, -e);
+
+    di_int mag = di_abs(m->numerator);
+    bool too_big = di_ge(mag, m->denominator);
+    di_release(&mag);
+    if (too_big) {
+        df_frac half = df_ldexp(m, -1);
+        df_release(&m);
+        m = half;
+        e++;
+    }
+
+    *exp = e;
+    return m;
+}
+
+// Floor function
+DF_IMPL df_frac df_floor(df_frac f) {
+    DF_ASSERT(f && "df_floor: operand cannot be NULL");
+    DF_STAT(DF_STAT_FLOOR);
+
+    if (df_is_integer(f)) {
+        return df_copy(f);
+    }
+
+    // di_div already performs floor division (rounds toward negative infinity)
+    di_int quotient = di_div(f->numerator, f->denominator);
+
+    di_int one = di_one();
+    df_frac result = df_from_di(quotient, one);
+    di_release(&quotient);
+    di_release(&one);
+    return result;
+}
+
+// Ceiling function
+DF_IMPL df_frac df_ceil(df_frac f) {
+    DF_ASSERT(f && "df_ceil: operand cannot be NULL");
+    DF_STAT(DF_STAT_CEIL);
+
+    if (df_is_integer(f)) {
+        return df_copy(f);
+    }
+
+    // Get integer part (floor)
+    di_int quotient = di_div(f->numerator, f->denominator);
+
+    // For non-integers, ceiling is always floor + 1
+    di_int one = di_one();
+    di_int adjusted = di_add(quotient, one);
+    di_release(&quotient);
+
+    df_frac result = df_from_di(adjusted, one);
+    di_release(&adjusted);
+    di_release(&one);
+    return result;
+}
+
+// Truncate function
+DF_IMPL df_frac df_trunc(df_frac f) {
+    DF_ASSERT(f && "df_trunc: operand cannot be NULL");
+    DF_STAT(DF_STAT_TRUNC);
+
+    if (df_is_integer(f)) {
+        return df_copy(f);
+    }
+
+    // Truncate toward zero - same as whole_part
+    di_int whole_int = df_whole_part(f);
+    di_int one = di_one();
+    df_frac result = df_from_di(whole_int, one);
+    di_release(&whole_int);
+    di_release(&one);
+    return result;
+}
+
+// Round function
+DF_IMPL df_frac df_round(df_frac f) {
+    DF_ASSERT(f && "df_round: operand cannot be NULL");
+    DF_STAT(DF_STAT_ROUND);
+
+    if (df_is_integer(f)) {
+        return df_copy(f);
+    }
+
+    // Round to nearest integer, ties to even (banker's rounding)
+    df_frac half = df_from_ints(1, 2);
+    df_frac abs_frac_part = df_abs(df_fractional_part(f));
+
+    // Check if fractional part is exactly 0.5
+    if (df_eq(abs_frac_part, half)) {
+        // Tie case - round to even
+        di_int whole_part = df_whole_part(f);
+        di_int one_den = di_one();
+        df_frac whole_frac = df_from_di(whole_part, one_den);
+        di_release(&whole_part);
+        di_release(&one_den);
+
+        // Check if whole part is even
+        di_int whole = df_whole_part(f);
+        int64_t whole_val;
+        di_to_int64(whole, &whole_val);
+
+        if (whole_val % 2 == 0) {
+            // Already even, return whole part
+            df_release(&half);
+            df_release(&abs_frac_part);
+            di_release(&whole);
+            return whole_frac;
+        } else {
+            // Odd, round to next even number
+            di_int one = di_one();
+            di_int adjusted_whole;
+
+            if (df_is_negative(f)) {
+                adjusted_whole = di_sub(whole, one);
+            } else {
+                adjusted_whole = di_add(whole, one);
+            }
+
+            di_int one_den = di_one();
+            df_frac result = df_from_di(adjusted_whole, one_den);
+            di_release(&one_den);
+
+            df_release(&half);
+            df_release(&abs_frac_part);
+            df_release(&whole_frac);
+            di_release(&whole);
+            di_release(&one);
+            di_release(&adjusted_whole);
+            return result;
+        }
+    } else {
+        // Normal rounding - not a tie
+        df_frac signed_half;
+        if (df_is_negative(f)) {
+            signed_half = df_negate(half);
+        } else {
+            signed_half = df_copy(half);
+        }
+
+        df_frac adjusted = df_add(f, signed_half);
+        df_frac result = df_trunc(adjusted);
+
+        df_release(&half);
+        df_release(&abs_frac_part);
+        df_release(&signed_half);
+        df_release(&adjusted);
+        return result;
+    }
+}
+
+// Sign function
+DF_IMPL int df_sign(df_frac f) {
+    DF_ASSERT(f && "df_sign: operand cannot be NULL");
+    DF_STAT(DF_STAT_SIGN);
+
+    if (df_is_zero(f)) return 0;
+    if (df_is_negative(f)) return -1;
+    return 1;
+}
+
+// Min function
+DF_IMPL df_frac df_min(df_frac a, df_frac b) {
+    DF_ASSERT(a && "df_min: first operand cannot be NULL");
+    DF_ASSERT(b && "df_min: second operand cannot be NULL");
+    DF_STAT(DF_STAT_MIN);
+
+    return df_lt(a, b) ? df_copy(a) : df_copy(b);
+}
+
+// Max function
+DF_IMPL df_frac df_max(df_frac a, df_frac b) {
+    DF_ASSERT(a && "df_max: first operand cannot be NULL");
+    DF_ASSERT(b && "df_max: second operand cannot be NULL");
+    DF_STAT(DF_STAT_MAX);
+
+    return df_gt(a, b) ? df_copy(a) : df_copy(b);
+}
+
+
+// Hash function
+// Helper: splitmix64 finalizer
+static inline uint64_t df_mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// Helper: Fold the sign and every limb of x into h. Limbs are packed into
+// 64-bit words, and the length is counted in words, so the result does not
+// depend on DI_LIMB_BITS.
+static uint64_t df_hash_di(di_int x, uint64_t h) {
+    size_t count;
+    const di_limb_t* limbs = di_limbs(x, &count);
+    while (count > 0 && limbs[count - 1] == 0) count--;
+
+    uint64_t words = ((uint64_t)count * DI_LIMB_BITS + 63) / 64;
+    h = df_mix64(h ^ words ^ ((uint64_t)di_is_negative(x) << 63));
+    uint64_t word = 0;
+    unsigned fill = 0;
+    for (size_t i = 0; i < count; i++) {
+        word |= (uint64_t)limbs[i] << fill;
+        fill += DI_LIMB_BITS;
+        if (fill == 64) {
+            h = df_mix64(h ^ word);
+            word = 0;
+            fill = 0;
+        }
+    }
+    return fill ? df_mix64(h ^ word) : h;
+}
+
+// Helper: Hash of the reduced fraction num/den, never zero
+static inline uint64_t df_hash_small(int64_t num, uint64_t den) {
+    uint64_t h = df_mix64((uint64_t)num ^ df_mix64(den));
+    return h ? h : 1;
+}
+
+// Helper: Structural hash of f, never zero. Stores the components in *num
+// and *den when both fit 64 bits, and sets *den to 0 otherwise.
+static uint64_t df_hash_parts(df_frac f, int64_t* num, uint64_t* den) {
+    if (di_to_int64(f->numerator, num) && di_to_uint64(f->denominator, den)) return df_hash_small(*num, *den);
+
+    *num = 0;
+    *den = 0;
+    uint64_t h = df_hash_di(f->denominator, df_hash_di(f->numerator, 0));
+    return h ? h : 1;
+}
+
+DF_IMPL uint64_t df_hash(df_frac f) {
+    DF_ASSERT(f && "df_hash: operand cannot be NULL");
+    DF_STAT(DF_STAT_HASH);
+
+    // Fractions are always reduced, so equal values hash their identical
+    // components
+    if (f->hash == 0) {
+        int64_t num;
+        uint64_t den;
+        f->hash = df_hash_parts(f, &num, &den);
+    }
+    return f->hash;
+}
+
+// Type checking functions
+DF_IMPL bool df_fits_int32(df_frac f) {
+    DF_ASSERT(f && "df_fits_int32: operand cannot be NULL");
+    DF_STAT(DF_STAT_FITS_INT32);
+
+    if (!df_is_integer(f)) return false;
+
+    int32_t dummy;
+    return di_to_int32(f->numerator, &dummy);
+}
+
+DF_IMPL bool df_fits_int64(df_frac f) {
+    DF_ASSERT(f && "df_fits_int64: operand cannot be NULL");
+    DF_STAT(DF_STAT_FITS_INT64);
+
+    if (!df_is_integer(f)) return false;
+
+    int64_t dummy;
+    return di_to_int64(f->numerator, &dummy);
+}
+
+DF_IMPL bool df_fits_double(df_frac f) {
+    DF_ASSERT(f && "df_fits_double: operand cannot be NULL");
+    DF_STAT(DF_STAT_FITS_DOUBLE);
+
+    // Convert to double and back, see if we get the same fraction
+    double d = df_to_double(f);
+    if (!isfinite(d)) return false;
+
+    df_frac converted = df_from_double(d, 1000000); // Reasonable precision
+    bool fits = df_eq(f, converted);
+    df_release(&converted);
+
+    return fits;
+}
+
+// Fraction parts
+DF_IMPL di_int df_whole_part(df_frac f) {
+    DF_ASSERT(f && "df_whole_part: operand cannot be NULL");
+    DF_STAT(DF_STAT_WHOLE_PART);
+
+    // For truncation toward zero, we need to handle negative numbers differently
+    // di_div floors toward negative infinity, but we want truncation toward zero
+    di_int quotient = di_div(f->numerator, f->denominator);
+
+    // If negative and not an exact division, add 1 to get truncation behavior
+    if (df_is_negative(f) && !df_is_integer(f)) {
+        di_int one = di_one();
+        di_int adjusted = di_add(quotient, one);
+        di_release(&quotient);
+        di_release(&one);
+        return adjusted;
+    }
+
+    return quotient;
+}
+
+DF_IMPL df_frac df_fractional_part(df_frac f) {
+    DF_ASSERT(f && "df_fractional_part: operand cannot be NULL");
+    DF_STAT(DF_STAT_FRACTIONAL_PART);
+
+    if (df_is_integer(f)) {
+        return df_zero();
+    }
+
+    // fractional_part = f - whole_part(f)
+    // This preserves the sign: -2.333... - (-2) = -0.333...
+    di_int whole_int = df_whole_part(f);
+    di_int one = di_one();
+    df_frac whole = df_from_di(whole_int, one);
+    di_release(&whole_int);
+    di_release(&one);
+
+    df_frac result = df_sub(f, whole);
+    df_release(&whole);
+
+    return result;
+}
+
+// ============================================================================
+// Series Summation Implementation
+// ============================================================================
+
+// Term source shared by the binary-splitting engine (either callback flavour)
+struct df_series_terms {
+    df_term_fn p;
+    df_term_fn q;
+    df_term_i64_fn p64;
+    df_term_i64_fn q64;
+    void* ctx;
+};
+
+// Partial result of the splitting engines. Ranges of int64_t terms stay in
+// machine integers until a product or sum would overflow.
+struct df_series_part {
+    bool small;       // p, q and t are valid instead of P, Q and T
+    int64_t p, q, t;
+    di_int P, Q, T;
+};
+
+// Helper: *r = a * b, false on int64_t overflow
+static bool df_series_mul64(int64_t a, int64_t b, int64_t* r) {
+#if defined(__GNUC__) || defined(__clang__)
+    return !__builtin_mul_overflow(a, b, r);
+#else
+    if (a == 0 || b == 0) {
+        *r = 0;
+        return true;
+    }
+    if ((a == -1 && b == INT64_MIN) || (b == -1 && a == INT64_MIN)) return false;
+    if (a > 0 ? (b > 0 ? a > INT64_MAX / b : b < INT64_MIN / a) : (b > 0 ? a < INT64_MIN / b : a < INT64_MAX / b)) {
+        return false;
+    }
+    *r = a * b;
+    return true;
+#endif
+}
+
+// Helper: *r = a * b + c * d, false on int64_t overflow
+static bool df_series_dot64(int64_t a, int64_t b, int64_t c, int64_t d, int64_t* r) {
+    int64_t x, y;
+    if (!df_series_mul64(a, b, &x) || !df_series_mul64(c, d, &y)) return false;
+#if defined(__GNUC__) || defined(__clang__)
+    return !__builtin_add_overflow(x, y, r);
+#else
+    if ((y > 0 && x > INT64_MAX - y) || (y < 0 && x < INT64_MIN - y)) return false;
+    *r = x + y;
+    return true;
+#endif
+}
+
+// Helper: Move a machine-integer part to di_int form (P only when with_p)
+static void df_series_promote(struct df_series_part* part, bool with_p) {
+    if (!part->small) return;
+    part->P = with_p ? di_from_int64(part->p) : NULL;
+    part->Q = di_from_int64(part->q);
+    part->T = di_from_int64(part->t);
+    part->small = false;
+}
+
+// Helper: Release the di_int form of a part
+static void df_series_part_release(struct df_series_part* part) {
+    if (part->small) return;
+    di_release(&part->P);
+    di_release(&part->Q);
+    di_release(&part->T);
+}
+
+// Helper: Evaluate both callbacks at k as a single-term part
+static struct df_series_part df_series_leaf(const struct df_series_terms* s, int64_t k) {
+    struct df_series_part part = {false, 0, 0, 0, NULL, NULL, NULL};
+    if (s->p64) {
+        part.small = true;
+        part.p = s->p64(k, s->ctx);
+        part.q = s->q64(k, s->ctx);
+        DF_ASSERT(part.q != 0 && "df_series: denominator callback returned zero");
+    } else {
+        part.P = s->p(k, s->ctx);
+        part.Q = s->q(k, s->ctx);
+        DF_ASSERT(part.P && "df_series: numerator callback returned NULL");
+        DF_ASSERT(part.Q && !di_is_zero(part.Q) && "df_series: denominator callback returned zero");
+    }
+    part.t = part.p;
+    part.T = part.P ? di_retain(part.P) : NULL;
+    return part;
+}
+
+// Helper: Binary splitting for the sum of p(k)/q(k) over [a, b) as T/Q
+static struct df_series_part df_series_split_sum(const struct df_series_terms* s, int64_t a, int64_t b) {
+    if (b - a == 1) return df_series_leaf(s, a);
+
+    int64_t m = a + (b - a) / 2;
+    struct df_series_part l = df_series_split_sum(s, a, m);
+    struct df_series_part r = df_series_split_sum(s, m, b);
+
+    // T = T1*Q2 + T2*Q1, Q = Q1*Q2
+    struct df_series_part out = {true, 0, 0, 0, NULL, NULL, NULL};
+    if (l.small && r.small && df_series_dot64(l.t, r.q, r.t, l.q, &out.t) && df_series_mul64(l.q, r.q, &out.q)) {
+        return out;
+    }
+
+    df_series_promote(&l, false);
+    df_series_promote(&r, false);
+    di_int x = di_mul(l.T, r.Q);
+    di_int y = di_mul(r.T, l.Q);
+    out.small = false;
+    out.T = di_add(x, y);
+    out.Q = di_mul(l.Q, r.Q);
+
+    di_release(&x);
+    di_release(&y);
+    df_series_part_release(&l);
+    df_series_part_release(&r);
+    return out;
+}
+
+// Helper: Binary splitting for the term-ratio series over [a, b) as P, Q, T
+// P is only produced when need_p is set (the rightmost spine never needs it)
+static struct df_series_part df_series_split_hyper(const struct df_series_terms* s, int64_t a, int64_t b,
+                                                   bool need_p) {
+    if (b - a == 1) return df_series_leaf(s, a);
+
+    int64_t m = a + (b - a) / 2;
+    struct df_series_part l = df_series_split_hyper(s, a, m, true);
+    struct df_series_part r = df_series_split_hyper(s, m, b, need_p);
+
+    // T = T1*Q2 + P1*T2, Q = Q1*Q2, P = P1*P2
+    struct df_series_part out = {true, 0, 0, 0, NULL, NULL, NULL};
+    if (l.small && r.small && df_series_dot64(l.t, r.q, l.p, r.t, &out.t) && df_series_mul64(l.q, r.q, &out.q) &&
+        (!need_p || df_series_mul64(l.p, r.p, &out.p))) {
+        return out;
+    }
+
+    df_series_promote(&l, true);
+    df_series_promote(&r, need_p);
+    di_int x = di_mul(l.T, r.Q);
+    di_int y = di_mul(l.P, r.T);
+    out.small = false;
+    out.T = di_add(x, y);
+    out.Q = di_mul(l.Q, r.Q);
+    if (need_p) {
+        out.P = di_mul(l.P, r.P);
+    }
+
+    di_release(&x);
+    di_release(&y);
+    df_series_part_release(&l);
+    df_series_part_release(&r);
+    return out;
+}
+
+// Helper: Reduce a finished part to the result
+static df_frac df_series_finish(struct df_series_part* part) {
+    if (part->small) return df_from_ints(part->t, part->q);
+    df_frac result = df_from_di(part->T, part->Q);
+    df_series_part_release(part);
+    return result;
+}
+
+// Helper: Run the sum engine and perform the single final reduction
+static df_frac df_series_eval_sum(const struct df_series_terms* s, int64_t a, int64_t b) {
+    if (a >= b) return df_zero();
+    struct df_series_part part = df_series_split_sum(s, a, b);
+    return df_series_finish(&part);
+}
+
+// Helper: Run the ratio engine and perform the single final reduction
+static df_frac df_series_eval_hyper(const struct df_series_terms* s, int64_t a, int64_t b) {
+    if (a >= b) return df_zero();
+    struct df_series_part part = df_series_split_hyper(s, a, b, false);
+    return df_series_finish(&part);
+}
+
+// Sum of p(k)/q(k) with di_int callbacks
+DF_IMPL df_frac df_series_sum(int64_t a, int64_t b, df_term_fn p, df_term_fn q, void* ctx) {
+    DF_ASSERT(p && q && "df_series_sum: callbacks cannot be NULL");
+    DF_STAT(DF_STAT_SERIES_SUM);
+    struct df_series_terms s = {p, q, NULL, NULL, ctx};
+    return df_series_eval_sum(&s, a, b);
+}
+
+// Sum of p(k)/q(k) with int64_t callbacks
+DF_IMPL df_frac df_series_sum_i64(int64_t a, int64_t b, df_term_i64_fn p, df_term_i64_fn q, void* ctx) {
+    DF_ASSERT(p && q && "df_series_sum_i64: callbacks cannot be NULL");
+    DF_STAT(DF_STAT_SERIES_SUM_I64);
+    struct df_series_terms s = {NULL, NULL, p, q, ctx};
+    return df_series_eval_sum(&s, a, b);
+}
+
+// Term-ratio series with di_int callbacks
+DF_IMPL df_frac df_series_hypergeometric(int64_t a, int64_t b, df_term_fn p, df_term_fn q, void* ctx) {
+    DF_ASSERT(p && q && "df_series_hypergeometric: callbacks cannot be NULL");
+    DF_STAT(DF_STAT_SERIES_HYPERGEOMETRIC);
+    struct df_series_terms s = {p, q, NULL, NULL, ctx};
+    return df_series_eval_hyper(&s, a, b);
+}
+
+// Term-ratio series with int64_t callbacks
+DF_IMPL df_frac df_series_hypergeometric_i64(int64_t a, int64_t b, df_term_i64_fn p, df_term_i64_fn q,
+                                             void* ctx) {
+    DF_ASSERT(p && q && "df_series_hypergeometric_i64: callbacks cannot be NULL");
+    DF_STAT(DF_STAT_SERIES_HYPERGEOMETRIC_I64);
+    struct df_series_terms s = {NULL, NULL, p, q, ctx};
+    return df_series_eval_hyper(&s, a, b);
+}
+
+// Helper: Constant one term
+static int64_t df_series_one(int64_t k, void* ctx) {
+    (void)k;
+    (void)ctx;
+    return 1;
+}
+
+// Helper: Identity term
+static int64_t df_series_index(int64_t k, void* ctx) {
+    (void)ctx;
+    return k;
+}
+
+// Harmonic number
+DF_IMPL df_frac df_harmonic(int64_t n) {
+    DF_STAT(DF_STAT_HARMONIC);
+    if (n <= 0) return df_zero();
+    return df_series_sum_i64(1, n + 1, df_series_one, df_series_index, NULL);
+}
+
+// Helper: Bernoulli numerator term, read from the precomputed coefficient table
+static di_int df_bernoulli_p(int64_t k, void* ctx) {
+    di_int* coeffs = (di_int*)ctx;
+    return di_retain(coeffs[k]);
+}
+
+// Helper: Bernoulli denominator term k + 1
+static di_int df_bernoulli_q(int64_t k, void* ctx) {
+    (void)ctx;
+    return di_from_int64(k + 1);
+}
+
+// Bernoulli number via B(n) = sum_{k=0}^{n} (-1)^k k! S(n,k) / (k+1)
+DF_IMPL df_frac df_bernoulli(uint32_t n) {
+    DF_STAT(DF_STAT_BERNOULLI);
+    if (n == 0) return df_one();
+    if (n == 1) return df_from_ints(-1, 2);
+    if (n & 1) return df_zero();
+    DF_ASSERT(n <= INT32_MAX && "df_bernoulli: index too large");
+
+    // Row n of the Stirling numbers of the second kind, built in place
+    di_int* coeffs = (di_int*)DF_MALLOC(sizeof(di_int) * ((size_t)n + 1));
+    DF_ASSERT(coeffs && "df_bernoulli: allocation failed");
+    coeffs[0] = di_one();
+    for (uint32_t k = 1; k <= n; k++) {
+        coeffs[k] = di_zero();
+    }
+    for (uint32_t m = 1; m <= n; m++) {
+        for (uint32_t k = m; k >= 1; k--) {
+            di_int scaled = di_mul_i32(coeffs[k], (int32_t)k);
+            di_int next = di_add(scaled, coeffs[k - 1]);
+            di_release(&scaled);
+            di_release(&coeffs[k]);
+            coeffs[k] = next;
+        }
+        di_release(&coeffs[0]);
+        coeffs[0] = di_zero();
+    }
+
+    // Scale S(n,k) by (-1)^k k!
+    di_int factorial = di_one();
+    for (uint32_t k = 1; k <= n; k++) {
+        di_int next = di_mul_i32(factorial, (int32_t)k);
+        di_release(&factorial);
+        factorial = next;
+
+        di_int scaled = di_mul(coeffs[k], factorial);
+        di_release(&coeffs[k]);
+        if (k & 1) {
+            coeffs[k] = di_negate(scaled);
+            di_release(&scaled);
+        } else {
+            coeffs[k] = scaled;
+        }
+    }
+    di_release(&factorial);
+
+    df_frac result = df_series_sum(0, (int64_t)n + 1, df_bernoulli_p, df_bernoulli_q, coeffs);
+
+    for (uint32_t k = 0; k <= n; k++) {
+        di_release(&coeffs[k]);
+    }
+    DF_FREE(coeffs);
+    return result;
+}
+
+// ============================================================================
+// Continued Fractions Implementation
+// ============================================================================
+
+// Helper: Move the remainder pair to int64_t form once both halves fit
+static void df_cf_try_shrink(df_cf_iter* it) {
+    int64_t n, d;
+    if (it->num && di_to_int64(it->num, &n) && di_to_int64(it->den, &d)) {
+        di_release(&it->num);
+        di_release(&it->den);
+        it->small_num = n;
+        it->small_den = d;
+    }
+}
+
+// Helper: One Euclidean step; the quotient lands in *small_q or *big_q
+// Returns true if the quotient is in big form
+static bool df_cf_advance(df_cf_iter* it, int64_t* small_q, di_int* big_q) {
+    if (!it->num) {
+        int64_t n = it->small_num, d = it->small_den;
+        int64_t q = n / d, r = n % d;
+        if (r < 0) {
+            q--;
+            r += d;
+        }
+        it->small_num = d;
+        it->small_den = r;
+        it->done = (r == 0);
+        *small_q = q;
+        return false;
+    }
+
+    // Floor quotient, remainder r = n - q*d in [0, d)
+    di_int q = di_div(it->num, it->den);
+    di_int prod = di_mul(q, it->den);
+    di_int r = di_sub(it->num, prod);
+    di_release(&prod);
+    di_release(&it->num);
+    it->num = it->den;
+    it->den = r;
+    it->done = di_is_zero(r);
+    df_cf_try_shrink(it);
+
+    int64_t qs;
+    if (di_to_int64(q, &qs)) {
+        di_release(&q);
+        *small_q = qs;
+        return false;
+    }
+    *big_q = q;
+    return true;
+}
+
+// Helper: Move the convergent state to di_int form
+static void df_cf_promote(df_cf_iter* it) {
+    if (it->h[0]) return;
+    for (int i = 0; i < 2; i++) {
+        it->h[i] = di_from_int64(it->small_h[i]);
+        it->k[i] = di_from_int64(it->small_k[i]);
+    }
+}
+
+// Helper: Advance h(n) = a*h(n-1) + h(n-2) in big form
+static di_int df_cf_recur_big(di_int a, di_int prev, di_int prev2) {
+    di_int prod = di_mul(a, prev);
+    di_int result = di_add(prod, prev2);
+    di_release(&prod);
+    return result;
+}
+
+// Expand into an array of partial quotients
+DF_IMPL size_t df_to_cf(df_frac f, di_int* terms_out, size_t max) {
+    DF_ASSERT(f && "df_to_cf: fraction cannot be NULL");
+    DF_ASSERT((terms_out || max == 0) && "df_to_cf: output array cannot be NULL");
+    DF_STAT(DF_STAT_TO_CF);
+
+    df_cf_iter it;
+    df_cf_iter_init(&it, f);
+
+    size_t count = 0;
+    while (count < max && !it.done) {
+        int64_t small_q;
+        di_int big_q;
+        terms_out[count++] = df_cf_advance(&it, &small_q, &big_q) ? big_q : di_from_int64(small_q);
+    }
+
+    df_cf_iter_free(&it);
+    return count;
+}
+
+// Helper: Product of the term matrices [[a,1],[1,0]] over [lo, hi)
+// m receives {m00, m01, m10, m11}
+static void df_cf_matrix_product(const di_int* terms, size_t lo, size_t hi, di_int m[4]) {
+    if (hi - lo == 1) {
+        m[0] = di_retain(terms[lo]);
+        m[1] = di_one();
+        m[2] = di_one();
+        m[3] = di_zero();
+        return;
+    }
+
+    size_t mid = lo + (hi - lo) / 2;
+    di_int l[4], r[4];
+    df_cf_matrix_product(terms, lo, mid, l);
+    df_cf_matrix_product(terms, mid, hi, r);
+
+    for (int row = 0; row < 2; row++) {
+        for (int col = 0; col < 2; col++) {
+            di_int x = di_mul(l[row * 2], r[col]);
+            di_int y = di_mul(l[row * 2 + 1], r[2 + col]);
+            m[row * 2 + col] = di_add(x, y);
+            di_release(&x);
+            di_release(&y);
+        }
+    }
+
+    for (int i = 0; i < 4; i++) {
+        di_release(&l[i]);
+        di_release(&r[i]);
+    }
+}
+
+// Rebuild from partial quotients
+DF_IMPL df_frac df_from_cf(const di_int* terms, size_t n) {
+    DF_ASSERT(terms && n > 0 && "df_from_cf: at least one term required");
+    DF_STAT(DF_STAT_FROM_CF);
+
+    di_int m[4];
+    df_cf_matrix_product(terms, 0, n, m);
+    di_release(&m[1]);
+    di_release(&m[3]);
+    DF_ASSERT(!di_is_zero(m[2]) && "df_from_cf: terms produce a zero denominator");
+
+    // The product has determinant +-1, so m00/m10 is already in lowest terms
+    if (di_is_negative(m[2])) {
+        di_int num = di_negate(m[0]);
+        di_int den = di_negate(m[2]);
+        di_release(&m[0]);
+        di_release(&m[2]);
+        return df_from_reduced(num, den);
+    }
+    return df_from_reduced(m[0], m[2]);
+}
+
+// Start iteration
+DF_IMPL void df_cf_iter_init(df_cf_iter* it, df_frac f) {
+    DF_ASSERT(it && "df_cf_iter_init: iterator cannot be NULL");
+    DF_ASSERT(f && "df_cf_iter_init: fraction cannot be NULL");
+    DF_STAT(DF_STAT_CF_ITER_INIT);
+
+    it->num = di_retain(f->numerator);
+    it->den = di_retain(f->denominator);
+    it->small_num = 0;
+    it->small_den = 1;
+    df_cf_try_shrink(it);
+
+    it->h[0] = it->h[1] = NULL;
+    it->k[0] = it->k[1] = NULL;
+    it->small_h[0] = 0;
+    it->small_h[1] = 1;
+    it->small_k[0] = 1;
+    it->small_k[1] = 0;
+    it->done = false;
+}
+
+// Next partial quotient and convergent
+DF_IMPL bool df_cf_iter_next(df_cf_iter* it, di_int* term, df_frac* convergent) {
+    DF_ASSERT(it && "df_cf_iter_next: iterator cannot be NULL");
+    DF_STAT(DF_STAT_CF_ITER_NEXT);
+    if (it->done) return false;
+
+    int64_t small_q = 0;
+    di_int big_q = NULL;
+    bool is_big = df_cf_advance(it, &small_q, &big_q);
+
+    // Convergent recurrences, in int64_t while nothing overflows
+    if (!it->h[0] && !is_big) {
+        int64_t hp, h, kp, k;
+        if (di_multiply_overflow_int64(small_q, it->small_h[1], &hp) &&
+            di_add_overflow_int64(hp, it->small_h[0], &h) &&
+            di_multiply_overflow_int64(small_q, it->small_k[1], &kp) &&
+            di_add_overflow_int64(kp, it->small_k[0], &k)) {
+            it->small_h[0] = it->small_h[1];
+            it->small_h[1] = h;
+            it->small_k[0] = it->small_k[1];
+            it->small_k[1] = k;
+        } else {
+            df_cf_promote(it);
+        }
+    } else {
+        df_cf_promote(it);
+    }
+
+    if (it->h[0]) {
+        di_int a = is_big ? di_retain(big_q) : di_from_int64(small_q);
+        di_int h = df_cf_recur_big(a, it->h[1], it->h[0]);
+        di_int k = df_cf_recur_big(a, it->k[1], it->k[0]);
+        di_release(&a);
+        di_release(&it->h[0]);
+        di_release(&it->k[0]);
+        it->h[0] = it->h[1];
+        it->h[1] = h;
+        it->k[0] = it->k[1];
+        it->k[1] = k;
+    }
+
+    if (term) {
+        *term = is_big ? di_retain(big_q) : di_from_int64(small_q);
+    }
+    if (convergent) {
+        // Consecutive convergents are coprime with positive denominators
+        if (it->h[0]) {
+            *convergent = df_from_reduced(di_retain(it->h[1]), di_retain(it->k[1]));
+        } else {
+            *convergent = df_from_reduced(di_from_int64(it->small_h[1]), di_from_int64(it->small_k[1]));
+        }
+    }
+
+    di_release(&big_q);
+    return true;
+}
+
+// Release iterator state
+DF_IMPL void df_cf_iter_free(df_cf_iter* it) {
+    DF_STAT(DF_STAT_CF_ITER_FREE);
+    if (!it) return;
+    di_release(&it->num);
+    di_release(&it->den);
+    for (int i = 0; i < 2; i++) {
+        di_release(&it->h[i]);
+        di_release(&it->k[i]);
+    }
+    it->done = true;
+}
+
+// ============================================================================
+// Decimal Implementation
+// ============================================================================
+
+// Powers of ten that fit in int64_t
+static const int64_t df_pow10_table[19] = {1LL,
+                                           10LL,
+                                           100LL,
+                                           1000LL,
+                                           10000LL,
+                                           100000LL,
+                                           1000000LL,
+                                           10000000LL,
+                                           100000000LL,
+                                           1000000000LL,
+                                           10000000000LL,
+                                           100000000000LL,
+                                           1000000000000LL,
+                                           10000000000000LL,
+                                           100000000000000LL,
+                                           1000000000000000LL,
+                                           10000000000000000LL,
+                                           100000000000000000LL,
+                                           1000000000000000000LL};
+
+// Helper: 10^k as di_int
+static di_int df_pow10_di(uint32_t k) {
+    di_int result = di_one();
+    while (k > 0) {
+        uint32_t step = k > 9 ? 9 : k;
+        di_int next = di_mul_i32(result, (int32_t)df_pow10_table[step]);
+        di_release(&result);
+        result = next;
+        k -= step;
+    }
+    return result;
+}
+
+// Helper: Allocate a decimal structure
+static df_decimal df_decimal_alloc(void) {
+    df_decimal d = (df_decimal)DF_MALLOC(sizeof(struct df_decimal_internal));
+    DF_ASSERT(d && "df_decimal_alloc: memory allocation failed");
+    d->coeff = 0;
+    d->big = NULL;
+    d->scale = 0;
+    d->ref_count = 1;
+    return d;
+}
+
+// Helper: Build a normalized decimal from an int64_t coefficient
+static df_decimal df_decimal_make_small(int64_t coeff, int32_t scale) {
+    while (scale > 0 && coeff % 10 == 0) {
+        coeff /= 10;
+        scale--;
+    }
+    df_decimal d = df_decimal_alloc();
+    d->coeff = coeff;
+    d->scale = scale;
+    return d;
+}
+
+// Helper: Build a normalized decimal from a di_int coefficient, taking ownership
+static df_decimal df_decimal_make_big(di_int coeff, int32_t scale) {
+    DF_ASSERT(coeff && "df_decimal_make_big: coefficient cannot be NULL");
+
+    int64_t small;
+    if (di_to_int64(coeff, &small)) {
+        di_release(&coeff);
+        return df_decimal_make_small(small, scale);
+    }
+
+    if (scale > 0) {
+        di_int ten = di_from_int32(10);
+        while (scale > 0) {
+            di_int rem = di_mod(coeff, ten);
+            bool divisible = di_is_zero(rem);
+            di_release(&rem);
+            if (!divisible) break;
+
+            di_int q = di_div(coeff, ten);
+            di_release(&coeff);
+            coeff = q;
+            scale--;
+        }
+        di_release(&ten);
+
+        if (di_to_int64(coeff, &small)) {
+            di_release(&coeff);
+            return df_decimal_make_small(small, scale);
+        }
+    }
+
+    df_decimal d = df_decimal_alloc();
+    d->big = coeff;
+    d->scale = scale;
+    return d;
+}
+
+// Helper: Coefficient as a new di_int
+static di_int df_decimal_coeff_di(df_decimal d) {
+    return d->big ? di_retain(d->big) : di_from_int64(d->coeff);
+}
+
+// Helper: Coefficient rescaled to a larger scale, as a new di_int
+static di_int df_decimal_aligned_di(df_decimal d, int32_t scale) {
+    di_int coeff = df_decimal_coeff_di(d);
+    if (scale == d->scale) return coeff;
+
+    di_int factor = df_pow10_di((uint32_t)(scale - d->scale));
+    di_int result = di_mul(coeff, factor);
+    di_release(&coeff);
+    di_release(&factor);
+    return result;
+}
+
+// Helper: Rescale an int64_t coefficient by 10^k, failing on overflow
+static bool df_decimal_scale_small(int64_t coeff, int32_t k, int64_t* result) {
+    if (coeff == 0) {
+        *result = 0;
+        return true;
+    }
+    if (k > 18) return false;
+    return di_multiply_overflow_int64(coeff, df_pow10_table[k], result);
+}
+
+// Helper: a + b or a - b
+static df_decimal df_decimal_add_sub(df_decimal a, df_decimal b, bool subtract) {
+    int32_t scale = a->scale > b->scale ? a->scale : b->scale;
+
+    if (!a->big && !b->big) {
+        int64_t ca, cb, r;
+        if (df_decimal_scale_small(a->coeff, scale - a->scale, &ca) &&
+            df_decimal_scale_small(b->coeff, scale - b->scale, &cb) &&
+            (subtract ? di_subtract_overflow_int64(ca, cb, &r) : di_add_overflow_int64(ca, cb, &r))) {
+            return df_decimal_make_small(r, scale);
+        }
+    }
+
+    di_int ca = df_decimal_aligned_di(a, scale);
+    di_int cb = df_decimal_aligned_di(b, scale);
+    di_int r = subtract ? di_sub(ca, cb) : di_add(ca, cb);
+    di_release(&ca);
+    di_release(&cb);
+    return df_decimal_make_big(r, scale);
+}
+
+// Create from coefficient and scale
+DF_IMPL df_decimal df_decimal_from_int(int64_t coeff, int32_t scale) {
+    DF_ASSERT(scale >= 0 && "df_decimal_from_int: scale cannot be negative");
+    DF_STAT(DF_STAT_DECIMAL_FROM_INT);
+    return df_decimal_make_small(coeff, scale);
+}
+
+// Parse from string
+DF_IMPL df_decimal df_decimal_from_string(const char* str) {
+    DF_ASSERT(str && "df_decimal_from_string: string cannot be NULL");
+    DF_STAT(DF_STAT_DECIMAL_FROM_STRING);
+
+    const char* p = str;
+    bool negative = false;
+    if (*p == '+' || *p == '-') {
+        negative = (*p == '-');
+        p++;
+    }
+
+    // Collect the digits (with sign) without the decimal point
+    size_t len = strlen(p);
+    char* digits = (char*)DF_MALLOC(len + 2);
+    DF_ASSERT(digits && "df_decimal_from_string: allocation failed");
+
+    size_t count = 0, frac_digits = 0;
+    bool seen_point = false;
+    digits[count++] = negative ? '-' : '+';
+    for (; *p; p++) {
+        if (*p >= '0' && *p <= '9') {
+            digits[count++] = *p;
+            if (seen_point) frac_digits++;
+        } else if (*p == '.' && !seen_point) {
+            seen_point = true;
+        } else {
+            DF_FREE(digits);
+            return NULL;
+        }
+    }
+    digits[count] = '\0';
+
+    if (count == 1) {
+        DF_FREE(digits);
+        return NULL;
+    }
+    DF_ASSERT(frac_digits <= INT32_MAX && "df_decimal_from_string: too many decimal places");
+
+    df_decimal result;
+    if (count - 1 <= 18) {
+        int64_t coeff = 0;
+        for (size_t i = 1; i < count; i++) {
+            coeff = coeff * 10 + (digits[i] - '0');
+        }
+        result = df_decimal_make_small(negative ? -coeff : coeff, (int32_t)frac_digits);
+    } else {
+        di_int coeff = di_from_string(negative ? digits : digits + 1, 10);
+        DF_ASSERT(coeff && "df_decimal_from_string: coefficient parsing failed");
+        result = df_decimal_make_big(coeff, (int32_t)frac_digits);
+    }
+
+    DF_FREE(digits);
+    return result;
+}
+
+// Convert from fraction (denominator must be of the form 2^a * 5^b)
+DF_IMPL df_decimal df_decimal_from_frac(df_frac f) {
+    DF_ASSERT(f && "df_decimal_from_frac: fraction cannot be NULL");
+    DF_STAT(DF_STAT_DECIMAL_FROM_FRAC);
+
+    uint32_t twos = 0, fives = 0;
+    uint64_t den;
+    if (di_to_uint64(f->denominator, &den)) {
+        while ((den & 1) == 0) {
+            den >>= 1;
+            twos++;
+        }
+        while (den % 5 == 0) {
+            den /= 5;
+            fives++;
+        }
+        if (den != 1) return NULL;
+    } else {
+        di_int rest = di_retain(f->denominator);
+        di_int two = di_from_int32(2);
+        di_int five = di_from_int32(5);
+        for (int pass = 0; pass < 2; pass++) {
+            di_int divisor = pass == 0 ? two : five;
+            for (;;) {
+                di_int rem = di_mod(rest, divisor);
+                bool divisible = di_is_zero(rem);
+                di_release(&rem);
+                if (!divisible) break;
+
+                di_int q = di_div(rest, divisor);
+                di_release(&rest);
+                rest = q;
+                if (pass == 0) {
+                    twos++;
+                } else {
+                    fives++;
+                }
+            }
+        }
+        bool terminating = di_is_one(rest);
+        di_release(&rest);
+        di_release(&two);
+        di_release(&five);
+        if (!terminating) return NULL;
+    }
+
+    // numerator * 2^(k - twos) * 5^(k - fives) over 10^k
+    uint32_t scale = twos > fives ? twos : fives;
+    DF_ASSERT(scale <= INT32_MAX && "df_decimal_from_frac: scale too large");
+    di_int coeff = di_retain(f->numerator);
+    for (uint32_t i = twos; i < scale; i++) {
+        di_int next = di_mul_i32(coeff, 2);
+        di_release(&coeff);
+        coeff = next;
+    }
+    for (uint32_t i = fives; i < scale; i++) {
+        di_int next = di_mul_i32(coeff, 5);
+        di_release(&coeff);
+        coeff = next;
+    }
+    return df_decimal_make_big(coeff, (int32_t)scale);
+}
+
+// Convert to fraction
+DF_IMPL df_frac df_decimal_to_frac(df_decimal d) {
+    DF_ASSERT(d && "df_decimal_to_frac: decimal cannot be NULL");
+    DF_STAT(DF_STAT_DECIMAL_TO_FRAC);
+
+    di_int num = df_decimal_coeff_di(d);
+    di_int den = df_pow10_di((uint32_t)d->scale);
+    df_frac result = df_from_di(num, den);
+    di_release(&num);
+    di_release(&den);
+    return result;
+}
+
+// Convert to string
+DF_IMPL char* df_decimal_to_string(df_decimal d) {
+    DF_ASSERT(d && "df_decimal_to_string: decimal cannot be NULL");
+    DF_STAT(DF_STAT_DECIMAL_TO_STRING);
+
+    char small_buf[24];
+    char* coeff_str = NULL;
+    const char* digits;
+    if (d->big) {
+        coeff_str = di_to_string(d->big, 10);
+        DF_ASSERT(coeff_str && "df_decimal_to_string: coefficient conversion failed");
+        digits = coeff_str;
+    } else {
+        snprintf(small_buf, sizeof(small_buf), "%lld", (long long)d->coeff);
+        digits = small_buf;
+    }
+
+    bool negative = (digits[0] == '-');
+    if (negative) digits++;
+    size_t ndigits = strlen(digits);
+    size_t scale = (size_t)d->scale;
+
+    // sign + integer part (at least "0") + point + fraction + NUL
+    size_t int_digits = ndigits > scale ? ndigits - scale : 0;
+    size_t len = (negative ? 1 : 0) + (int_digits ? int_digits : 1) + (scale ? scale + 1 : 0) + 1;
+    char* result = (char*)DF_MALLOC(len);
+    DF_ASSERT(result && "df_decimal_to_string: result allocation failed");
+
+    char* out = result;
+    if (negative) *out++ = '-';
+    if (int_digits) {
+        memcpy(out, digits, int_digits);
+        out += int_digits;
+    } else {
+        *out++ = '0';
+    }
+    if (scale) {
+        *out++ = '.';
+        for (size_t i = ndigits; i < scale; i++) {
+            *out++ = '0';
+        }
+        size_t frac_len = ndigits < scale ? ndigits : scale;
+        memcpy(out, digits + ndigits - frac_len, frac_len);
+        out += frac_len;
+    }
+    *out = '\0';
+
+    if (coeff_str) free(coeff_str);
+    return result;
+}
+
+// Get coefficient
+DF_IMPL di_int df_decimal_coefficient(df_decimal d) {
+    DF_ASSERT(d && "df_decimal_coefficient: decimal cannot be NULL");
+    DF_STAT(DF_STAT_DECIMAL_COEFFICIENT);
+    return df_decimal_coeff_di(d);
+}
+
+// Get scale
+DF_IMPL int32_t df_decimal_scale(df_decimal d) {
+    DF_ASSERT(d && "df_decimal_scale: decimal cannot be NULL");
+    DF_STAT(DF_STAT_DECIMAL_SCALE);
+    return d->scale;
+}
+
+// Addition
+DF_IMPL df_decimal df_decimal_add(df_decimal a, df_decimal b) {
+    DF_ASSERT(a && "df_decimal_add: first operand cannot be NULL");
+    DF_ASSERT(b && "df_decimal_add: second operand cannot be NULL");
+    DF_STAT(DF_STAT_DECIMAL_ADD);
+    return df_decimal_add_sub(a, b, false);
+}
+
+// Subtraction
+DF_IMPL df_decimal df_decimal_sub(df_decimal a, df_decimal b) {
+    DF_ASSERT(a && "df_decimal_sub: first operand cannot be NULL");
+    DF_ASSERT(b && "df_decimal_sub: second operand cannot be NULL");
+    DF_STAT(DF_STAT_DECIMAL_SUB);
+    return df_decimal_add_sub(a, b, true);
+}
+
+// Multiplication: scales add, coefficients multiply
+DF_IMPL df_decimal df_decimal_mul(df_decimal a, df_decimal b) {
+    DF_ASSERT(a && "df_decimal_mul: first operand cannot be NULL");
+    DF_ASSERT(b && "df_decimal_mul: second operand cannot be NULL");
+    DF_ASSERT(a->scale <= INT32_MAX - b->scale && "df_decimal_mul: scale overflow");
+    DF_STAT(DF_STAT_DECIMAL_MUL);
+
+    int32_t scale = a->scale + b->scale;
+    int64_t r;
+    if (!a->big && !b->big && di_multiply_overflow_int64(a->coeff, b->coeff, &r)) {
+        return df_decimal_make_small(r, scale);
+    }
+
+    di_int ca = df_decimal_coeff_di(a);
+    di_int cb = df_decimal_coeff_di(b);
+    di_int prod = di_mul(ca, cb);
+    di_release(&ca);
+    di_release(&cb);
+    return df_decimal_make_big(prod, scale);
+}
+
+// Negation
+DF_IMPL df_decimal df_decimal_negate(df_decimal d) {
+    DF_ASSERT(d && "df_decimal_negate: operand cannot be NULL");
+    DF_STAT(DF_STAT_DECIMAL_NEGATE);
+
+    if (!d->big && d->coeff != INT64_MIN) {
+        return df_decimal_make_small(-d->coeff, d->scale);
+    }
+    di_int coeff = df_decimal_coeff_di(d);
+    di_int neg = di_negate(coeff);
+    di_release(&coeff);
+    return df_decimal_make_big(neg, d->scale);
+}
+
+// Comparison
+DF_IMPL int df_decimal_cmp(df_decimal a, df_decimal b) {
+    DF_ASSERT(a && "df_decimal_cmp: first operand cannot be NULL");
+    DF_ASSERT(b && "df_decimal_cmp: second operand cannot be NULL");
+    DF_STAT(DF_STAT_DECIMAL_CMP);
+
+    int32_t scale = a->scale > b->scale ? a->scale : b->scale;
+    int64_t ca, cb;
+    if (!a->big && !b->big && df_decimal_scale_small(a->coeff, scale - a->scale, &ca) &&
+        df_decimal_scale_small(b->coeff, scale - b->scale, &cb)) {
+        return (ca > cb) - (ca < cb);
+    }
+
+    di_int da = df_decimal_aligned_di(a, scale);
+    di_int db = df_decimal_aligned_di(b, scale);
+    int result = di_compare(da, db);
+    di_release(&da);
+    di_release(&db);
+    return result;
+}
+
+// Test if zero
+DF_IMPL bool df_decimal_is_zero(df_decimal d) {
+    DF_ASSERT(d && "df_decimal_is_zero: operand cannot be NULL");
+    DF_STAT(DF_STAT_DECIMAL_IS_ZERO);
+    return !d->big && d->coeff == 0;
+}
+
+// Retain (increase reference count)
+DF_IMPL df_decimal df_decimal_retain(df_decimal d) {
+    DF_ASSERT(d && "df_decimal_retain: decimal cannot be NULL");
+    DF_STAT(DF_STAT_DECIMAL_RETAIN);
+    d->ref_count++;
+    return d;
+}
+
+// Release (decrease reference count)
+DF_IMPL void df_decimal_release(df_decimal* d) {
+    DF_STAT(DF_STAT_DECIMAL_RELEASE);
+    if (!d || !*d) return;
+
+    (*d)->ref_count--;
+    if ((*d)->ref_count == 0) {
+        di_release(&(*d)->big);
+        DF_FREE(*d);
+    }
+    *d = NULL;
+}
+
+// ============================================================================
+// EXACT FLOATING-POINT ACCUMULATION IMPLEMENTATION
+// ============================================================================
+
+// The superaccumulator holds 32-bit digits in int64_t slots; slot i weighs
+// 2^(32*i + DF_ACC_BASE). The lowest product bit is 2^-2148 and the highest
+// is below 2^2048, plus carry headroom for 2^64 terms.
+#define DF_ACC_BASE (-2176)
+#define DF_ACC_SLOTS 136
+// Terms added between carry passes; each keeps every slot well below 2^63
+#define DF_ACC_BATCH ((size_t)1 << 20)
+
+typedef struct {
+    int64_t slot[DF_ACC_SLOTS];
+} df_superacc;
+
+// Helper: Split a finite double into sign, 53-bit mantissa and exponent
+static bool df_split_double(double x, uint64_t* mant, int* exp, bool* negative) {
+    uint64_t bits;
+    memcpy(&bits, &x, sizeof bits);
+
+    int biased = (int)((bits >> 52) & 0x7ff);
+    if (biased == 0x7ff) return false;
+
+    *negative = (bits >> 63) != 0;
+    *mant = bits & (((uint64_t)1 << 52) - 1);
+    if (biased == 0) {
+        *exp = -1074;
+    } else {
+        *mant |= (uint64_t)1 << 52;
+        *exp = biased - 1075;
+    }
+    return true;
+}
+
+// Helper: Add +/- v * 2^bit for a 32-bit v; bit is relative to DF_ACC_BASE
+static inline void df_acc_add32(df_superacc* acc, uint32_t v, size_t bit, bool negative) {
+    uint64_t t = (uint64_t)v << (bit & 31);
+    size_t k = bit >> 5;
+    int64_t lo = (int64_t)(t & 0xffffffffu);
+    int64_t hi = (int64_t)(t >> 32);
+    if (negative) {
+        acc->slot[k] -= lo;
+        acc->slot[k + 1] -= hi;
+    } else {
+        acc->slot[k] += lo;
+        acc->slot[k + 1] += hi;
+    }
+}
+
+// Helper: Add +/- v * 2^exp for a 64-bit v
+static inline void df_acc_add64(df_superacc* acc, uint64_t v, int exp, bool negative) {
+    if (v == 0) return;
+    size_t bit = (size_t)(exp - DF_ACC_BASE);
+    df_acc_add32(acc, (uint32_t)v, bit, negative);
+    df_acc_add32(acc, (uint32_t)(v >> 32), bit + 32, negative);
+}
+
+// Helper: Propagate carries so every slot but the last is in [0, 2^32)
+static void df_acc_normalize(df_superacc* acc) {
+    for (size_t i = 0; i + 1 < DF_ACC_SLOTS; i++) {
+        int64_t low = (int64_t)((uint64_t)acc->slot[i] & 0xffffffffu);
+        int64_t carry = (acc->slot[i] - low) / ((int64_t)1 << 32);
+        acc->slot[i] = low;
+        acc->slot[i + 1] += carry;
+    }
+}
+
+// Helper: Convert the accumulator into a fraction
+static df_frac df_acc_to_frac(df_superacc* acc) {
+    df_acc_normalize(acc);
+
+    size_t lo = 0;
+    while (lo < DF_ACC_SLOTS && acc->slot[lo] == 0) lo++;
+    if (lo == DF_ACC_SLOTS) return df_zero();
+
+    size_t hi = DF_ACC_SLOTS - 1;
+    while (acc->slot[hi] == 0) hi--;
+
+    // Horner over the digits; only the top slot may be negative
+    di_int num = di_from_int64(acc->slot[hi]);
+    for (size_t i = hi; i-- > lo;) {
+        di_int shifted = di_shift_left(num, 32);
+        di_int digit = di_from_uint32((uint32_t)acc->slot[i]);
+        di_release(&num);
+        num = di_add(shifted, digit);
+        di_release(&shifted);
+        di_release(&digit);
+    }
+
+    int64_t exp = (int64_t)lo * 32 + DF_ACC_BASE;
+    if (exp >= 0) {
+        di_int shifted = di_shift_left(num, (size_t)exp);
+        di_release(&num);
+        return df_dyadic_make(shifted, 0);
+    }
+    return df_dyadic_make(num, (size_t)-exp);
+}
+
+DF_IMPL df_frac df_sum_doubles(const double* x, size_t n) {
+    DF_ASSERT((x || n == 0) && "df_sum_doubles: array cannot be NULL");
+    DF_STAT(DF_STAT_SUM_DOUBLES);
+
+    df_superacc acc;
+    memset(&acc, 0, sizeof acc);
+
+    for (size_t i = 0; i < n; i++) {
+        uint64_t mant;
+        int exp;
+        bool negative;
+        if (!df_split_double(x[i], &mant, &exp, &negative)) return NULL;
+        df_acc_add64(&acc, mant, exp, negative);
+
+        if ((i + 1) % DF_ACC_BATCH == 0) df_acc_normalize(&acc);
+    }
+
+    return df_acc_to_frac(&acc);
+}
+
+DF_IMPL df_frac df_dot_doubles(const double* x, const double* y, size_t n) {
+    DF_ASSERT(((x && y) || n == 0) && "df_dot_doubles: arrays cannot be NULL");
+    DF_STAT(DF_STAT_DOT_DOUBLES);
+
+    df_superacc acc;
+    memset(&acc, 0, sizeof acc);
+
+    for (size_t i = 0; i < n; i++) {
+        uint64_t ma, mb;
+        int ea, eb;
+        bool na, nb;
+        if (!df_split_double(x[i], &ma, &ea, &na)) return NULL;
+        if (!df_split_double(y[i], &mb, &eb, &nb)) return NULL;
+        if (ma == 0 || mb == 0) continue;
+
+        // 106-bit product as four 64-bit partial products
+        bool negative = na != nb;
+        uint64_t a0 = ma & 0xffffffffu, a1 = ma >> 32;
+        uint64_t b0 = mb & 0xffffffffu, b1 = mb >> 32;
+        int exp = ea + eb;
+        df_acc_add64(&acc, a0 * b0, exp, negative);
+        df_acc_add64(&acc, a0 * b1, exp + 32, negative);
+        df_acc_add64(&acc, a1 * b0, exp + 32, negative);
+        df_acc_add64(&acc, a1 * b1, exp + 64, negative);
+
+        if ((i + 1) % DF_ACC_BATCH == 0) df_acc_normalize(&acc);
+    }
+
+    return df_acc_to_frac(&acc);
+}
+
+// ============================================================================
+// ROUNDING AND RESCALING IMPLEMENTATION
+// ============================================================================
+
+#if defined(__SIZEOF_INT128__)
+#define DF_HAVE_INT128 1
+#endif
+
+// Helper: Magnitude of an int64_t as uint64_t (INT64_MIN safe)
+static inline uint64_t df_uabs64(int64_t v) {
+    return v < 0 ? (uint64_t)0 - (uint64_t)v : (uint64_t)v;
+}
+
+// Helper: Number of significant bits in a 64-bit value
+static inline unsigned df_bitlen64(uint64_t v) {
+    if (v == 0) return 0;
+#if defined(__GNUC__) || defined(__clang__)
+    return 64 - (unsigned)__builtin_clzll(v);
+#else
+    unsigned n = 0;
+    while (v) {
+        v >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+// Helper: Full 64x64 -> 128-bit product
+static inline void df_umul128(uint64_t a, uint64_t b, uint64_t* hi, uint64_t* lo) {
+#ifdef DF_HAVE_INT128
+    unsigned __int128 p = (unsigned __int128)a * b;
+    *hi = (uint64_t)(p >> 64);
+    *lo = (uint64_t)p;
+#else
+    uint64_t a0 = a & 0xffffffffu, a1 = a >> 32;
+    uint64_t b0 = b & 0xffffffffu, b1 = b >> 32;
+    uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+    uint64_t mid = (p00 >> 32) + (p01 & 0xffffffffu) + (p10 & 0xffffffffu);
+    *lo = (mid << 32) | (p00 & 0xffffffffu);
+    *hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+#endif
+}
+
+// Helper: (hi:lo) / d for hi < d, so the quotient fits in 64 bits
+static inline uint64_t df_udiv128(uint64_t hi, uint64_t lo, uint64_t d, uint64_t* rem) {
+#ifdef DF_HAVE_INT128
+    unsigned __int128 n = ((unsigned __int128)hi << 64) | lo;
+    *rem = (uint64_t)(n % d);
+    return (uint64_t)(n / d);
+#else
+    // Restoring division, one quotient bit per step
+    uint64_t q = 0;
+    for (int i = 0; i < 64; i++) {
+        uint64_t carry = hi >> 63;
+        hi = (hi << 1) | (lo >> 63);
+        lo <<= 1;
+        q <<= 1;
+        if (carry || hi >= d) {
+            hi -= d;
+            q |= 1;
+        }
+    }
+    *rem = hi;
+    return q;
+#endif
+}
+
+// Helper: Whether to bump the truncated magnitude q by one
+//
+// half is the sign of 2r - d for remainder r and divisor d; inexact is
+// r != 0. Shared by every integer rounding path.
+static bool df_round_up(df_rounding mode, bool negative, bool inexact, int half, bool q_odd) {
+    if (!inexact) return false;
+    switch (mode) {
+        case DF_ROUND_FLOOR: return negative;
+        case DF_ROUND_CEIL: return !negative;
+        case DF_ROUND_TRUNC: return false;
+        case DF_ROUND_AWAY: return true;
+        case DF_ROUND_HALF_EVEN: return half > 0 || (half == 0 && q_odd);
+        case DF_ROUND_HALF_AWAY: return half >= 0;
+    }
+    DF_ASSERT(0 && "df_round_up: invalid rounding mode");
+    return false;
+}
+
+// Helper: Apply rounding to magnitude q, remainder r and sign
+static bool df_round_finish(uint64_t q, uint64_t r, uint64_t d, bool negative, df_rounding mode,
+                            int64_t* result) {
+    // 2r vs d without overflow: r < d <= 2^63
+    int half = r > d - r ? 1 : (r == d - r ? 0 : -1);
+    if (df_round_up(mode, negative, r != 0, half, q & 1)) {
+        if (q == UINT64_MAX) return false;
+        q++;
+    }
+
+    if (negative) {
+        if (q > (uint64_t)INT64_MAX + 1) return false;
+        *result = (int64_t)((uint64_t)0 - q);
+    } else {
+        if (q > (uint64_t)INT64_MAX) return false;
+        *result = (int64_t)q;
+    }
+    return true;
+}
+
+DF_IMPL bool df_rescale_i64(int64_t x, int64_t num, int64_t den, df_rounding mode, int64_t* result) {
+    DF_ASSERT(den != 0 && "df_rescale_i64: denominator cannot be zero");
+    DF_ASSERT(result && "df_rescale_i64: result pointer cannot be NULL");
+    DF_STAT(DF_STAT_RESCALE_I64);
+
+    bool negative = x != 0 && num != 0 && (((x < 0) != (num < 0)) != (den < 0));
+    uint64_t d = df_uabs64(den);
+
+    uint64_t hi, lo, r;
+    df_umul128(df_uabs64(x), df_uabs64(num), &hi, &lo);
+    if (hi >= d) return false;
+    uint64_t q = df_udiv128(hi, lo, d, &r);
+
+    return df_round_finish(q, r, d, negative, mode, result);
+}
+
+DF_IMPL bool df_rescale_many(const int64_t* x, int64_t* out, size_t n, int64_t num, int64_t den,
+                             df_rounding mode) {
+    DF_ASSERT(den != 0 && "df_rescale_many: denominator cannot be zero");
+    DF_ASSERT(((x && out) || n == 0) && "df_rescale_many: arrays cannot be NULL");
+    DF_STAT(DF_STAT_RESCALE_MANY);
+
+    uint64_t d = df_uabs64(den);
+    uint64_t m = df_uabs64(num);
+    bool ratio_negative = (num < 0) != (den < 0);
+
+    // Granlund-Montgomery reciprocal: for any 64-bit n,
+    // n / d == (t + ((n - t) >> sh1)) >> sh2 with t = mulhi(magic, n)
+    unsigned l = d > 1 ? df_bitlen64(d - 1) : 0;
+    uint64_t unused;
+    uint64_t magic = df_udiv128(((uint64_t)1 << l) - d, 0, d, &unused) + 1;
+    unsigned sh1 = l < 1 ? l : 1;
+    unsigned sh2 = l > 1 ? l - 1 : 0;
+
+    bool ok = true;
+    for (size_t i = 0; i < n; i++) {
+        int64_t xi = x[i];
+        bool negative = xi != 0 && num != 0 && ((xi < 0) != ratio_negative);
+
+        uint64_t hi, lo, q, r;
+        df_umul128(df_uabs64(xi), m, &hi, &lo);
+        if (hi == 0) {
+            uint64_t t, t_lo;
+            df_umul128(magic, lo, &t, &t_lo);
+            q = (t + ((lo - t) >> sh1)) >> sh2;
+            r = lo - q * d;
+        } else if (hi < d) {
+            q = df_udiv128(hi, lo, d, &r);
+        } else {
+            out[i] = 0;
+            ok = false;
+            continue;
+        }
+
+        if (!df_round_finish(q, r, d, negative, mode, &out[i])) {
+            out[i] = 0;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+// Helper: Quantize with big components via di_int quotient and remainder
+static bool df_quantize_big(df_frac f, int64_t den, df_rounding mode, int64_t* result) {
+    di_int scale = di_from_int64(den);
+    di_int mag = di_abs(f->numerator);
+    di_int p = di_mul(mag, scale);
+    di_int q = di_div(p, f->denominator);
+    di_int qd = di_mul(q, f->denominator);
+    di_int r = di_sub(p, qd);
+    di_int twice = di_shift_left(r, 1);
+
+    uint64_t mag_q;
+    bool ok = di_to_uint64(q, &mag_q);
+    if (ok) {
+        bool negative = di_is_negative(f->numerator);
+        int half = di_compare(twice, f->denominator);
+        if (df_round_up(mode, negative, !di_is_zero(r), half, mag_q & 1)) {
+            ok = mag_q != UINT64_MAX;
+            mag_q++;
+        }
+        if (ok && negative) {
+            ok = mag_q <= (uint64_t)INT64_MAX + 1;
+            if (ok) *result = (int64_t)((uint64_t)0 - mag_q);
+        } else if (ok) {
+            ok = mag_q <= (uint64_t)INT64_MAX;
+            if (ok) *result = (int64_t)mag_q;
+        }
+    }
+
+    di_release(&scale);
+    di_release(&mag);
+    di_release(&p);
+    di_release(&q);
+    di_release(&qd);
+    di_release(&r);
+    di_release(&twice);
+    return ok;
+}
+
+DF_IMPL bool df_quantize(df_frac f, int64_t den, df_rounding mode, int64_t* result) {
+    DF_ASSERT(f && "df_quantize: operand cannot be NULL");
+    DF_ASSERT(den > 0 && "df_quantize: denominator must be positive");
+    DF_ASSERT(result && "df_quantize: result pointer cannot be NULL");
+    DF_STAT(DF_STAT_QUANTIZE);
+
+    int64_t num, d;
+    if (di_to_int64(f->numerator, &num) && di_to_int64(f->denominator, &d)) {
+        return df_rescale_i64(num, den, d, mode, result);
+    }
+    return df_quantize_big(f, den, mode, result);
+}
+
+DF_IMPL bool df_quantize_many(const df_frac* f, size_t n, int64_t den, df_rounding mode, int64_t* out) {
+    DF_ASSERT(((f && out) || n == 0) && "df_quantize_many: arrays cannot be NULL");
+    DF_STAT(DF_STAT_QUANTIZE_MANY);
+
+    bool ok = true;
+    for (size_t i = 0; i < n; i++) {
+        if (!df_quantize(f[i], den, mode, &out[i])) {
+            out[i] = 0;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+// ============================================================================
+// GEOMETRIC PREDICATES IMPLEMENTATION
+// ============================================================================
+
+typedef enum { DF_PRED_ORIENT2D, DF_PRED_ORIENT3D, DF_PRED_INCIRCLE } df_pred_kind;
+
+// Coordinates per predicate: points flattened as (a, b, c[, d])
+static const size_t df_pred_coords[] = {6, 12, 8};
+
+// Value with an absolute error bound
+typedef struct {
+    double v;
+    double e;
+} df_ival;
+
+// Helper: Interval difference; rounding adds at most eps * |result|
+static df_ival df_ival_sub(df_ival a, df_ival b) {
+    df_ival r;
+    r.v = a.v - b.v;
+    r.e = a.e + b.e + fabs(r.v) * DBL_EPSILON;
+    return r;
+}
+
+static df_ival df_ival_add(df_ival a, df_ival b) {
+    df_ival r;
+    r.v = a.v + b.v;
+    r.e = a.e + b.e + fabs(r.v) * DBL_EPSILON;
+    return r;
+}
+
+// Helper: Interval product; DBL_TRUE_MIN covers underflow
+static df_ival df_ival_mul(df_ival a, df_ival b) {
+    df_ival r;
+    r.v = a.v * b.v;
+    r.e = fabs(a.v) * b.e + fabs(b.v) * a.e + a.e * b.e + fabs(r.v) * DBL_EPSILON + DBL_TRUE_MIN;
+    return r;
+}
+
+// Helper: a*d - b*c
+static df_ival df_ival_det2(df_ival a, df_ival b, df_ival c, df_ival d) {
+    return df_ival_sub(df_ival_mul(a, d), df_ival_mul(b, c));
+}
+
+// Helper: Determinant of a predicate in interval arithmetic
+static df_ival df_pred_ival(df_pred_kind kind, const df_ival* p) {
+    if (kind == DF_PRED_ORIENT2D) {
+        df_ival acx = df_ival_sub(p[0], p[4]), acy = df_ival_sub(p[1], p[5]);
+        df_ival bcx = df_ival_sub(p[2], p[4]), bcy = df_ival_sub(p[3], p[5]);
+        return df_ival_det2(acx, acy, bcx, bcy);
+    }
+
+    if (kind == DF_PRED_ORIENT3D) {
+        df_ival ad[3], bd[3], cd[3];
+        for (int i = 0; i < 3; i++) {
+            ad[i] = df_ival_sub(p[i], p[9 + i]);
+            bd[i] = df_ival_sub(p[3 + i], p[9 + i]);
+            cd[i] = df_ival_sub(p[6 + i], p[9 + i]);
+        }
+        df_ival t0 = df_ival_mul(ad[0], df_ival_det2(bd[1], bd[2], cd[1], cd[2]));
+        df_ival t1 = df_ival_mul(bd[0], df_ival_det2(cd[1], cd[2], ad[1], ad[2]));
+        df_ival t2 = df_ival_mul(cd[0], df_ival_det2(ad[1], ad[2], bd[1], bd[2]));
+        return df_ival_add(df_ival_add(t0, t1), t2);
+    }
+
+    df_ival ad[2], bd[2], cd[2];
+    for (int i = 0; i < 2; i++) {
+        ad[i] = df_ival_sub(p[i], p[6 + i]);
+        bd[i] = df_ival_sub(p[2 + i], p[6 + i]);
+        cd[i] = df_ival_sub(p[4 + i], p[6 + i]);
+    }
+    df_ival alift = df_ival_add(df_ival_mul(ad[0], ad[0]), df_ival_mul(ad[1], ad[1]));
+    df_ival blift = df_ival_add(df_ival_mul(bd[0], bd[0]), df_ival_mul(bd[1], bd[1]));
+    df_ival clift = df_ival_add(df_ival_mul(cd[0], cd[0]), df_ival_mul(cd[1], cd[1]));
+    df_ival t0 = df_ival_mul(alift, df_ival_det2(bd[0], bd[1], cd[0], cd[1]));
+    df_ival t1 = df_ival_mul(blift, df_ival_det2(cd[0], cd[1], ad[0], ad[1]));
+    df_ival t2 = df_ival_mul(clift, df_ival_det2(ad[0], ad[1], bd[0], bd[1]));
+    return df_ival_add(df_ival_add(t0, t1), t2);
+}
+
+// Helper: Sign from the filter, or 2 if it cannot decide
+static int df_pred_filter(df_pred_kind kind, const df_ival* p) {
+    df_ival det = df_pred_ival(kind, p);
+    if (!isfinite(det.v) || !isfinite(det.e)) return 2;
+
+    // Slack for rounding in the bound computation itself
+    double bound = det.e * (1.0 + 64 * DBL_EPSILON);
+    if (det.v > bound) return 1;
+    if (det.v < -bound) return -1;
+    if (det.v == 0 && det.e == 0) return 0;
+    return 2;
+}
+
+// Helper: a*d - b*c over di_int
+static di_int df_di_det2(di_int a, di_int b, di_int c, di_int d) {
+    di_int ad = di_mul(a, d);
+    di_int bc = di_mul(b, c);
+    di_int r = di_sub(ad, bc);
+    di_release(&ad);
+    di_release(&bc);
+    return r;
+}
+
+// Helper: x*x + y*y over di_int
+static di_int df_di_lift(di_int x, di_int y) {
+    di_int xx = di_mul(x, x);
+    di_int yy = di_mul(y, y);
+    di_int r = di_add(xx, yy);
+    di_release(&xx);
+    di_release(&yy);
+    return r;
+}
+
+// Helper: x*y + acc, consuming x and acc
+static di_int df_di_fma_take(di_int acc, di_int x, di_int y) {
+    di_int prod = di_mul(x, y);
+    di_int r = acc ? di_add(acc, prod) : di_retain(prod);
+    di_release(&acc);
+    di_release(&x);
+    di_release(&prod);
+    return r;
+}
+
+// Helper: Exact determinant sign over integer coordinates
+static int df_pred_exact(df_pred_kind kind, const di_int* p) {
+    size_t dims = kind == DF_PRED_ORIENT3D ? 3 : 2;
+    size_t base = kind == DF_PRED_ORIENT2D ? 4 : dims * 3;
+
+    // Translate so the last point is the origin
+    di_int ad[3], bd[3], cd[3];
+    for (size_t i = 0; i < dims; i++) {
+        ad[i] = di_sub(p[i], p[base + i]);
+        bd[i] = di_sub(p[dims + i], p[base + i]);
+        cd[i] = kind == DF_PRED_ORIENT2D ? NULL : di_sub(p[2 * dims + i], p[base + i]);
+    }
+
+    di_int det;
+    if (kind == DF_PRED_ORIENT2D) {
+        det = df_di_det2(ad[0], ad[1], bd[0], bd[1]);
+    } else if (kind == DF_PRED_ORIENT3D) {
+        det = NULL;
+        det = df_di_fma_take(det, df_di_det2(bd[1], bd[2], cd[1], cd[2]), ad[0]);
+        det = df_di_fma_take(det, df_di_det2(cd[1], cd[2], ad[1], ad[2]), bd[0]);
+        det = df_di_fma_take(det, df_di_det2(ad[1], ad[2], bd[1], bd[2]), cd[0]);
+    } else {
+        di_int* rows[3] = {ad, bd, cd};
+        det = NULL;
+        for (int r = 0; r < 3; r++) {
+            di_int* u = rows[(r + 1) % 3];
+            di_int* v = rows[(r + 2) % 3];
+            di_int lift = df_di_lift(rows[r][0], rows[r][1]);
+            det = df_di_fma_take(det, df_di_det2(u[0], u[1], v[0], v[1]), lift);
+            di_release(&lift);
+        }
+    }
+
+    int sign = di_is_zero(det) ? 0 : (di_is_negative(det) ? -1 : 1);
+
+    di_release(&det);
+    for (size_t i = 0; i < dims; i++) {
+        di_release(&ad[i]);
+        di_release(&bd[i]);
+        di_release(&cd[i]);
+    }
+    return sign;
+}
+
+// Helper: Predicate over fraction coordinates
+static int df_pred_frac(df_pred_kind kind, const df_frac* p) {
+    size_t n = df_pred_coords[kind];
+
+    df_ival iv[12] = {{0, 0}};
+    for (size_t i = 0; i < n; i++) {
+        DF_ASSERT(p[i] && "df_pred_frac: coordinate cannot be NULL");
+        df_approx(p[i]);
+        iv[i].v = p[i]->approx;
+        iv[i].e = p[i]->approx_err;
+    }
+    int sign = df_pred_filter(kind, iv);
+    if (sign != 2) return sign;
+
+    // Distinct denominators, then N_i = num_i * (product of the others)
+    di_int dens[12];
+    size_t which[12];
+    size_t k = 0;
+    for (size_t i = 0; i < n; i++) {
+        size_t j = 0;
+        while (j < k && !di_eq(dens[j], p[i]->denominator)) j++;
+        if (j == k) dens[k++] = p[i]->denominator;
+        which[i] = j;
+    }
+
+    di_int others[12];
+    di_int prefix = di_one();
+    for (size_t j = 0; j < k; j++) {
+        others[j] = di_retain(prefix);
+        di_int next = di_mul(prefix, dens[j]);
+        di_release(&prefix);
+        prefix = next;
+    }
+    di_release(&prefix);
+    di_int suffix = di_one();
+    for (size_t j = k; j-- > 0;) {
+        di_int both = di_mul(others[j], suffix);
+        di_release(&others[j]);
+        others[j] = both;
+        di_int next = di_mul(suffix, dens[j]);
+        di_release(&suffix);
+        suffix = next;
+    }
+    di_release(&suffix);
+
+    di_int nums[12] = {NULL};
+    for (size_t i = 0; i < n; i++) {
+        nums[i] = k == 1 ? di_retain(p[i]->numerator) : di_mul(p[i]->numerator, others[which[i]]);
+    }
+
+    sign = df_pred_exact(kind, nums);
+
+    for (size_t i = 0; i < n; i++) di_release(&nums[i]);
+    for (size_t j = 0; j < k; j++) di_release(&others[j]);
+    return sign;
+}
+
+// Helper: Predicate over double coordinates
+static int df_pred_double(df_pred_kind kind, const double* p) {
+    size_t n = df_pred_coords[kind];
+
+    df_ival iv[12] = {{0, 0}};
+    for (size_t i = 0; i < n; i++) {
+        DF_ASSERT(isfinite(p[i]) && "df_pred_double: coordinates must be finite");
+        iv[i].v = p[i];
+        iv[i].e = 0;
+    }
+    int sign = df_pred_filter(kind, iv);
+    if (sign != 2) return sign;
+
+    // Common denominator is 2^-min_exp
+    uint64_t mant[12];
+    int exp[12];
+    bool negative[12];
+    int min_exp = INT_MAX;
+    for (size_t i = 0; i < n; i++) {
+        df_split_double(p[i], &mant[i], &exp[i], &negative[i]);
+        if (mant[i] && exp[i] < min_exp) min_exp = exp[i];
+    }
+
+    di_int nums[12] = {NULL};
+    for (size_t i = 0; i < n; i++) {
+        di_int m = di_from_uint64(mant[i]);
+        di_int shifted = mant[i] ? di_shift_left(m, (size_t)(exp[i] - min_exp)) : di_retain(m);
+        di_release(&m);
+        nums[i] = negative[i] ? di_negate(shifted) : di_retain(shifted);
+        di_release(&shifted);
+    }
+
+    sign = df_pred_exact(kind, nums);
+
+    for (size_t i = 0; i < n; i++) di_release(&nums[i]);
+    return sign;
+}
+
+DF_IMPL int df_orient2d(const df_frac a[2], const df_frac b[2], const df_frac c[2]) {
+    DF_ASSERT(a && b && c && "df_orient2d: points cannot be NULL");
+    DF_STAT(DF_STAT_ORIENT2D);
+    df_frac p[6] = {a[0], a[1], b[0], b[1], c[0], c[1]};
+    return df_pred_frac(DF_PRED_ORIENT2D, p);
+}
+
+DF_IMPL int df_orient3d(const df_frac a[3], const df_frac b[3], const df_frac c[3], const df_frac d[3]) {
+    DF_ASSERT(a && b && c && d && "df_orient3d: points cannot be NULL");
+    DF_STAT(DF_STAT_ORIENT3D);
+    df_frac p[12] = {a[0], a[1], a[2], b[0], b[1], b[2], c[0], c[1], c[2], d[0], d[1], d[2]};
+    return df_pred_frac(DF_PRED_ORIENT3D, p);
+}
+
+DF_IMPL int df_incircle(const df_frac a[2], const df_frac b[2], const df_frac c[2], const df_frac d[2]) {
+    DF_ASSERT(a && b && c && d && "df_incircle: points cannot be NULL");
+    DF_STAT(DF_STAT_INCIRCLE);
+    df_frac p[8] = {a[0], a[1], b[0], b[1], c[0], c[1], d[0], d[1]};
+    return df_pred_frac(DF_PRED_INCIRCLE, p);
+}
+
+DF_IMPL int df_orient2d_d(const double a[2], const double b[2], const double c[2]) {
+    DF_ASSERT(a && b && c && "df_orient2d_d: points cannot be NULL");
+    DF_STAT(DF_STAT_ORIENT2D_D);
+    double p[6] = {a[0], a[1], b[0], b[1], c[0], c[1]};
+    return df_pred_double(DF_PRED_ORIENT2D, p);
+}
+
+DF_IMPL int df_orient3d_d(const double a[3], const double b[3], const double c[3], const double d[3]) {
+    DF_ASSERT(a && b && c && d && "df_orient3d_d: points cannot be NULL");
+    DF_STAT(DF_STAT_ORIENT3D_D);
+    double p[12] = {a[0], a[1], a[2], b[0], b[1], b[2], c[0], c[1], c[2], d[0], d[1], d[2]};
+    return df_pred_double(DF_PRED_ORIENT3D, p);
+}
+
+DF_IMPL int df_incircle_d(const double a[2], const double b[2], const double c[2], const double d[2]) {
+    DF_ASSERT(a && b && c && d && "df_incircle_d: points cannot be NULL");
+    DF_STAT(DF_STAT_INCIRCLE_D);
+    double p[8] = {a[0], a[1], b[0], b[1], c[0], c[1], d[0], d[1]};
+    return df_pred_double(DF_PRED_INCIRCLE, p);
+}
+
+// ============================================================================
+// COLUMNAR STORAGE IMPLEMENTATION
+// ============================================================================
+
+// Helper: Binary GCD of two 64-bit values
+static uint64_t df_gcd_u64(uint64_t a, uint64_t b) {
+    if (a == 0) return b;
+    if (b == 0) return a;
+    size_t shift = df_ctz64(a | b);
+    a >>= df_ctz64(a);
+    do {
+        b >>= df_ctz64(b);
+        if (a > b) {
+            uint64_t t = a;
+            a = b;
+            b = t;
+        }
+        b -= a;
+    } while (b != 0);
+    return a << shift;
 }
 
-// Release (decrease reference count)
-DF_IMPL void df_release(df_frac* f) {
-    if (!f || !*f) return;
+static inline bool df_column_is_big(df_column c, size_t i) {
+    return (c->overflow[i >> 6] >> (i & 63)) & 1;
+}
 
-    (*f)->ref_count--;
-    if ((*f)->ref_count == 0) {
-        di_release(&(*f)->numerator);
-        di_release(&(*f)->denominator);
-        DF_FREE(*f);
+static inline void df_column_set_big(df_column c, size_t i, bool big) {
+    uint64_t bit = (uint64_t)1 << (i & 63);
+    if (big) {
+        c->overflow[i >> 6] |= bit;
+    } else {
+        c->overflow[i >> 6] &= ~bit;
     }
-    *f = NULL;
 }
 
-// Addition: a/b + c/d = (ad + bc) / bd
-DF_IMPL df_frac df_add(df_frac a, df_frac b) {
-    DF_ASSERT(a && "df_add: first operand cannot be NULL");
-    DF_ASSERT(b && "df_add: second operand cannot be NULL");
+// Helper: Ensure room for at least need entries
+static void df_column_reserve(df_column c, size_t need) {
+    if (need <= c->capacity) return;
+
+    size_t cap = c->capacity ? c->capacity : 16;
+    while (cap < need) cap *= 2;
+
+    size_t old_words = (c->capacity + 63) / 64;
+    size_t new_words = (cap + 63) / 64;
+    c->num = (int64_t*)DF_REALLOC(c->num, cap * sizeof(int64_t));
+    c->den = (uint64_t*)DF_REALLOC(c->den, cap * sizeof(uint64_t));
+    c->overflow = (uint64_t*)DF_REALLOC(c->overflow, new_words * sizeof(uint64_t));
+    DF_ASSERT(c->num && c->den && c->overflow && "df_column_reserve: allocation failed");
+    memset(c->overflow + old_words, 0, (new_words - old_words) * sizeof(uint64_t));
+    c->capacity = cap;
+}
 
-    // Calculate ad and bc
-    di_int ad = di_mul(a->numerator, b->denominator);
-    di_int bc = di_mul(b->numerator, a->denominator);
-    di_int num = di_add(ad, bc);
+// Helper: Store a fraction at entry i (any previous contents are already
+// released)
+static void df_column_store(df_column c, size_t i, df_frac f) {
+    if (!f) {
+        c->num[i] = 0;
+        c->den[i] = 0;
+        df_column_set_big(c, i, false);
+        return;
+    }
 
-    // Calculate bd
-    di_int den = di_mul(a->denominator, b->denominator);
+    int64_t num;
+    uint64_t den;
+    if (di_to_int64(f->numerator, &num) && di_to_uint64(f->denominator, &den)) {
+        c->num[i] = num;
+        c->den[i] = den;
+        df_column_set_big(c, i, false);
+        return;
+    }
 
-    df_frac result = df_from_di(num, den);
+    // Released slots are reused before the side table grows
+    size_t slot;
+    if (c->free_count > 0) {
+        slot = c->big_free[--c->free_count];
+    } else {
+        if (c->big_count == c->big_capacity) {
+            size_t cap = c->big_capacity ? c->big_capacity * 2 : 4;
+            c->big_num = (di_int*)DF_REALLOC(c->big_num, cap * sizeof(di_int));
+            c->big_den = (di_int*)DF_REALLOC(c->big_den, cap * sizeof(di_int));
+            c->big_free = (size_t*)DF_REALLOC(c->big_free, cap * sizeof(size_t));
+            DF_ASSERT(c->big_num && c->big_den && c->big_free && "df_column_store: allocation failed");
+            c->big_capacity = cap;
+        }
+        slot = c->big_count++;
+    }
+    c->big_num[slot] = di_retain(f->numerator);
+    c->big_den[slot] = di_retain(f->denominator);
+    c->num[i] = (int64_t)slot;
+    c->den[i] = 0;
+    df_column_set_big(c, i, true);
+}
 
-    di_release(&ad);
-    di_release(&bc);
-    di_release(&num);
-    di_release(&den);
+// Helper: Drop any side table reference held by entry i, returning its slot
+// to the free list (big_free has room for every slot handed out)
+static void df_column_clear(df_column c, size_t i) {
+    if (!df_column_is_big(c, i)) return;
+    size_t slot = (size_t)c->num[i];
+    di_release(&c->big_num[slot]);
+    di_release(&c->big_den[slot]);
+    c->big_free[c->free_count++] = slot;
+    df_column_set_big(c, i, false);
+}
 
-    return result;
+DF_IMPL df_column df_column_new(size_t capacity) {
+    DF_STAT(DF_STAT_COLUMN_NEW);
+    df_column c = (df_column)DF_MALLOC(sizeof(struct df_column_internal));
+    DF_ASSERT(c && "df_column_new: allocation failed");
+    memset(c, 0, sizeof(*c));
+    c->ref_count = 1;
+    df_column_reserve(c, capacity);
+    return c;
 }
 
-// Subtraction: a/b - c/d = (ad - bc) / bd
-DF_IMPL df_frac df_sub(df_frac a, df_frac b) {
-    DF_ASSERT(a && "df_sub: first operand cannot be NULL");
-    DF_ASSERT(b && "df_sub: second operand cannot be NULL");
+DF_IMPL df_column df_column_from_fracs(const df_frac* values, size_t n) {
+    DF_ASSERT((values || n == 0) && "df_column_from_fracs: values cannot be NULL");
+    DF_STAT(DF_STAT_COLUMN_FROM_FRACS);
 
-    // Calculate ad and bc
-    di_int ad = di_mul(a->numerator, b->denominator);
-    di_int bc = di_mul(b->numerator, a->denominator);
-    di_int num = di_sub(ad, bc);
+    df_column c = df_column_new(n);
+    for (size_t i = 0; i < n; i++) {
+        df_column_store(c, i, values[i]);
+    }
+    c->length = n;
+    return c;
+}
 
-    // Calculate bd
-    di_int den = di_mul(a->denominator, b->denominator);
+DF_IMPL df_column df_column_retain(df_column c) {
+    DF_ASSERT(c && "df_column_retain: column cannot be NULL");
+    DF_STAT(DF_STAT_COLUMN_RETAIN);
+    c->ref_count++;
+    return c;
+}
 
-    df_frac result = df_from_di(num, den);
+DF_IMPL void df_column_release(df_column* c) {
+    DF_STAT(DF_STAT_COLUMN_RELEASE);
+    if (!c || !*c) return;
+
+    df_column col = *c;
+    DF_ASSERT(col->ref_count > 0 && "df_column_release: invalid reference count");
+    if (--col->ref_count == 0) {
+        // Released slots are NULL; reuse keeps big_count at the peak live count
+        for (size_t s = 0; s < col->big_count; s++) {
+            di_release(&col->big_num[s]);
+            di_release(&col->big_den[s]);
+        }
+        DF_FREE(col->big_num);
+        DF_FREE(col->big_den);
+        DF_FREE(col->big_free);
+        DF_FREE(col->num);
+        DF_FREE(col->den);
+        DF_FREE(col->overflow);
+        DF_FREE(col);
+    }
+    *c = NULL;
+}
 
-    di_release(&ad);
-    di_release(&bc);
-    di_release(&num);
-    di_release(&den);
+DF_IMPL size_t df_column_length(df_column c) {
+    DF_ASSERT(c && "df_column_length: column cannot be NULL");
+    DF_STAT(DF_STAT_COLUMN_LENGTH);
+    return c->length;
+}
 
-    return result;
+DF_IMPL void df_column_append(df_column c, df_frac f) {
+    DF_ASSERT(c && "df_column_append: column cannot be NULL");
+    DF_STAT(DF_STAT_COLUMN_APPEND);
+    df_column_reserve(c, c->length + 1);
+    df_column_store(c, c->length, f);
+    c->length++;
 }
 
-// Multiplication: (a/b) * (c/d) = ac / bd
-DF_IMPL df_frac df_mul(df_frac a, df_frac b) {
-    DF_ASSERT(a && "df_mul: first operand cannot be NULL");
-    DF_ASSERT(b && "df_mul: second operand cannot be NULL");
+DF_IMPL void df_column_append_ints(df_column c, int64_t num, int64_t den) {
+    DF_ASSERT(c && "df_column_append_ints: column cannot be NULL");
+    DF_ASSERT(den != 0 && "df_column_append_ints: denominator cannot be zero");
+    DF_STAT(DF_STAT_COLUMN_APPEND_INTS);
+
+    bool negative = (num < 0) != (den < 0) && num != 0;
+    uint64_t n = df_uabs64(num);
+    uint64_t d = df_uabs64(den);
+    uint64_t g = df_gcd_u64(n, d);
+    n /= g;
+    d /= g;
+
+    // Only -2^63 itself does not fit the signed numerator
+    if (n > (uint64_t)INT64_MAX && !(negative && n == (uint64_t)INT64_MAX + 1)) {
+        df_frac f = df_from_ints(num, den);
+        df_column_append(c, f);
+        df_release(&f);
+        return;
+    }
 
-    di_int num = di_mul(a->numerator, b->numerator);
-    di_int den = di_mul(a->denominator, b->denominator);
+    df_column_reserve(c, c->length + 1);
+    c->num[c->length] = negative ? (int64_t)((uint64_t)0 - n) : (int64_t)n;
+    c->den[c->length] = d;
+    df_column_set_big(c, c->length, false);
+    c->length++;
+}
 
-    df_frac result = df_from_di(num, den);
+DF_IMPL df_frac df_column_get(df_column c, size_t i) {
+    DF_ASSERT(c && "df_column_get: column cannot be NULL");
+    DF_ASSERT(i < c->length && "df_column_get: index out of range");
+    DF_STAT(DF_STAT_COLUMN_GET);
 
-    di_release(&num);
-    di_release(&den);
+    if (df_column_is_big(c, i)) {
+        size_t slot = (size_t)c->num[i];
+        return df_from_reduced(di_retain(c->big_num[slot]), di_retain(c->big_den[slot]));
+    }
+    if (c->den[i] == 0) return NULL;
+    return df_from_reduced(di_from_int64(c->num[i]), di_from_uint64(c->den[i]));
+}
+
+DF_IMPL void df_column_set(df_column c, size_t i, df_frac f) {
+    DF_ASSERT(c && "df_column_set: column cannot be NULL");
+    DF_ASSERT(i < c->length && "df_column_set: index out of range");
+    DF_STAT(DF_STAT_COLUMN_SET);
+
+    df_column_clear(c, i);
+    df_column_store(c, i, f);
+}
+
+DF_IMPL bool df_column_is_null(df_column c, size_t i) {
+    DF_ASSERT(c && "df_column_is_null: column cannot be NULL");
+    DF_ASSERT(i < c->length && "df_column_is_null: index out of range");
+    DF_STAT(DF_STAT_COLUMN_IS_NULL);
+    return !df_column_is_big(c, i) && c->den[i] == 0;
+}
+
+DF_IMPL void df_column_to_fracs(df_column c, df_frac* out) {
+    DF_ASSERT(c && "df_column_to_fracs: column cannot be NULL");
+    DF_ASSERT((out || c->length == 0) && "df_column_to_fracs: output cannot be NULL");
+    DF_STAT(DF_STAT_COLUMN_TO_FRACS);
+
+    for (size_t i = 0; i < c->length; i++) {
+        out[i] = df_column_get(c, i);
+    }
+}
+
+// Signed 128-bit integer: hi * 2^64 + lo
+typedef struct {
+    uint64_t lo;
+    int64_t hi;
+} df_i128;
+
+static inline df_i128 df_i128_from_i64(int64_t v) {
+    df_i128 r;
+    r.lo = (uint64_t)v;
+    r.hi = v < 0 ? -1 : 0;
+    return r;
+}
+
+static inline bool df_i128_is_negative(df_i128 a) {
+    return a.hi < 0;
+}
+
+// Helper: Magnitude of a as unsigned (hi, lo)
+static inline void df_i128_magnitude(df_i128 a, uint64_t* hi, uint64_t* lo) {
+    if (a.hi < 0) {
+        *lo = (uint64_t)0 - a.lo;
+        *hi = ~(uint64_t)a.hi + (a.lo == 0);
+    } else {
+        *lo = a.lo;
+        *hi = (uint64_t)a.hi;
+    }
+}
+
+// Helper: Signed value from a magnitude below 2^127
+static inline df_i128 df_i128_from_magnitude(uint64_t hi, uint64_t lo, bool negative) {
+    df_i128 r;
+    if (negative) {
+        r.lo = (uint64_t)0 - lo;
+        r.hi = (int64_t)(~hi + (lo == 0));
+    } else {
+        r.lo = lo;
+        r.hi = (int64_t)hi;
+    }
+    return r;
+}
+
+// Helper: a += b, false (a unchanged) on overflow
+static inline bool df_i128_add(df_i128* a, df_i128 b) {
+    uint64_t lo = a->lo + b.lo;
+    uint64_t hi = (uint64_t)a->hi + (uint64_t)b.hi + (lo < a->lo);
+    // Overflow iff both operands share a sign the result lacks
+    if ((((uint64_t)a->hi ^ hi) & ((uint64_t)b.hi ^ hi)) >> 63) return false;
+    a->lo = lo;
+    a->hi = (int64_t)hi;
+    return true;
+}
+
+// Helper: a *= k, false (a unchanged) on overflow
+static bool df_i128_mul_u64(df_i128* a, uint64_t k) {
+    uint64_t ah, al, p0h, p0l, p1h, p1l;
+    df_i128_magnitude(*a, &ah, &al);
+    df_umul128(al, k, &p0h, &p0l);
+    df_umul128(ah, k, &p1h, &p1l);
+    uint64_t mid = p0h + p1l;
+    if (p1h != 0 || mid < p0h || mid >> 63) return false;
+    *a = df_i128_from_magnitude(mid, p0l, df_i128_is_negative(*a));
+    return true;
+}
+
+// Helper: n * k for signed n and unsigned k (always fits)
+static inline df_i128 df_i128_mul_i64_u64(int64_t n, uint64_t k) {
+    uint64_t hi, lo;
+    df_umul128(df_uabs64(n), k, &hi, &lo);
+    return df_i128_from_magnitude(hi, lo, n < 0);
+}
+
+static di_int df_i128_to_di(df_i128 a) {
+    if (a.hi == ((int64_t)a.lo >> 63)) return di_from_int64((int64_t)a.lo);
+
+    uint64_t hi, lo;
+    df_i128_magnitude(a, &hi, &lo);
+    di_int high = di_from_uint64(hi);
+    di_int shifted = di_shift_left(high, 64);
+    di_int low = di_from_uint64(lo);
+    di_int mag = di_add(shifted, low);
+    di_release(&high);
+    di_release(&shifted);
+    di_release(&low);
+    if (!df_i128_is_negative(a)) return mag;
+    di_int neg = di_negate(mag);
+    di_release(&mag);
+    return neg;
+}
+
+// Helper: *total += part, consuming part (*total may be NULL)
+static void df_total_add(df_frac* total, df_frac part) {
+    if (*total) {
+        df_frac sum = df_add(*total, part);
+        df_release(total);
+        df_release(&part);
+        *total = sum;
+    } else {
+        *total = part;
+    }
+}
+
+#define DF_SUM_CACHE 16
+
+// Running sum: total + acc / den, with a small direct-mapped cache of
+// den / d for denominators d already known to divide den
+typedef struct {
+    df_i128 acc;
+    uint64_t den;
+    df_frac total;
+    uint64_t cache_den[DF_SUM_CACHE];
+    uint64_t cache_scale[DF_SUM_CACHE];
+} df_sum_state;
+
+// Helper: Switch to a new common denominator
+static void df_sum_set_den(df_sum_state* s, uint64_t den) {
+    s->den = den;
+    memset(s->cache_den, 0, sizeof(s->cache_den));
+}
+
+// Helper: acc / den as a fraction, reduced with one 64-bit GCD
+static df_frac df_sum_value(const df_sum_state* s) {
+    uint64_t hi, lo, rem;
+    df_i128_magnitude(s->acc, &hi, &lo);
+    df_udiv128(hi % s->den, lo, s->den, &rem);
+    uint64_t g = df_gcd_u64(rem, s->den);
+
+    uint64_t q_lo = df_udiv128(hi % g, lo, g, &rem);
+    df_i128 num = df_i128_from_magnitude(hi / g, q_lo, df_i128_is_negative(s->acc));
+    return df_from_reduced(df_i128_to_di(num), di_from_uint64(s->den / g));
+}
+
+// Helper: Move acc / den into the df_frac total
+static void df_sum_flush(df_sum_state* s) {
+    if (s->acc.lo == 0 && s->acc.hi == 0) return;
+
+    df_total_add(&s->total, df_sum_value(s));
+    s->acc = df_i128_from_i64(0);
+}
+
+// Helper: Admit a denominator not yet known to divide den, returning
+// den / d after any change of common denominator
+static uint64_t df_sum_admit_den(df_sum_state* s, uint64_t d) {
+    uint64_t g = df_gcd_u64(s->den, d);
+    uint64_t grow = d / g;
+    uint64_t hi, lcm;
+    df_umul128(s->den, grow, &hi, &lcm);
+
+    df_i128 scaled = s->acc;
+    if (hi == 0 && df_i128_mul_u64(&scaled, grow)) {
+        s->acc = scaled;
+        if (grow != 1) df_sum_set_den(s, lcm);
+    } else {
+        // Common denominator would overflow: fold and restart at d
+        df_sum_flush(s);
+        df_sum_set_den(s, d);
+    }
+
+    uint64_t scale = s->den / d;
+    s->cache_den[d % DF_SUM_CACHE] = d;
+    s->cache_scale[d % DF_SUM_CACHE] = scale;
+    return scale;
+}
+
+// Helper: Add one inline entry n/d
+static inline void df_sum_add_small(df_sum_state* s, int64_t n, uint64_t d) {
+    uint64_t scale;
+    size_t slot = (size_t)(d % DF_SUM_CACHE);
+    if (d == s->den) {
+        scale = 1;
+    } else if (s->cache_den[slot] == d) {
+        scale = s->cache_scale[slot];
+    } else {
+        scale = df_sum_admit_den(s, d);
+    }
+
+    if (!df_i128_add(&s->acc, df_i128_mul_i64_u64(n, scale))) {
+        // Numerator overflow: fold and restart from this entry
+        df_sum_flush(s);
+        df_sum_set_den(s, d);
+        s->acc = df_i128_from_i64(n);
+    }
+}
+
+// Helper: Add a side table entry
+static void df_sum_add_big(df_sum_state* s, df_column c, size_t i) {
+    df_total_add(&s->total, df_column_get(c, i));
+}
 
+// Helper: Sum of all non-null entries; counts them into *count
+static df_frac df_column_sum_count(df_column c, size_t* count) {
+    df_sum_state s;
+    s.acc = df_i128_from_i64(0);
+    s.total = NULL;
+    df_sum_set_den(&s, 1);
+    size_t nonnull = 0;
+
+    size_t i = 0;
+    while (i < c->length) {
+        // Whole 64-entry blocks with no side table entries and a shared
+        // denominator reduce to integer sums the compiler vectorizes
+        if ((i & 63) == 0 && i + 64 <= c->length && c->overflow[i >> 6] == 0) {
+            const int64_t* num = c->num + i;
+            const uint64_t* den = c->den + i;
+            uint64_t mismatch = 0;
+            for (size_t j = 0; j < 64; j++) mismatch |= den[j] ^ s.den;
+
+            if (mismatch == 0) {
+                int64_t high = 0;
+                int64_t low = 0;
+                for (size_t j = 0; j < 64; j++) {
+                    high += num[j] >> 32;
+                    low += (int64_t)(uint32_t)num[j];
+                }
+                df_i128 block = df_i128_from_magnitude((uint64_t)df_uabs64(high) >> 32,
+                                                       df_uabs64(high) << 32, high < 0);
+                if (!df_i128_add(&block, df_i128_from_i64(low)) || !df_i128_add(&s.acc, block)) {
+                    // Extremely large running sums: take the exact path
+                    for (size_t j = 0; j < 64; j++) df_sum_add_small(&s, num[j], den[j]);
+                }
+                nonnull += 64;
+                i += 64;
+                continue;
+            }
+        }
+
+        if (df_column_is_big(c, i)) {
+            df_sum_add_big(&s, c, i);
+            nonnull++;
+        } else if (c->den[i] != 0) {
+            df_sum_add_small(&s, c->num[i], c->den[i]);
+            nonnull++;
+        }
+        i++;
+    }
+
+    df_sum_flush(&s);
+    if (count) *count = nonnull;
+    return s.total ? s.total : df_zero();
+}
+
+DF_IMPL df_frac df_column_sum(df_column c) {
+    DF_ASSERT(c && "df_column_sum: column cannot be NULL");
+    DF_STAT(DF_STAT_COLUMN_SUM);
+    return df_column_sum_count(c, NULL);
+}
+
+DF_IMPL df_frac df_column_mean(df_column c) {
+    DF_ASSERT(c && "df_column_mean: column cannot be NULL");
+    DF_STAT(DF_STAT_COLUMN_MEAN);
+
+    size_t count;
+    df_frac sum = df_column_sum_count(c, &count);
+    if (count == 0) {
+        df_release(&sum);
+        return NULL;
+    }
+
+    di_int n = di_from_uint64((uint64_t)count);
+    di_int one = di_one();
+    df_frac divisor = df_from_di(n, one);
+    df_frac mean = df_div(sum, divisor);
+    di_release(&n);
+    di_release(&one);
+    df_release(&divisor);
+    df_release(&sum);
+    return mean;
+}
+
+// Helper: Exact comparison of inline values n1/d1 and n2/d2
+static int df_cmp_small(int64_t n1, uint64_t d1, int64_t n2, uint64_t d2) {
+    if (d1 == d2) return (n1 > n2) - (n1 < n2);
+    if ((n1 < 0) != (n2 < 0) || n1 == 0 || n2 == 0) return (n1 > n2) - (n1 < n2);
+
+    // Same sign: compare |n1| * d2 with |n2| * d1
+    uint64_t h1, l1, h2, l2;
+    df_umul128(df_uabs64(n1), d2, &h1, &l1);
+    df_umul128(df_uabs64(n2), d1, &h2, &l2);
+    int mag = h1 != h2 ? (h1 > h2 ? 1 : -1) : (l1 > l2) - (l1 < l2);
+    return n1 < 0 ? -mag : mag;
+}
+
+// Helper: Compare entries i and j, either of which may be in the side table
+static int df_column_cmp_entries(df_column c, size_t i, size_t j) {
+    if (!df_column_is_big(c, i) && !df_column_is_big(c, j)) {
+        return df_cmp_small(c->num[i], c->den[i], c->num[j], c->den[j]);
+    }
+    df_frac a = df_column_get(c, i);
+    df_frac b = df_column_get(c, j);
+    int result = df_cmp(a, b);
+    df_release(&a);
+    df_release(&b);
     return result;
 }
 
-// Division: (a/b) / (c/d) = ad / bc
-DF_IMPL df_frac df_div(df_frac a, df_frac b) {
-    DF_ASSERT(a && "df_div: dividend cannot be NULL");
-    DF_ASSERT(b && "df_div: divisor cannot be NULL");
-    DF_ASSERT(!df_is_zero(b) && "df_div: division by zero");
+// Helper: Index of the first extreme entry; want is -1 for min, 1 for max
+static size_t df_column_arg_extreme(df_column c, int want) {
+    size_t best = SIZE_MAX;
+
+    size_t i = 0;
+    while (i < c->length) {
+        // Blocks sharing the current best's inline denominator reduce to an
+        // integer min/max over the numerators
+        if (best != SIZE_MAX && (i & 63) == 0 && i + 64 <= c->length && c->overflow[i >> 6] == 0 &&
+            !df_column_is_big(c, best)) {
+            const int64_t* num = c->num + i;
+            const uint64_t* den = c->den + i;
+            uint64_t d = c->den[best];
+            uint64_t mismatch = 0;
+            int64_t extreme = num[0];
+            for (size_t j = 0; j < 64; j++) mismatch |= den[j] ^ d;
+
+            if (mismatch == 0) {
+                if (want < 0) {
+                    for (size_t j = 1; j < 64; j++) extreme = num[j] < extreme ? num[j] : extreme;
+                } else {
+                    for (size_t j = 1; j < 64; j++) extreme = num[j] > extreme ? num[j] : extreme;
+                }
+                int64_t current = c->num[best];
+                if (want < 0 ? extreme < current : extreme > current) {
+                    size_t j = 0;
+                    while (num[j] != extreme) j++;
+                    best = i + j;
+                }
+                i += 64;
+                continue;
+            }
+        }
 
-    di_int num = di_mul(a->numerator, b->denominator);
-    di_int den = di_mul(a->denominator, b->numerator);
+        if (!df_column_is_big(c, i) && c->den[i] == 0) {
+            i++;
+            continue;
+        }
+        if (best == SIZE_MAX || df_column_cmp_entries(c, i, best) == want) {
+            best = i;
+        }
+        i++;
+    }
+    return best;
+}
 
-    df_frac result = df_from_di(num, den);
+DF_IMPL size_t df_column_argmin(df_column c) {
+    DF_ASSERT(c && "df_column_argmin: column cannot be NULL");
+    DF_STAT(DF_STAT_COLUMN_ARGMIN);
+    return df_column_arg_extreme(c, -1);
+}
 
-    di_release(&num);
-    di_release(&den);
+DF_IMPL size_t df_column_argmax(df_column c) {
+    DF_ASSERT(c && "df_column_argmax: column cannot be NULL");
+    DF_STAT(DF_STAT_COLUMN_ARGMAX);
+    return df_column_arg_extreme(c, 1);
+}
+
+DF_IMPL df_frac df_column_min(df_column c) {
+    DF_ASSERT(c && "df_column_min: column cannot be NULL");
+    DF_STAT(DF_STAT_COLUMN_MIN);
+    size_t i = df_column_arg_extreme(c, -1);
+    return i == SIZE_MAX ? NULL : df_column_get(c, i);
+}
+
+DF_IMPL df_frac df_column_max(df_column c) {
+    DF_ASSERT(c && "df_column_max: column cannot be NULL");
+    DF_STAT(DF_STAT_COLUMN_MAX);
+    size_t i = df_column_arg_extreme(c, 1);
+    return i == SIZE_MAX ? NULL : df_column_get(c, i);
+}
+
+// ============================================================================
+// BULK REDUCTION IMPLEMENTATION
+// ============================================================================
 
+// Open-addressed table twice the bucket limit keeps probes short
+#define DF_SUM_TABLE (2 * DF_SUM_MAX_BUCKETS)
+
+// Numerators sharing one denominator: acc plus any spilled overflow
+typedef struct {
+    uint64_t den;        // 0 marks an empty slot
+    df_i128 acc;
+    di_int spill;
+} df_sum_bucket;
+
+// Helper: Balanced pairwise reduction of values[0..n), n >= 1
+static df_frac df_tree_reduce(const df_frac* values, size_t n, bool product) {
+    if (n == 1) return df_retain(values[0]);
+
+    size_t mid = n / 2;
+    df_frac left = df_tree_reduce(values, mid, product);
+    df_frac right = df_tree_reduce(values + mid, n - mid, product);
+    df_frac result = product ? df_mul(left, right) : df_add(left, right);
+    df_release(&left);
+    df_release(&right);
     return result;
 }
 
-// Negate
-DF_IMPL df_frac df_negate(df_frac f) {
-    DF_ASSERT(f && "df_negate: operand cannot be NULL");
+#ifdef DF_THREADS
 
-    di_int neg_num = di_negate(f->numerator);
-    di_int den = di_retain(f->denominator);
-    df_frac result = df_from_di(neg_num, den);
-    di_release(&neg_num);
-    di_release(&den);
+// Reference counts are not atomic, so every thread reduces private deep
+// copies of its terms; inputs are only ever read.
+static df_frac df_tree_reduce_private(const df_frac* values, size_t n, bool product) {
+    df_frac* copies = (df_frac*)DF_MALLOC(sizeof(df_frac) * n);
+    DF_ASSERT(copies && "df_tree_reduce_private: allocation failed");
+    for (size_t i = 0; i < n; i++) {
+        copies[i] = df_from_reduced(di_copy(values[i]->numerator), di_copy(values[i]->denominator));
+    }
+
+    df_frac result = df_tree_reduce(copies, n, product);
 
+    for (size_t i = 0; i < n; i++) df_release(&copies[i]);
+    DF_FREE(copies);
     return result;
 }
 
-// Absolute value
-DF_IMPL df_frac df_abs(df_frac f) {
-    DF_ASSERT(f && "df_abs: operand cannot be NULL");
+typedef struct {
+    const df_frac* values;
+    size_t n;
+    bool product;
+    int threads;
+    df_frac result;
+} df_tree_task;
+
+static df_frac df_tree_reduce_parallel(const df_frac* values, size_t n, bool product, int threads);
+
+static void* df_tree_task_run(void* arg) {
+    df_tree_task* task = (df_tree_task*)arg;
+    task->result = df_tree_reduce_parallel(task->values, task->n, task->product, task->threads);
+    return NULL;
+}
+
+// Helper: Same tree as df_tree_reduce, with the left half of each split
+// on a new thread until the thread budget is spent
+static df_frac df_tree_reduce_parallel(const df_frac* values, size_t n, bool product, int threads) {
+    if (threads < 2 || n < DF_PARALLEL_MIN) return df_tree_reduce_private(values, n, product);
+
+    size_t mid = n / 2;
+    df_tree_task task = {values, mid, product, threads / 2, NULL};
+    pthread_t thread;
+    bool spawned = pthread_create(&thread, NULL, df_tree_task_run, &task) == 0;
+    if (!spawned) df_tree_task_run(&task);
+
+    df_frac right = df_tree_reduce_parallel(values + mid, n - mid, product, threads - threads / 2);
+    if (spawned) pthread_join(thread, NULL);
+
+    df_frac result = product ? df_mul(task.result, right) : df_add(task.result, right);
+    df_release(&task.result);
+    df_release(&right);
+    return result;
+}
+
+#endif // DF_THREADS
+
+// Helper: Tree reduction, parallel when enabled and worthwhile
+static df_frac df_tree_reduce_threads(const df_frac* values, size_t n, bool product, int threads) {
+#ifdef DF_THREADS
+    if (threads >= 2 && n >= DF_PARALLEL_MIN) return df_tree_reduce_parallel(values, n, product, threads);
+#else
+    (void)threads;
+#endif
+    return df_tree_reduce(values, n, product);
+}
+
+// Helper: Find or claim the bucket for den; NULL when the table is full
+static df_sum_bucket* df_sum_bucket_for(df_sum_bucket* table, size_t* used, uint64_t den) {
+    size_t h = (size_t)((den * 0x9E3779B97F4A7C15ull) >> 32) % DF_SUM_TABLE;
+    while (table[h].den != 0 && table[h].den != den) h = (h + 1) % DF_SUM_TABLE;
+
+    if (table[h].den == 0) {
+        if (*used == DF_SUM_MAX_BUCKETS) return NULL;
+        table[h].den = den;
+        (*used)++;
+    }
+    return &table[h];
+}
+
+DF_IMPL df_frac df_sum(const df_frac* values, size_t n, int threads) {
+    DF_ASSERT((values || n == 0) && "df_sum: values cannot be NULL");
+    DF_STAT(DF_STAT_SUM);
+
+    df_sum_bucket table[DF_SUM_TABLE];
+    memset(table, 0, sizeof(table));
+    size_t used = 0;
+    df_sum_bucket* last = NULL;
+
+    // Terms that fit no bucket, summed by the general strategy
+    df_frac* general = NULL;
+    size_t general_count = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        df_frac f = values[i];
+        DF_ASSERT(f && "df_sum: values cannot contain NULL");
+
+        int64_t num;
+        uint64_t den;
+        df_sum_bucket* b = NULL;
+        if (di_to_int64(f->numerator, &num) && di_to_uint64(f->denominator, &den)) {
+            b = (last && last->den == den) ? last : df_sum_bucket_for(table, &used, den);
+        }
+        if (!b) {
+            if (!general) {
+                general = (df_frac*)DF_MALLOC(sizeof(df_frac) * (n - i));
+                DF_ASSERT(general && "df_sum: allocation failed");
+            }
+            general[general_count++] = f;
+            continue;
+        }
+        last = b;
+
+        if (!df_i128_add(&b->acc, df_i128_from_i64(num))) {
+            di_int part = df_i128_to_di(b->acc);
+            di_int spill = b->spill ? di_add(b->spill, part) : di_retain(part);
+            di_release(&b->spill);
+            di_release(&part);
+            b->spill = spill;
+            b->acc = df_i128_from_i64(num);
+        }
+    }
+
+    // One fraction per bucket, then one tree over buckets
+    df_frac parts[DF_SUM_MAX_BUCKETS];
+    size_t part_count = 0;
+    for (size_t h = 0; h < DF_SUM_TABLE; h++) {
+        df_sum_bucket* b = &table[h];
+        if (b->den == 0) continue;
+
+        di_int num = df_i128_to_di(b->acc);
+        if (b->spill) {
+            di_int with_spill = di_add(num, b->spill);
+            di_release(&num);
+            di_release(&b->spill);
+            num = with_spill;
+        }
+        di_int den = di_from_uint64(b->den);
+        parts[part_count++] = df_from_di(num, den);
+        di_release(&num);
+        di_release(&den);
+    }
+
+    df_frac total = NULL;
+    if (part_count > 0) {
+        total = df_tree_reduce(parts, part_count, false);
+        for (size_t i = 0; i < part_count; i++) df_release(&parts[i]);
+    }
+
+    if (general) {
+        df_total_add(&total, df_tree_reduce_threads(general, general_count, false, threads));
+        DF_FREE(general);
+    }
+
+    return total ? total : df_zero();
+}
+
+DF_IMPL df_frac df_prod(const df_frac* values, size_t n, int threads) {
+    DF_ASSERT((values || n == 0) && "df_prod: values cannot be NULL");
+    DF_STAT(DF_STAT_PROD);
+    if (n == 0) return df_one();
+
+    for (size_t i = 0; i < n; i++) {
+        DF_ASSERT(values[i] && "df_prod: values cannot contain NULL");
+        if (di_is_zero(values[i]->numerator)) return df_zero();
+    }
+    return df_tree_reduce_threads(values, n, true, threads);
+}
+
+// Helper: Move an inline-sized total back into acc / den, so a run of
+// small terms after a large one takes the integer path again
+static void df_sum_unflush(df_sum_state* s) {
+    int64_t num;
+    uint64_t den;
+    if (!s->total || s->acc.lo != 0 || s->acc.hi != 0) return;
+    if (!di_to_int64(s->total->numerator, &num) || !di_to_uint64(s->total->denominator, &den)) return;
+
+    df_release(&s->total);
+    df_sum_set_den(s, den);
+    s->acc = df_i128_from_i64(num);
+}
+
+// Helper: Running sums of in[0..n) continuing from offset (NULL for zero),
+// stored to out unless out is NULL; returns the total. With isolate set,
+// multi-word terms are deep-copied so no shared reference count is touched.
+static df_frac df_prefix_run(const df_frac* in, df_frac* out, size_t n, df_frac offset, bool isolate) {
+    df_sum_state s;
+    s.acc = df_i128_from_i64(0);
+    s.total = offset ? df_retain(offset) : NULL;
+    df_sum_set_den(&s, 1);
+    df_sum_unflush(&s);
+
+    for (size_t i = 0; i < n; i++) {
+        df_frac f = in[i];
+        DF_ASSERT(f && "df_prefix_sum: in cannot contain NULL");
+
+        int64_t num;
+        uint64_t den;
+        if (di_to_int64(f->numerator, &num) && di_to_uint64(f->denominator, &den)) {
+            df_sum_add_small(&s, num, den);
+        } else {
+            df_sum_flush(&s);
+            df_total_add(&s.total, isolate ? df_from_reduced(di_copy(f->numerator), di_copy(f->denominator))
+                                           : df_retain(f));
+        }
+
+        // Past 64-bit denominators the running value lives in total alone
+        if (s.total) {
+            df_sum_flush(&s);
+            df_sum_unflush(&s);
+        }
+        if (out) out[i] = s.total ? df_retain(s.total) : df_sum_value(&s);
+    }
+
+    df_sum_flush(&s);
+    return s.total ? s.total : df_sum_value(&s);
+}
+
+#ifdef DF_THREADS
+
+typedef struct {
+    const df_frac* in;
+    df_frac* out;
+    size_t n;
+    df_frac offset;
+    df_frac total;
+} df_prefix_task;
+
+static void* df_prefix_task_run(void* arg) {
+    df_prefix_task* task = (df_prefix_task*)arg;
+    task->total = df_prefix_run(task->in, task->out, task->n, task->offset, true);
+    return NULL;
+}
+
+// Helper: Run tasks[0..count), all but the first on new threads
+static void df_prefix_run_tasks(df_prefix_task* tasks, size_t count) {
+    pthread_t* handles = (pthread_t*)DF_MALLOC(sizeof(pthread_t) * count);
+    bool* spawned = (bool*)DF_MALLOC(sizeof(bool) * count);
+    DF_ASSERT(handles && spawned && "df_prefix_sum: allocation failed");
+
+    for (size_t b = 1; b < count; b++) {
+        spawned[b] = pthread_create(&handles[b], NULL, df_prefix_task_run, &tasks[b]) == 0;
+        if (!spawned[b]) df_prefix_task_run(&tasks[b]);
+    }
+    if (count > 0) df_prefix_task_run(&tasks[0]);
+    for (size_t b = 1; b < count; b++) {
+        if (spawned[b]) pthread_join(handles[b], NULL);
+    }
+
+    DF_FREE(handles);
+    DF_FREE(spawned);
+}
+
+// Helper: Two-pass scan over contiguous blocks: block totals in parallel,
+// a serial scan of the totals, then each block's running sums in parallel
+static void df_prefix_parallel(const df_frac* in, df_frac* out, size_t n, size_t blocks) {
+    df_prefix_task* tasks = (df_prefix_task*)DF_MALLOC(sizeof(df_prefix_task) * blocks);
+    DF_ASSERT(tasks && "df_prefix_sum: allocation failed");
+
+    for (size_t b = 0; b < blocks; b++) {
+        size_t lo = n * b / blocks;
+        size_t hi = n * (b + 1) / blocks;
+        df_prefix_task task = {in + lo, NULL, hi - lo, NULL, NULL};
+        tasks[b] = task;
+    }
+
+    // The last block's total is never needed
+    df_prefix_run_tasks(tasks, blocks - 1);
+
+    // Each block starts from a private copy of the total before it
+    df_frac running = NULL;
+    for (size_t b = 0; b < blocks; b++) {
+        if (running) {
+            tasks[b].offset = df_from_reduced(di_copy(running->numerator), di_copy(running->denominator));
+        }
+        if (tasks[b].total) df_total_add(&running, tasks[b].total);
+        tasks[b].out = out + n * b / blocks;
+        tasks[b].total = NULL;
+    }
+    df_release(&running);
 
-    di_int abs_num = di_abs(f->numerator);
-    di_int den = di_retain(f->denominator);
-    df_frac result = df_from_di(abs_num, den);
-    di_release(&abs_num);
-    di_release(&den);
+    df_prefix_run_tasks(tasks, blocks);
 
-    return result;
+    for (size_t b = 0; b < blocks; b++) {
+        df_release(&tasks[b].offset);
+        df_release(&tasks[b].total);
+    }
+    DF_FREE(tasks);
 }
 
-// Reciprocal
-DF_IMPL df_frac df_reciprocal(df_frac f) {
-    DF_ASSERT(f && "df_reciprocal: operand cannot be NULL");
-    DF_ASSERT(!df_is_zero(f) && "df_reciprocal: reciprocal of zero");
+#endif // DF_THREADS
 
-    di_int num = di_retain(f->denominator);
-    di_int den = di_retain(f->numerator);
-    df_frac result = df_from_di(num, den);
-    di_release(&num);
-    di_release(&den);
-    return result;
-}
+DF_IMPL void df_prefix_sum(const df_frac* in, df_frac* out, size_t n, int threads) {
+    DF_ASSERT((in || n == 0) && "df_prefix_sum: in cannot be NULL");
+    DF_ASSERT((out || n == 0) && "df_prefix_sum: out cannot be NULL");
+    DF_STAT(DF_STAT_PREFIX_SUM);
 
-// Compare two fractions
-DF_IMPL int df_cmp(df_frac a, df_frac b) {
-    DF_ASSERT(a && "df_cmp: first operand cannot be NULL");
-    DF_ASSERT(b && "df_cmp: second operand cannot be NULL");
+#ifdef DF_THREADS
+    size_t blocks = n / DF_PARALLEL_MIN;
+    if (threads >= 2 && blocks > (size_t)threads) blocks = (size_t)threads;
+    if (threads >= 2 && blocks >= 2) {
+        df_prefix_parallel(in, out, n, blocks);
+        return;
+    }
+#else
+    (void)threads;
+#endif
 
-    // Compare a/b with c/d by comparing ad with bc
-    di_int ad = di_mul(a->numerator, b->denominator);
-    di_int bc = di_mul(b->numerator, a->denominator);
+    df_frac total = df_prefix_run(in, out, n, NULL, false);
+    df_release(&total);
+}
 
-    int result = di_compare(ad, bc);
+// ============================================================================
+// FRACTION ARRAYS IMPLEMENTATION
+// ============================================================================
 
-    di_release(&ad);
-    di_release(&bc);
+#define DF_SCALE_CACHE 16
+
+// Helper: LCM of leaves[0..n), n >= 1, combined pairwise
+static di_int df_lcm_tree(const di_int* leaves, size_t n) {
+    if (n == 1) return di_retain(leaves[0]);
 
+    size_t mid = n / 2;
+    di_int left = df_lcm_tree(leaves, mid);
+    di_int right = df_lcm_tree(leaves + mid, n - mid);
+    di_int result = di_lcm(left, right);
+    di_release(&left);
+    di_release(&right);
     return result;
 }
 
-// Equality test
-DF_IMPL bool df_eq(df_frac a, df_frac b) {
-    return df_cmp(a, b) == 0;
-}
+// Helper: l / d, cached by denominator when d fits 64 bits
+static di_int df_lcm_scale(di_int l, di_int d, uint64_t* cache_den, di_int* cache_scale) {
+    uint64_t key;
+    if (!di_to_uint64(d, &key)) return di_div(l, d);
 
-// Inequality test
-DF_IMPL bool df_ne(df_frac a, df_frac b) {
-    return df_cmp(a, b) != 0;
+    size_t slot = (size_t)(key % DF_SCALE_CACHE);
+    if (cache_den[slot] != key) {
+        di_release(&cache_scale[slot]);
+        cache_scale[slot] = di_div(l, d);
+        cache_den[slot] = key;
+    }
+    return di_retain(cache_scale[slot]);
 }
 
-// Less than
-DF_IMPL bool df_lt(df_frac a, df_frac b) {
-    return df_cmp(a, b) < 0;
-}
+DF_IMPL void df_common_denominator(const df_frac* xs, size_t n, di_int* ints, di_int* den) {
+    DF_ASSERT((xs || n == 0) && "df_common_denominator: xs cannot be NULL");
+    DF_ASSERT((ints || n == 0) && "df_common_denominator: ints cannot be NULL");
+    DF_ASSERT(den && "df_common_denominator: den cannot be NULL");
+    DF_STAT(DF_STAT_COMMON_DENOMINATOR);
+
+    // Runs of 64-bit denominators fold into one partial LCM until it would
+    // overflow; wider denominators are partial LCMs of their own
+    di_int* leaves = (di_int*)DF_MALLOC(sizeof(di_int) * (n + 1));
+    DF_ASSERT(leaves && "df_common_denominator: allocation failed");
+    size_t leaf_count = 0;
+    uint64_t group = 1;
+    uint64_t last = 1;
+
+    for (size_t i = 0; i < n; i++) {
+        DF_ASSERT(xs[i] && "df_common_denominator: xs cannot contain NULL");
+
+        uint64_t d;
+        if (!di_to_uint64(xs[i]->denominator, &d)) {
+            leaves[leaf_count++] = di_retain(xs[i]->denominator);
+            continue;
+        }
+        if (d == last) continue;
+        last = d;
+
+        uint64_t grow = d / df_gcd_u64(group, d);
+        uint64_t hi, lcm;
+        df_umul128(group, grow, &hi, &lcm);
+        if (hi == 0) {
+            group = lcm;
+        } else {
+            leaves[leaf_count++] = di_from_uint64(group);
+            group = d;
+        }
+    }
+    if (group != 1 || leaf_count == 0) leaves[leaf_count++] = di_from_uint64(group);
+
+    di_int l = df_lcm_tree(leaves, leaf_count);
+    for (size_t i = 0; i < leaf_count; i++) di_release(&leaves[i]);
+    DF_FREE(leaves);
+
+    uint64_t small;
+    bool l_small = di_to_uint64(l, &small);
+    uint64_t cache_den[DF_SCALE_CACHE] = {0};
+    di_int cache_scale[DF_SCALE_CACHE] = {NULL};
+
+    for (size_t i = 0; i < n; i++) {
+        df_frac f = xs[i];
+        int64_t num;
+        uint64_t d;
+
+        // Every denominator divides l, so a 64-bit l means 64-bit scales
+        if (l_small && di_to_int64(f->numerator, &num)) {
+            di_to_uint64(f->denominator, &d);
+            ints[i] = df_i128_to_di(df_i128_mul_i64_u64(num, small / d));
+            continue;
+        }
 
-// Less than or equal
-DF_IMPL bool df_le(df_frac a, df_frac b) {
-    return df_cmp(a, b) <= 0;
-}
+        di_int scale = df_lcm_scale(l, f->denominator, cache_den, cache_scale);
+        ints[i] = di_mul(f->numerator, scale);
+        di_release(&scale);
+    }
 
-// Greater than
-DF_IMPL bool df_gt(df_frac a, df_frac b) {
-    return df_cmp(a, b) > 0;
+    for (size_t i = 0; i < DF_SCALE_CACHE; i++) di_release(&cache_scale[i]);
+    *den = l;
 }
 
-// Greater than or equal
-DF_IMPL bool df_ge(df_frac a, df_frac b) {
-    return df_cmp(a, b) >= 0;
-}
+DF_IMPL void df_from_common_denominator(const di_int* ints, size_t n, di_int den, df_frac* out) {
+    DF_ASSERT((ints || n == 0) && "df_from_common_denominator: ints cannot be NULL");
+    DF_ASSERT((out || n == 0) && "df_from_common_denominator: out cannot be NULL");
+    DF_ASSERT(den && di_is_positive(den) && "df_from_common_denominator: den must be positive");
+    DF_STAT(DF_STAT_FROM_COMMON_DENOMINATOR);
 
-// Test if zero
-DF_IMPL bool df_is_zero(df_frac f) {
-    DF_ASSERT(f && "df_is_zero: operand cannot be NULL");
-    return di_is_zero(f->numerator);
-}
+    uint64_t d;
+    bool small = di_to_uint64(den, &d);
 
-// Test if one
-DF_IMPL bool df_is_one(df_frac f) {
-    DF_ASSERT(f && "df_is_one: operand cannot be NULL");
-    return di_eq(f->numerator, f->denominator);
-}
+    for (size_t i = 0; i < n; i++) {
+        DF_ASSERT(ints[i] && "df_from_common_denominator: ints cannot contain NULL");
 
-// Test if negative
-DF_IMPL bool df_is_negative(df_frac f) {
-    DF_ASSERT(f && "df_is_negative: operand cannot be NULL");
-    return di_is_negative(f->numerator);
+        int64_t num;
+        if (small && di_to_int64(ints[i], &num)) {
+            uint64_t g = df_gcd_u64(df_uabs64(num), d);
+            df_i128 reduced = df_i128_from_magnitude(0, df_uabs64(num) / g, num < 0);
+            out[i] = df_from_reduced(df_i128_to_di(reduced), di_from_uint64(d / g));
+        } else {
+            out[i] = df_from_di(ints[i], den);
+        }
+    }
 }
 
-// Test if positive
-DF_IMPL bool df_is_positive(df_frac f) {
-    DF_ASSERT(f && "df_is_positive: operand cannot be NULL");
-    return !di_is_negative(f->numerator) && !di_is_zero(f->numerator);
+// Radix sort entry: order-preserving key of an approximation
+typedef struct {
+    uint64_t key;
+    size_t index;
+} df_sort_item;
+
+// Helper: Map a double to an unsigned key with the same order
+static inline uint64_t df_sort_key(double x) {
+    uint64_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    return (bits >> 63) ? ~bits : bits | ((uint64_t)1 << 63);
 }
 
-// Test if integer
-DF_IMPL bool df_is_integer(df_frac f) {
-    DF_ASSERT(f && "df_is_integer: operand cannot be NULL");
-    return di_is_one(f->denominator);
+// Helper: Interval certain to hold the value of f, from its cached
+// approximation (unbounded when the approximation is unusable)
+static void df_sort_bounds(df_frac f, double* lo, double* hi) {
+    df_approx(f);
+    if (isfinite(f->approx_err) && !isnan(f->approx)) {
+        *lo = f->approx - f->approx_err;
+        *hi = f->approx + f->approx_err;
+    } else {
+        *lo = -INFINITY;
+        *hi = INFINITY;
+    }
 }
 
-// Convert to double
-DF_IMPL double df_to_double(df_frac f) {
-    DF_ASSERT(f && "df_to_double: operand cannot be NULL");
+// Helper: Stable LSD radix sort of items by key, one byte per pass
+static void df_radix_sort(df_sort_item* items, df_sort_item* tmp, size_t n) {
+    df_sort_item* src = items;
+    df_sort_item* dst = tmp;
+
+    for (unsigned shift = 0; shift < 64; shift += 8) {
+        size_t count[256] = {0};
+        for (size_t i = 0; i < n; i++) count[(src[i].key >> shift) & 255]++;
+        if (count[(src[0].key >> shift) & 255] == n) continue;  // byte shared by all keys
+
+        size_t pos = 0;
+        for (size_t b = 0; b < 256; b++) {
+            size_t c = count[b];
+            count[b] = pos;
+            pos += c;
+        }
+        for (size_t i = 0; i < n; i++) dst[count[(src[i].key >> shift) & 255]++] = src[i];
 
-    double num = di_to_double(f->numerator);
-    double den = di_to_double(f->denominator);
+        df_sort_item* swap = src;
+        src = dst;
+        dst = swap;
+    }
 
-    return num / den;
+    if (src != items) memcpy(items, src, sizeof(df_sort_item) * n);
 }
 
-// Convert to int64 if possible
-DF_IMPL bool df_to_int64(df_frac f, int64_t* result) {
-    DF_ASSERT(f && "df_to_int64: fraction cannot be NULL");
-    DF_ASSERT(result && "df_to_int64: result pointer cannot be NULL");
-    if (!df_is_integer(f)) return false;
+// Helper: Stable merge sort of idx[0..n) by exact value
+static void df_sort_exact(const df_frac* xs, size_t* idx, size_t* tmp, size_t n) {
+    if (n <= 16) {
+        for (size_t i = 1; i < n; i++) {
+            size_t v = idx[i];
+            size_t j = i;
+            while (j > 0 && df_cmp(xs[idx[j - 1]], xs[v]) > 0) {
+                idx[j] = idx[j - 1];
+                j--;
+            }
+            idx[j] = v;
+        }
+        return;
+    }
 
-    return di_to_int64(f->numerator, result);
-}
+    size_t mid = n / 2;
+    df_sort_exact(xs, idx, tmp, mid);
+    df_sort_exact(xs, idx + mid, tmp, n - mid);
 
-// Convert to string
-DF_IMPL char* df_to_string(df_frac f) {
-    DF_ASSERT(f && "df_to_string: operand cannot be NULL");
+    size_t i = 0, j = mid, k = 0;
+    while (i < mid && j < n) tmp[k++] = df_cmp(xs[idx[j]], xs[idx[i]]) < 0 ? idx[j++] : idx[i++];
+    while (i < mid) tmp[k++] = idx[i++];
+    while (j < n) tmp[k++] = idx[j++];
+    memcpy(idx, tmp, sizeof(size_t) * n);
+}
 
-    char* num_str = di_to_string(f->numerator, 10);
-    DF_ASSERT(num_str && "df_to_string: numerator string conversion failed");
+// Helper: Stable ascending order of xs[0..n) into idx
+static void df_argsort_core(const df_frac* xs, size_t n, size_t* idx) {
+    for (size_t i = 0; i < n; i++) {
+        DF_ASSERT(xs[i] && "df_argsort: xs cannot contain NULL");
+        idx[i] = i;
+    }
+    if (n < 2) return;
 
-    // If integer, just return the numerator string
-    if (df_is_integer(f)) {
-        return num_str;
+    size_t* tmp = (size_t*)DF_MALLOC(sizeof(size_t) * n);
+    DF_ASSERT(tmp && "df_argsort: allocation failed");
+    if (n <= 16) {
+        df_sort_exact(xs, idx, tmp, n);
+        DF_FREE(tmp);
+        return;
     }
 
-    char* den_str = di_to_string(f->denominator, 10);
-    if (!den_str) {
-        free(num_str);
-        return NULL;
+    df_sort_item* items = (df_sort_item*)DF_MALLOC(sizeof(df_sort_item) * 2 * n);
+    double* lo = (double*)DF_MALLOC(sizeof(double) * 2 * n);
+    DF_ASSERT(items && lo && "df_argsort: allocation failed");
+    double* hi = lo + n;
+
+    for (size_t i = 0; i < n; i++) {
+        df_sort_bounds(xs[i], &lo[i], &hi[i]);
+        items[i].key = df_sort_key(xs[i]->approx);
+        items[i].index = i;
+    }
+    df_radix_sort(items, items + n, n);
+
+    // Suffix minima of the lower bounds in key order, kept in the radix
+    // scratch space. A cut before position p is safe when every value
+    // before it is certainly below every value from p on.
+    double* suffix = (double*)(items + n);
+    double low = INFINITY;
+    for (size_t p = n; p-- > 0;) {
+        double l = lo[items[p].index];
+        if (l < low) low = l;
+        suffix[p] = low;
     }
 
-    // Allocate space for "num/den"
-    size_t len = strlen(num_str) + strlen(den_str) + 2;
-    char* result = (char*)DF_MALLOC(len);
-    DF_ASSERT(result && "df_to_string: result allocation failed");
+    size_t start = 0;
+    double high = -INFINITY;
+    for (size_t p = 0; p < n; p++) {
+        idx[p] = items[p].index;
+        if (hi[idx[p]] > high) high = hi[idx[p]];
+        if (p + 1 == n || high < suffix[p + 1]) {
+            df_sort_exact(xs, idx + start, tmp, p + 1 - start);
+            start = p + 1;
+        }
+    }
 
-    snprintf(result, len, "%s/%s", num_str, den_str);
+    DF_FREE(items);
+    DF_FREE(lo);
+    DF_FREE(tmp);
+}
 
-    free(num_str);
-    free(den_str);
+// Helper: k-th smallest of a[0..n), reordering a
+static double df_select_double(double* a, size_t n, size_t k) {
+    ptrdiff_t left = 0;
+    ptrdiff_t right = (ptrdiff_t)n - 1;
+    ptrdiff_t target = (ptrdiff_t)k;
+
+    while (left < right) {
+        double x = a[left];
+        double y = a[left + (right - left) / 2];
+        double z = a[right];
+        double pivot = x < y ? (y < z ? y : (x < z ? z : x)) : (x < z ? x : (y < z ? z : y));
+
+        ptrdiff_t i = left;
+        ptrdiff_t j = right;
+        while (i <= j) {
+            while (a[i] < pivot) i++;
+            while (a[j] > pivot) j--;
+            if (i <= j) {
+                double t = a[i];
+                a[i++] = a[j];
+                a[j--] = t;
+            }
+        }
 
-    return result;
+        if (target <= j) {
+            right = j;
+        } else if (target >= i) {
+            left = i;
+        } else {
+            break;
+        }
+    }
+    return a[target];
 }
 
-// Parse from string
-DF_IMPL df_frac df_from_string(const char* str) {
-    DF_ASSERT(str && "df_from_string: string cannot be NULL");
+DF_IMPL void df_argsort(const df_frac* xs, size_t n, size_t* idx) {
+    DF_ASSERT((xs || n == 0) && "df_argsort: xs cannot be NULL");
+    DF_ASSERT((idx || n == 0) && "df_argsort: idx cannot be NULL");
+    DF_STAT(DF_STAT_ARGSORT);
+    df_argsort_core(xs, n, idx);
+}
 
-    // Look for '/' separator
-    const char* slash = strchr(str, '/');
+DF_IMPL void df_sort(df_frac* xs, size_t n) {
+    DF_ASSERT((xs || n == 0) && "df_sort: xs cannot be NULL");
+    DF_STAT(DF_STAT_SORT);
+    if (n < 2) return;
 
-    if (!slash) {
-        // No slash, parse as integer
-        di_int num = di_from_string(str, 10);
-        DF_ASSERT(num && "df_from_string: numerator parsing failed");
+    size_t* idx = (size_t*)DF_MALLOC(sizeof(size_t) * n);
+    df_frac* copy = (df_frac*)DF_MALLOC(sizeof(df_frac) * n);
+    DF_ASSERT(idx && copy && "df_sort: allocation failed");
 
-        di_int den = di_one();
-        df_frac result = df_from_di(num, den);
+    df_argsort_core(xs, n, idx);
+    memcpy(copy, xs, sizeof(df_frac) * n);
+    for (size_t i = 0; i < n; i++) xs[i] = copy[idx[i]];
 
-        di_release(&num);
-        di_release(&den);
+    DF_FREE(idx);
+    DF_FREE(copy);
+}
 
-        return result;
+DF_IMPL df_frac df_select_kth(const df_frac* xs, size_t n, size_t k) {
+    DF_ASSERT(xs && "df_select_kth: xs cannot be NULL");
+    DF_ASSERT(k < n && "df_select_kth: k out of range");
+    DF_STAT(DF_STAT_SELECT_KTH);
+
+    double* lo = (double*)DF_MALLOC(sizeof(double) * 3 * n);
+    DF_ASSERT(lo && "df_select_kth: allocation failed");
+    double* hi = lo + n;
+    double* scratch = hi + n;
+    for (size_t i = 0; i < n; i++) {
+        DF_ASSERT(xs[i] && "df_select_kth: xs cannot contain NULL");
+        df_sort_bounds(xs[i], &lo[i], &hi[i]);
     }
 
-    // Parse numerator and denominator
-    size_t num_len = slash - str;
-    char* num_str = (char*)DF_MALLOC(num_len + 1);
-    DF_ASSERT(num_str && "df_from_string: numerator string allocation failed");
+    // The value of rank k lies between the k-th smallest lower bound and
+    // the k-th smallest upper bound
+    memcpy(scratch, lo, sizeof(double) * n);
+    double a = df_select_double(scratch, n, k);
+    memcpy(scratch, hi, sizeof(double) * n);
+    double b = df_select_double(scratch, n, k);
+
+    df_frac* candidates = (df_frac*)DF_MALLOC(sizeof(df_frac) * n);
+    DF_ASSERT(candidates && "df_select_kth: allocation failed");
+    size_t count = 0;
+    size_t below = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (hi[i] < a) {
+            below++;
+        } else if (lo[i] <= b) {
+            candidates[count++] = xs[i];
+        }
+    }
+    DF_FREE(lo);
 
-    strncpy(num_str, str, num_len);
-    num_str[num_len] = '\0';
+    size_t* order = (size_t*)DF_MALLOC(sizeof(size_t) * count);
+    DF_ASSERT(order && "df_select_kth: allocation failed");
+    df_argsort_core(candidates, count, order);
+    df_frac result = df_retain(candidates[order[k - below]]);
 
-    di_int num = di_from_string(num_str, 10);
-    DF_FREE(num_str);
+    DF_FREE(order);
+    DF_FREE(candidates);
+    return result;
+}
 
-    DF_ASSERT(num && "df_from_string: numerator parsing failed");
+DF_IMPL df_frac df_median(const df_frac* xs, size_t n) {
+    DF_ASSERT(xs && n > 0 && "df_median: array cannot be empty");
+    DF_STAT(DF_STAT_MEDIAN);
+
+    df_frac upper = df_select_kth(xs, n, n / 2);
+    if (n % 2 == 1) return upper;
+
+    df_frac lower = df_select_kth(xs, n, n / 2 - 1);
+    df_frac sum = df_add(lower, upper);
+    df_frac two = df_from_int(2);
+    df_frac mean = df_div(sum, two);
+    df_release(&lower);
+    df_release(&upper);
+    df_release(&sum);
+    df_release(&two);
+    return mean;
+}
 
-    di_int den = di_from_string(slash + 1, 10);
-    DF_ASSERT(den && "df_from_string: denominator parsing failed");
-    DF_ASSERT(!di_is_zero(den) && "df_from_string: denominator cannot be zero");
+// Helper: Rewrite boundaries as integers over one 64-bit denominator;
+// false when the denominator or a scaled numerator would not fit
+static bool df_bucket_prepare(const df_frac* boundaries, size_t m, int64_t* scaled, uint64_t* den) {
+    uint64_t l = 1;
+    for (size_t j = 0; j < m; j++) {
+        DF_ASSERT(boundaries[j] && "df_bucketize: boundaries cannot contain NULL");
+
+        uint64_t d;
+        if (!di_to_uint64(boundaries[j]->denominator, &d)) return false;
+        uint64_t hi, lcm;
+        df_umul128(l, d / df_gcd_u64(l, d), &hi, &lcm);
+        if (hi != 0) return false;
+        l = lcm;
+    }
 
-    df_frac result = df_from_di(num, den);
+    for (size_t j = 0; j < m; j++) {
+        int64_t num;
+        uint64_t d;
+        if (!di_to_int64(boundaries[j]->numerator, &num)) return false;
+        di_to_uint64(boundaries[j]->denominator, &d);
 
-    di_release(&num);
-    di_release(&den);
+        // INT64_MIN is kept free as the key of values below every boundary
+        df_i128 v = df_i128_mul_i64_u64(num, l / d);
+        if (v.hi != ((int64_t)v.lo >> 63) || (int64_t)v.lo == INT64_MIN) return false;
+        scaled[j] = (int64_t)v.lo;
+    }
 
-    return result;
+    *den = l;
+    return true;
 }
 
-// Get numerator
-DF_IMPL di_int df_numerator(df_frac f) {
-    DF_ASSERT(f && "df_numerator: operand cannot be NULL");
-    return di_retain(f->numerator);
-}
+// Helper: floor(num * den / d), saturated to the int64_t range
+static int64_t df_bucket_key(int64_t num, uint64_t d, uint64_t den) {
+    uint64_t hi, lo, rem;
+    df_umul128(df_uabs64(num), den, &hi, &lo);
+    if (hi >= d) return num < 0 ? INT64_MIN : INT64_MAX;
 
-// Get denominator
-DF_IMPL di_int df_denominator(df_frac f) {
-    DF_ASSERT(f && "df_denominator: operand cannot be NULL");
-    return di_retain(f->denominator);
+    uint64_t q = df_udiv128(hi, lo, d, &rem);
+    if (num >= 0) return q > (uint64_t)INT64_MAX ? INT64_MAX : (int64_t)q;
+    if (q > (uint64_t)INT64_MAX - (rem != 0)) return INT64_MIN;
+    return -(int64_t)(q + (rem != 0));
 }
 
-// Create zero
-DF_IMPL df_frac df_zero(void) {
-    return df_from_ints(0, 1);
+// Helper: Number of boundaries <= f, by exact comparison
+static size_t df_bucket_search(df_frac f, const df_frac* boundaries, size_t m) {
+    size_t lo = 0, hi = m;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (df_cmp(boundaries[mid], f) <= 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
 }
 
-// Create one
-DF_IMPL df_frac df_one(void) {
-    return df_from_ints(1, 1);
+DF_IMPL void df_bucketize(const df_frac* values, size_t n, const df_frac* boundaries, size_t m, size_t* out_idx) {
+    DF_ASSERT((values || n == 0) && "df_bucketize: values cannot be NULL");
+    DF_ASSERT((boundaries || m == 0) && "df_bucketize: boundaries cannot be NULL");
+    DF_ASSERT((out_idx || n == 0) && "df_bucketize: out_idx cannot be NULL");
+    DF_STAT(DF_STAT_BUCKETIZE);
+
+    int64_t* scaled = m > 0 ? (int64_t*)DF_MALLOC(sizeof(int64_t) * m) : NULL;
+    DF_ASSERT((scaled || m == 0) && "df_bucketize: allocation failed");
+    uint64_t den = 1;
+    bool fast = df_bucket_prepare(boundaries, m, scaled, &den);
+
+    for (size_t i = 0; i < n; i++) {
+        df_frac f = values[i];
+        DF_ASSERT(f && "df_bucketize: values cannot contain NULL");
+
+        int64_t num;
+        uint64_t d;
+        if (!fast || !di_to_int64(f->numerator, &num) || !di_to_uint64(f->denominator, &d)) {
+            out_idx[i] = df_bucket_search(f, boundaries, m);
+            continue;
+        }
+
+        // Against integer boundaries B, x >= B exactly when floor(x) >= B
+        int64_t key = df_bucket_key(num, d, den);
+        size_t lo = 0, hi = m;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (scaled[mid] <= key) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        out_idx[i] = lo;
+    }
+
+    DF_FREE(scaled);
 }
 
-// Create negative one
-DF_IMPL df_frac df_neg_one(void) {
-    return df_from_ints(-1, 1);
+DF_IMPL void df_bucket_sum(const df_frac* values, size_t n, const df_frac* boundaries, size_t m, df_frac* sums) {
+    DF_ASSERT(sums && "df_bucket_sum: sums cannot be NULL");
+    DF_STAT(DF_STAT_BUCKET_SUM);
+
+    size_t* idx = (size_t*)DF_MALLOC(sizeof(size_t) * (n + 1));
+    size_t* start = (size_t*)DF_MALLOC(sizeof(size_t) * (m + 2));
+    df_frac* grouped = (df_frac*)DF_MALLOC(sizeof(df_frac) * (n + 1));
+    DF_ASSERT(idx && start && grouped && "df_bucket_sum: allocation failed");
+
+    df_bucketize(values, n, boundaries, m, idx);
+
+    // Counting sort by bucket, then one df_sum per bucket
+    memset(start, 0, sizeof(size_t) * (m + 2));
+    for (size_t i = 0; i < n; i++) start[idx[i] + 1]++;
+    for (size_t b = 0; b <= m; b++) start[b + 1] += start[b];
+    for (size_t i = 0; i < n; i++) grouped[start[idx[i]]++] = values[i];
+
+    size_t begin = 0;
+    for (size_t b = 0; b <= m; b++) {
+        sums[b] = df_sum(grouped + begin, start[b] - begin, 1);
+        begin = start[b];
+    }
+
+    DF_FREE(idx);
+    DF_FREE(start);
+    DF_FREE(grouped);
 }
 
 // ============================================================================
-// Extended Functions Implementation
+// HASH MAP IMPLEMENTATION
 // ============================================================================
 
-// Power function
-DF_IMPL df_frac df_pow(df_frac base, int64_t exponent) {
-    DF_ASSERT(base && "df_pow: base cannot be NULL");
+#define DF_MAP_MIN_CAPACITY 16
 
-    if (exponent == 0) {
-        return df_one();
-    }
+// Helper: Key part of an entry for f (value left unset, big borrowed)
+static df_map_entry df_map_key_of(df_frac f) {
+    df_map_entry key;
+    key.hash = df_hash_parts(f, &key.num, &key.den);
+    key.big = key.den == 0 ? f : NULL;
+    key.value = NULL;
+    return key;
+}
 
-    if (exponent == 1) {
-        return df_copy(base);
-    }
+// Helper: Structural key equality, with no allocation
+static inline bool df_map_key_eq(const df_map_entry* e, const df_map_entry* key) {
+    if (e->hash != key->hash || e->den != key->den) return false;
+    if (key->den != 0) return e->num == key->num;
+    return di_eq(e->big->numerator, key->big->numerator) && di_eq(e->big->denominator, key->big->denominator);
+}
 
-    if (df_is_zero(base)) {
-        DF_ASSERT(exponent > 0 && "df_pow: zero to negative power is undefined");
-        return df_zero();
+// Helper: Slot holding key, or SIZE_MAX
+static size_t df_map_find(df_map m, const df_map_entry* key) {
+    if (m->capacity == 0) return SIZE_MAX;
+
+    size_t mask = m->capacity - 1;
+    size_t i = (size_t)key->hash & mask;
+    for (size_t dist = 0;; dist++, i = (i + 1) & mask) {
+        const df_map_entry* e = &m->entries[i];
+        // Robin Hood order: a closer-to-home entry means the key is absent
+        if (e->hash == 0 || ((i - (size_t)e->hash) & mask) < dist) return SIZE_MAX;
+        if (df_map_key_eq(e, key)) return i;
     }
+}
 
-    // Handle negative exponents
-    if (exponent < 0) {
-        df_frac reciprocal = df_reciprocal(base);
-        df_frac result = df_pow(reciprocal, -exponent);
-        df_release(&reciprocal);
-        return result;
+// Helper: Place an entry known to be absent; returns its slot
+static size_t df_map_place(df_map m, df_map_entry entry) {
+    size_t mask = m->capacity - 1;
+    size_t i = (size_t)entry.hash & mask;
+    size_t placed = SIZE_MAX;
+
+    for (size_t dist = 0;; dist++, i = (i + 1) & mask) {
+        df_map_entry* e = &m->entries[i];
+        if (e->hash == 0) {
+            *e = entry;
+            return placed == SIZE_MAX ? i : placed;
+        }
+
+        // Take the slot from an entry closer to its home and carry it on
+        size_t d = (i - (size_t)e->hash) & mask;
+        if (d < dist) {
+            df_map_entry displaced = *e;
+            *e = entry;
+            entry = displaced;
+            if (placed == SIZE_MAX) placed = i;
+            dist = d;
+        }
     }
+}
 
-    // Positive integer exponent - use exponentiation by squaring
-    df_frac result = df_one();
-    df_frac current_base = df_copy(base);
+// Helper: Make room for one more key (load factor at most 7/8)
+static void df_map_reserve_one(df_map m) {
+    if ((m->size + 1) * 8 <= m->capacity * 7) return;
 
-    while (exponent > 0) {
-        if (exponent & 1) {  // If exponent is odd
-            df_frac new_result = df_mul(result, current_base);
-            df_release(&result);
-            result = new_result;
-        }
-        exponent >>= 1;
-        if (exponent > 0) {
-            df_frac new_base = df_mul(current_base, current_base);
-            df_release(&current_base);
-            current_base = new_base;
-        }
+    df_map_entry* old = m->entries;
+    size_t old_capacity = m->capacity;
+    m->capacity = old_capacity ? old_capacity * 2 : DF_MAP_MIN_CAPACITY;
+    m->entries = (df_map_entry*)DF_MALLOC(sizeof(df_map_entry) * m->capacity);
+    DF_ASSERT(m->entries && "df_map: allocation failed");
+    memset(m->entries, 0, sizeof(df_map_entry) * m->capacity);
+
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (old[i].hash != 0) df_map_place(m, old[i]);
+    }
+    DF_FREE(old);
+}
+
+DF_IMPL df_map df_map_new(void) {
+    DF_STAT(DF_STAT_MAP_NEW);
+    df_map m = (df_map)DF_MALLOC(sizeof(struct df_map_internal));
+    DF_ASSERT(m && "df_map_new: allocation failed");
+    memset(m, 0, sizeof(*m));
+    m->ref_count = 1;
+    return m;
+}
+
+DF_IMPL df_map df_map_retain(df_map m) {
+    DF_ASSERT(m && "df_map_retain: map cannot be NULL");
+    DF_STAT(DF_STAT_MAP_RETAIN);
+    m->ref_count++;
+    return m;
+}
+
+DF_IMPL void df_map_release(df_map* m) {
+    DF_STAT(DF_STAT_MAP_RELEASE);
+    if (!m || !*m) return;
+
+    df_map map = *m;
+    DF_ASSERT(map->ref_count > 0 && "df_map_release: invalid reference count");
+    if (--map->ref_count == 0) {
+        for (size_t i = 0; i < map->capacity; i++) df_release(&map->entries[i].big);
+        DF_FREE(map->entries);
+        DF_FREE(map);
     }
+    *m = NULL;
+}
 
-    df_release(&current_base);
-    return result;
+DF_IMPL size_t df_map_size(df_map m) {
+    DF_ASSERT(m && "df_map_size: map cannot be NULL");
+    DF_STAT(DF_STAT_MAP_SIZE);
+    return m->size;
 }
 
-// Floor function
-DF_IMPL df_frac df_floor(df_frac f) {
-    DF_ASSERT(f && "df_floor: operand cannot be NULL");
+DF_IMPL bool df_map_get(df_map m, df_frac key, void** value) {
+    DF_ASSERT(m && "df_map_get: map cannot be NULL");
+    DF_ASSERT(key && "df_map_get: key cannot be NULL");
+    DF_STAT(DF_STAT_MAP_GET);
 
-    if (df_is_integer(f)) {
-        return df_copy(f);
+    df_map_entry k = df_map_key_of(key);
+    size_t i = df_map_find(m, &k);
+    if (i == SIZE_MAX) return false;
+    if (value) *value = m->entries[i].value;
+    return true;
+}
+
+DF_IMPL bool df_map_get_ints(df_map m, int64_t num, int64_t den, void** value) {
+    DF_ASSERT(m && "df_map_get_ints: map cannot be NULL");
+    DF_ASSERT(den != 0 && "df_map_get_ints: denominator cannot be zero");
+    DF_STAT(DF_STAT_MAP_GET_INTS);
+
+    bool negative = (num < 0) != (den < 0) && num != 0;
+    uint64_t n = df_uabs64(num);
+    uint64_t d = df_uabs64(den);
+    uint64_t g = df_gcd_u64(n, d);
+    n /= g;
+    d /= g;
+
+    // Only a reduced numerator of 2^63 misses the inline form
+    if (n > (uint64_t)INT64_MAX && !negative) {
+        df_frac f = df_from_ints(num, den);
+        bool found = df_map_get(m, f, value);
+        df_release(&f);
+        return found;
     }
 
-    // di_div already performs floor division (rounds toward negative infinity)
-    di_int quotient = di_div(f->numerator, f->denominator);
+    df_map_entry k;
+    k.num = negative ? (int64_t)((uint64_t)0 - n) : (int64_t)n;
+    k.den = d;
+    k.hash = df_hash_small(k.num, k.den);
+    k.big = NULL;
 
-    di_int one = di_one();
-    df_frac result = df_from_di(quotient, one);
-    di_release(&quotient);
-    di_release(&one);
-    return result;
+    size_t i = df_map_find(m, &k);
+    if (i == SIZE_MAX) return false;
+    if (value) *value = m->entries[i].value;
+    return true;
 }
 
-// Ceiling function
-DF_IMPL df_frac df_ceil(df_frac f) {
-    DF_ASSERT(f && "df_ceil: operand cannot be NULL");
+DF_IMPL void** df_map_slot(df_map m, df_frac key, bool* inserted) {
+    DF_ASSERT(m && "df_map_slot: map cannot be NULL");
+    DF_ASSERT(key && "df_map_slot: key cannot be NULL");
+    DF_STAT(DF_STAT_MAP_SLOT);
 
-    if (df_is_integer(f)) {
-        return df_copy(f);
-    }
+    df_map_entry k = df_map_key_of(key);
+    size_t i = df_map_find(m, &k);
+    if (inserted) *inserted = i == SIZE_MAX;
+    if (i != SIZE_MAX) return &m->entries[i].value;
 
-    // Get integer part (floor)
-    di_int quotient = di_div(f->numerator, f->denominator);
+    df_map_reserve_one(m);
+    if (k.big) k.big = df_retain(k.big);
+    m->size++;
+    return &m->entries[df_map_place(m, k)].value;
+}
 
-    // For non-integers, ceiling is always floor + 1
-    di_int one = di_one();
-    di_int adjusted = di_add(quotient, one);
-    di_release(&quotient);
+DF_IMPL void df_map_put(df_map m, df_frac key, void* value) {
+    DF_ASSERT(m && "df_map_put: map cannot be NULL");
+    DF_STAT(DF_STAT_MAP_PUT);
+    *df_map_slot(m, key, NULL) = value;
+}
 
-    df_frac result = df_from_di(adjusted, one);
-    di_release(&adjusted);
-    di_release(&one);
-    return result;
+DF_IMPL bool df_map_remove(df_map m, df_frac key, void** value) {
+    DF_ASSERT(m && "df_map_remove: map cannot be NULL");
+    DF_ASSERT(key && "df_map_remove: key cannot be NULL");
+    DF_STAT(DF_STAT_MAP_REMOVE);
+
+    df_map_entry k = df_map_key_of(key);
+    size_t i = df_map_find(m, &k);
+    if (i == SIZE_MAX) return false;
+
+    if (value) *value = m->entries[i].value;
+    df_release(&m->entries[i].big);
+    m->size--;
+
+    // Backward shift: pull each displaced follower one slot nearer home
+    size_t mask = m->capacity - 1;
+    for (;;) {
+        size_t next = (i + 1) & mask;
+        df_map_entry* e = &m->entries[next];
+        if (e->hash == 0 || ((next - (size_t)e->hash) & mask) == 0) break;
+        m->entries[i] = *e;
+        i = next;
+    }
+    memset(&m->entries[i], 0, sizeof(df_map_entry));
+    return true;
 }
 
-// Truncate function
-DF_IMPL df_frac df_trunc(df_frac f) {
-    DF_ASSERT(f && "df_trunc: operand cannot be NULL");
+DF_IMPL bool df_map_next(df_map m, size_t* iter, df_frac* key, void** value) {
+    DF_ASSERT(m && "df_map_next: map cannot be NULL");
+    DF_ASSERT(iter && "df_map_next: iter cannot be NULL");
+    DF_STAT(DF_STAT_MAP_NEXT);
 
-    if (df_is_integer(f)) {
-        return df_copy(f);
+    while (*iter < m->capacity) {
+        const df_map_entry* e = &m->entries[(*iter)++];
+        if (e->hash == 0) continue;
+
+        if (key) {
+            *key = e->big ? df_retain(e->big) : df_from_reduced(di_from_int64(e->num), di_from_uint64(e->den));
+        }
+        if (value) *value = e->value;
+        return true;
     }
+    return false;
+}
 
-    // Truncate toward zero - same as whole_part
-    di_int whole_int = df_whole_part(f);
-    di_int one = di_one();
-    df_frac result = df_from_di(whole_int, one);
-    di_release(&whole_int);
-    di_release(&one);
-    return result;
+// ============================================================================
+// ORDERED CONTAINERS IMPLEMENTATION
+// ============================================================================
+
+// Helper: Compare keys through their cached intervals, exactly only when
+// the intervals overlap
+static inline int df_bounded_cmp(double alo, double ahi, df_frac a, double blo, double bhi, df_frac b) {
+    if (ahi < blo) return -1;
+    if (alo > bhi) return 1;
+    return a == b ? 0 : df_cmp(a, b);
 }
 
-// Round function
-DF_IMPL df_frac df_round(df_frac f) {
-    DF_ASSERT(f && "df_round: operand cannot be NULL");
+// Helper: Heap order, ties broken by sequence number
+static inline bool df_heap_less(const df_heap_node* a, const df_heap_node* b) {
+    int c = df_bounded_cmp(a->lo, a->hi, a->key, b->lo, b->hi, b->key);
+    return c < 0 || (c == 0 && a->seq < b->seq);
+}
 
-    if (df_is_integer(f)) {
-        return df_copy(f);
+// Helper: Store a node at heap index i and record its position
+static inline void df_heap_set(df_heap h, size_t i, df_heap_node node) {
+    h->nodes[i] = node;
+    h->position[node.handle] = i;
+}
+
+// Helper: Move the node at i toward the root until ordered
+static void df_heap_sift_up(df_heap h, size_t i) {
+    df_heap_node node = h->nodes[i];
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!df_heap_less(&node, &h->nodes[parent])) break;
+        df_heap_set(h, i, h->nodes[parent]);
+        i = parent;
     }
+    df_heap_set(h, i, node);
+}
 
-    // Round to nearest integer, ties to even (banker's rounding)
-    df_frac half = df_from_ints(1, 2);
-    df_frac abs_frac_part = df_abs(df_fractional_part(f));
+// Helper: Move the node at i toward the leaves until ordered
+static void df_heap_sift_down(df_heap h, size_t i) {
+    df_heap_node node = h->nodes[i];
+    for (;;) {
+        size_t child = 2 * i + 1;
+        if (child >= h->size) break;
+        if (child + 1 < h->size && df_heap_less(&h->nodes[child + 1], &h->nodes[child])) child++;
+        if (!df_heap_less(&h->nodes[child], &node)) break;
+        df_heap_set(h, i, h->nodes[child]);
+        i = child;
+    }
+    df_heap_set(h, i, node);
+}
 
-    // Check if fractional part is exactly 0.5
-    if (df_eq(abs_frac_part, half)) {
-        // Tie case - round to even
-        di_int whole_part = df_whole_part(f);
-        di_int one_den = di_one();
-        df_frac whole_frac = df_from_di(whole_part, one_den);
-        di_release(&whole_part);
-        di_release(&one_den);
+// Helper: Take the node at heap index i out of the heap
+static df_heap_node df_heap_take(df_heap h, size_t i) {
+    df_heap_node node = h->nodes[i];
+    h->position[node.handle] = SIZE_MAX;
+    h->free_handles[h->free_count++] = node.handle;
+
+    h->size--;
+    if (i < h->size) {
+        size_t moved = h->nodes[h->size].handle;
+        df_heap_set(h, i, h->nodes[h->size]);
+        df_heap_sift_down(h, i);
+        df_heap_sift_up(h, h->position[moved]);
+    }
+    return node;
+}
 
-        // Check if whole part is even
-        di_int whole = df_whole_part(f);
-        int64_t whole_val;
-        di_to_int64(whole, &whole_val);
+DF_IMPL df_heap df_heap_new(void) {
+    DF_STAT(DF_STAT_HEAP_NEW);
+    df_heap h = (df_heap)DF_MALLOC(sizeof(struct df_heap_internal));
+    DF_ASSERT(h && "df_heap_new: allocation failed");
+    memset(h, 0, sizeof(*h));
+    h->ref_count = 1;
+    return h;
+}
 
-        if (whole_val % 2 == 0) {
-            // Already even, return whole part
-            df_release(&half);
-            df_release(&abs_frac_part);
-            di_release(&whole);
-            return whole_frac;
-        } else {
-            // Odd, round to next even number
-            di_int one = di_one();
-            di_int adjusted_whole;
+DF_IMPL df_heap df_heap_retain(df_heap h) {
+    DF_ASSERT(h && "df_heap_retain: heap cannot be NULL");
+    DF_STAT(DF_STAT_HEAP_RETAIN);
+    h->ref_count++;
+    return h;
+}
 
-            if (df_is_negative(f)) {
-                adjusted_whole = di_sub(whole, one);
-            } else {
-                adjusted_whole = di_add(whole, one);
-            }
+DF_IMPL void df_heap_release(df_heap* h) {
+    DF_STAT(DF_STAT_HEAP_RELEASE);
+    if (!h || !*h) return;
+
+    df_heap heap = *h;
+    DF_ASSERT(heap->ref_count > 0 && "df_heap_release: invalid reference count");
+    if (--heap->ref_count == 0) {
+        for (size_t i = 0; i < heap->size; i++) df_release(&heap->nodes[i].key);
+        DF_FREE(heap->nodes);
+        DF_FREE(heap->position);
+        DF_FREE(heap->free_handles);
+        DF_FREE(heap);
+    }
+    *h = NULL;
+}
 
-            di_int one_den = di_one();
-            df_frac result = df_from_di(adjusted_whole, one_den);
-            di_release(&one_den);
+DF_IMPL size_t df_heap_size(df_heap h) {
+    DF_ASSERT(h && "df_heap_size: heap cannot be NULL");
+    DF_STAT(DF_STAT_HEAP_SIZE);
+    return h->size;
+}
 
-            df_release(&half);
-            df_release(&abs_frac_part);
-            df_release(&whole_frac);
-            di_release(&whole);
-            di_release(&one);
-            di_release(&adjusted_whole);
-            return result;
-        }
+DF_IMPL size_t df_heap_push(df_heap h, df_frac key, void* value) {
+    DF_ASSERT(h && "df_heap_push: heap cannot be NULL");
+    DF_ASSERT(key && "df_heap_push: key cannot be NULL");
+    DF_STAT(DF_STAT_HEAP_PUSH);
+
+    if (h->size == h->capacity) {
+        // A new handle is only minted when none is free, so handles never
+        // outnumber node slots
+        size_t capacity = h->capacity ? h->capacity * 2 : 16;
+        df_heap_node* nodes = (df_heap_node*)DF_REALLOC(h->nodes, sizeof(df_heap_node) * capacity);
+        size_t* position = (size_t*)DF_REALLOC(h->position, sizeof(size_t) * capacity);
+        size_t* free_handles = (size_t*)DF_REALLOC(h->free_handles, sizeof(size_t) * capacity);
+        DF_ASSERT(nodes && position && free_handles && "df_heap_push: allocation failed");
+        h->nodes = nodes;
+        h->position = position;
+        h->free_handles = free_handles;
+        h->capacity = capacity;
+    }
+    if (h->free_count == 0) h->free_handles[h->free_count++] = h->handle_capacity++;
+
+    df_heap_node node;
+    df_sort_bounds(key, &node.lo, &node.hi);
+    node.key = df_retain(key);
+    node.value = value;
+    node.seq = h->next_seq++;
+    node.handle = h->free_handles[--h->free_count];
+
+    df_heap_set(h, h->size++, node);
+    df_heap_sift_up(h, h->size - 1);
+    return node.handle;
+}
+
+DF_IMPL bool df_heap_peek(df_heap h, df_frac* key, void** value) {
+    DF_ASSERT(h && "df_heap_peek: heap cannot be NULL");
+    DF_STAT(DF_STAT_HEAP_PEEK);
+    if (h->size == 0) return false;
+
+    if (key) *key = df_retain(h->nodes[0].key);
+    if (value) *value = h->nodes[0].value;
+    return true;
+}
+
+DF_IMPL bool df_heap_pop(df_heap h, df_frac* key, void** value) {
+    DF_ASSERT(h && "df_heap_pop: heap cannot be NULL");
+    DF_STAT(DF_STAT_HEAP_POP);
+    if (h->size == 0) return false;
+
+    df_heap_node node = df_heap_take(h, 0);
+    if (key) {
+        *key = node.key;
     } else {
-        // Normal rounding - not a tie
-        df_frac signed_half;
-        if (df_is_negative(f)) {
-            signed_half = df_negate(half);
-        } else {
-            signed_half = df_copy(half);
-        }
+        df_release(&node.key);
+    }
+    if (value) *value = node.value;
+    return true;
+}
 
-        df_frac adjusted = df_add(f, signed_half);
-        df_frac result = df_trunc(adjusted);
+DF_IMPL void df_heap_update(df_heap h, size_t handle, df_frac key) {
+    DF_ASSERT(h && "df_heap_update: heap cannot be NULL");
+    DF_ASSERT(key && "df_heap_update: key cannot be NULL");
+    DF_ASSERT(handle < h->handle_capacity && h->position[handle] != SIZE_MAX &&
+              "df_heap_update: handle is not in the heap");
+    DF_STAT(DF_STAT_HEAP_UPDATE);
+
+    size_t i = h->position[handle];
+    df_heap_node* node = &h->nodes[i];
+    df_frac old = node->key;
+    df_sort_bounds(key, &node->lo, &node->hi);
+    node->key = df_retain(key);
+    node->seq = h->next_seq++;
+    df_release(&old);
+
+    df_heap_sift_up(h, i);
+    df_heap_sift_down(h, h->position[handle]);
+}
 
-        df_release(&half);
-        df_release(&abs_frac_part);
-        df_release(&signed_half);
-        df_release(&adjusted);
-        return result;
+DF_IMPL bool df_heap_remove(df_heap h, size_t handle, df_frac* key, void** value) {
+    DF_ASSERT(h && "df_heap_remove: heap cannot be NULL");
+    DF_STAT(DF_STAT_HEAP_REMOVE);
+    if (handle >= h->handle_capacity || h->position[handle] == SIZE_MAX) return false;
+
+    df_heap_node node = df_heap_take(h, h->position[handle]);
+    if (key) {
+        *key = node.key;
+    } else {
+        df_release(&node.key);
     }
+    if (value) *value = node.value;
+    return true;
 }
 
-// Sign function
-DF_IMPL int df_sign(df_frac f) {
-    DF_ASSERT(f && "df_sign: operand cannot be NULL");
+#define DF_ORDMAP_T 16  // Minimum degree: nodes hold T-1 to 2T-1 keys
+
+// Ordered map entry with the cached interval of its key
+typedef struct {
+    double lo;
+    double hi;
+    df_frac key;
+    void* value;
+} df_ordmap_entry;
+
+struct df_ordmap_node {
+    size_t count;
+    bool leaf;
+    df_ordmap_entry entries[2 * DF_ORDMAP_T - 1];
+    struct df_ordmap_node* children[2 * DF_ORDMAP_T];
+};
 
-    if (df_is_zero(f)) return 0;
-    if (df_is_negative(f)) return -1;
-    return 1;
+typedef struct df_ordmap_node df_ordmap_node;
+
+// Helper: Allocate an empty node
+static df_ordmap_node* df_ordmap_node_new(bool leaf) {
+    df_ordmap_node* node = (df_ordmap_node*)DF_MALLOC(sizeof(df_ordmap_node));
+    DF_ASSERT(node && "df_ordmap: allocation failed");
+    node->count = 0;
+    node->leaf = leaf;
+    return node;
 }
 
-// Min function
-DF_IMPL df_frac df_min(df_frac a, df_frac b) {
-    DF_ASSERT(a && "df_min: first operand cannot be NULL");
-    DF_ASSERT(b && "df_min: second operand cannot be NULL");
+// Helper: Free a subtree, releasing its keys
+static void df_ordmap_node_free(df_ordmap_node* node) {
+    if (!node) return;
+    for (size_t i = 0; i < node->count; i++) df_release(&node->entries[i].key);
+    if (!node->leaf) {
+        for (size_t i = 0; i <= node->count; i++) df_ordmap_node_free(node->children[i]);
+    }
+    DF_FREE(node);
+}
 
-    return df_lt(a, b) ? df_copy(a) : df_copy(b);
+// Helper: First index whose key is >= probe; *found reports equality
+static size_t df_ordmap_lower_bound(const df_ordmap_node* node, const df_ordmap_entry* probe, bool* found) {
+    size_t lo = 0, hi = node->count;
+    *found = false;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        const df_ordmap_entry* e = &node->entries[mid];
+        int c = df_bounded_cmp(e->lo, e->hi, e->key, probe->lo, probe->hi, probe->key);
+        if (c < 0) {
+            lo = mid + 1;
+        } else {
+            if (c == 0) *found = true;
+            hi = mid;
+        }
+    }
+    return lo;
 }
 
-// Max function
-DF_IMPL df_frac df_max(df_frac a, df_frac b) {
-    DF_ASSERT(a && "df_max: first operand cannot be NULL");
-    DF_ASSERT(b && "df_max: second operand cannot be NULL");
+// Helper: Probe entry for key (borrowed)
+static df_ordmap_entry df_ordmap_probe(df_frac key) {
+    df_ordmap_entry probe;
+    df_sort_bounds(key, &probe.lo, &probe.hi);
+    probe.key = key;
+    probe.value = NULL;
+    return probe;
+}
 
-    return df_gt(a, b) ? df_copy(a) : df_copy(b);
+// Helper: Split the full child i of parent around its median
+static void df_ordmap_split(df_ordmap_node* parent, size_t i) {
+    df_ordmap_node* full = parent->children[i];
+    df_ordmap_node* right = df_ordmap_node_new(full->leaf);
+    const size_t t = DF_ORDMAP_T;
+
+    right->count = t - 1;
+    memcpy(right->entries, full->entries + t, sizeof(df_ordmap_entry) * (t - 1));
+    if (!full->leaf) memcpy(right->children, full->children + t, sizeof(df_ordmap_node*) * t);
+    full->count = t - 1;
+
+    memmove(parent->children + i + 2, parent->children + i + 1, sizeof(df_ordmap_node*) * (parent->count - i));
+    memmove(parent->entries + i + 1, parent->entries + i, sizeof(df_ordmap_entry) * (parent->count - i));
+    parent->children[i + 1] = right;
+    parent->entries[i] = full->entries[t - 1];
+    parent->count++;
 }
 
+// Helper: Merge child i, separator i and child i + 1 into child i
+static void df_ordmap_merge(df_ordmap_node* parent, size_t i) {
+    df_ordmap_node* left = parent->children[i];
+    df_ordmap_node* right = parent->children[i + 1];
 
-// Hash function
-DF_IMPL uint64_t df_hash(df_frac f) {
-    DF_ASSERT(f && "df_hash: operand cannot be NULL");
+    left->entries[left->count] = parent->entries[i];
+    memcpy(left->entries + left->count + 1, right->entries, sizeof(df_ordmap_entry) * right->count);
+    if (!left->leaf) {
+        memcpy(left->children + left->count + 1, right->children, sizeof(df_ordmap_node*) * (right->count + 1));
+    }
+    left->count += right->count + 1;
+    DF_FREE(right);
 
-    // Simple hash combining numerator and denominator
-    // Use a well-known hash combining formula
-    uint64_t h1 = 0, h2 = 0;
+    memmove(parent->entries + i, parent->entries + i + 1, sizeof(df_ordmap_entry) * (parent->count - i - 1));
+    memmove(parent->children + i + 1, parent->children + i + 2, sizeof(df_ordmap_node*) * (parent->count - i - 1));
+    parent->count--;
+}
 
-    // Hash the numerator and denominator using their string representations
-    char* num_str = di_to_string(f->numerator, 10);
-    char* den_str = di_to_string(f->denominator, 10);
+// Helper: Give child i at least T keys before descending into it; returns
+// the index of the child now covering the same range
+static size_t df_ordmap_fill(df_ordmap_node* parent, size_t i) {
+    df_ordmap_node* child = parent->children[i];
+    if (child->count >= DF_ORDMAP_T) return i;
+
+    if (i > 0 && parent->children[i - 1]->count >= DF_ORDMAP_T) {
+        // Rotate the left sibling's last key through the parent
+        df_ordmap_node* left = parent->children[i - 1];
+        memmove(child->entries + 1, child->entries, sizeof(df_ordmap_entry) * child->count);
+        if (!child->leaf) {
+            memmove(child->children + 1, child->children, sizeof(df_ordmap_node*) * (child->count + 1));
+            child->children[0] = left->children[left->count];
+        }
+        child->entries[0] = parent->entries[i - 1];
+        parent->entries[i - 1] = left->entries[left->count - 1];
+        left->count--;
+        child->count++;
+        return i;
+    }
 
-    // Simple string hash (djb2 algorithm)
-    for (const char* s = num_str; *s; s++) {
-        h1 = h1 * 33 + (uint8_t)*s;
+    if (i < parent->count && parent->children[i + 1]->count >= DF_ORDMAP_T) {
+        // Rotate the right sibling's first key through the parent
+        df_ordmap_node* right = parent->children[i + 1];
+        child->entries[child->count] = parent->entries[i];
+        if (!child->leaf) child->children[child->count + 1] = right->children[0];
+        parent->entries[i] = right->entries[0];
+        memmove(right->entries, right->entries + 1, sizeof(df_ordmap_entry) * (right->count - 1));
+        if (!right->leaf) memmove(right->children, right->children + 1, sizeof(df_ordmap_node*) * right->count);
+        right->count--;
+        child->count++;
+        return i;
     }
-    for (const char* s = den_str; *s; s++) {
-        h2 = h2 * 33 + (uint8_t)*s;
+
+    if (i < parent->count) {
+        df_ordmap_merge(parent, i);
+        return i;
     }
+    df_ordmap_merge(parent, i - 1);
+    return i - 1;
+}
 
-    free(num_str);
-    free(den_str);
+// Helper: Detach the smallest (or largest) entry of a subtree whose root
+// has at least T keys
+static df_ordmap_entry df_ordmap_take_end(df_ordmap_node* node, bool largest) {
+    while (!node->leaf) {
+        size_t i = df_ordmap_fill(node, largest ? node->count : 0);
+        node = node->children[i];
+    }
+    if (largest) return node->entries[--node->count];
 
-    // Combine hashes
-    return h1 ^ (h2 << 1);
+    df_ordmap_entry e = node->entries[0];
+    memmove(node->entries, node->entries + 1, sizeof(df_ordmap_entry) * (node->count - 1));
+    node->count--;
+    return e;
 }
 
-// Type checking functions
-DF_IMPL bool df_fits_int32(df_frac f) {
-    DF_ASSERT(f && "df_fits_int32: operand cannot be NULL");
-
-    if (!df_is_integer(f)) return false;
+// Helper: Remove probe's key from a subtree whose root has at least T keys
+// (or is the tree root); the removed entry goes to *removed
+static bool df_ordmap_delete(df_ordmap_node* node, const df_ordmap_entry* probe, df_ordmap_entry* removed) {
+    for (;;) {
+        bool found;
+        size_t i = df_ordmap_lower_bound(node, probe, &found);
+
+        if (found) {
+            *removed = node->entries[i];
+            if (node->leaf) {
+                memmove(node->entries + i, node->entries + i + 1, sizeof(df_ordmap_entry) * (node->count - i - 1));
+                node->count--;
+            } else if (node->children[i]->count >= DF_ORDMAP_T) {
+                node->entries[i] = df_ordmap_take_end(node->children[i], true);
+            } else if (node->children[i + 1]->count >= DF_ORDMAP_T) {
+                node->entries[i] = df_ordmap_take_end(node->children[i + 1], false);
+            } else {
+                // Both neighbours are minimal: merge them around the key
+                // and delete it from the merged child
+                df_ordmap_merge(node, i);
+                node = node->children[i];
+                continue;
+            }
+            return true;
+        }
 
-    int32_t dummy;
-    return di_to_int32(f->numerator, &dummy);
+        if (node->leaf) return false;
+        node = node->children[df_ordmap_fill(node, i)];
+    }
 }
 
-DF_IMPL bool df_fits_int64(df_frac f) {
-    DF_ASSERT(f && "df_fits_int64: operand cannot be NULL");
+// Helper: In-order visit of keys in [lo, hi); false once stopped
+static bool df_ordmap_visit(const df_ordmap_node* node, const df_ordmap_entry* lo, const df_ordmap_entry* hi,
+                            df_ordmap_visit_fn visit, void* ctx) {
+    bool found = false;
+    size_t start = lo ? df_ordmap_lower_bound(node, lo, &found) : 0;
 
-    if (!df_is_integer(f)) return false;
+    for (size_t i = start; i <= node->count; i++) {
+        if (!node->leaf && !(found && i == start)) {
+            if (!df_ordmap_visit(node->children[i], i == start ? lo : NULL, hi, visit, ctx)) return false;
+        }
+        if (i == node->count) break;
 
-    int64_t dummy;
-    return di_to_int64(f->numerator, &dummy);
+        const df_ordmap_entry* e = &node->entries[i];
+        if (hi && df_bounded_cmp(e->lo, e->hi, e->key, hi->lo, hi->hi, hi->key) >= 0) return false;
+        if (!visit(e->key, e->value, ctx)) return false;
+    }
+    return true;
 }
 
-DF_IMPL bool df_fits_double(df_frac f) {
-    DF_ASSERT(f && "df_fits_double: operand cannot be NULL");
+DF_IMPL df_ordmap df_ordmap_new(void) {
+    DF_STAT(DF_STAT_ORDMAP_NEW);
+    df_ordmap m = (df_ordmap)DF_MALLOC(sizeof(struct df_ordmap_internal));
+    DF_ASSERT(m && "df_ordmap_new: allocation failed");
+    memset(m, 0, sizeof(*m));
+    m->ref_count = 1;
+    return m;
+}
 
-    // Convert to double and back, see if we get the same fraction
-    double d = df_to_double(f);
-    if (!isfinite(d)) return false;
+DF_IMPL df_ordmap df_ordmap_retain(df_ordmap m) {
+    DF_ASSERT(m && "df_ordmap_retain: map cannot be NULL");
+    DF_STAT(DF_STAT_ORDMAP_RETAIN);
+    m->ref_count++;
+    return m;
+}
 
-    df_frac converted = df_from_double(d, 1000000); // Reasonable precision
-    bool fits = df_eq(f, converted);
-    df_release(&converted);
+DF_IMPL void df_ordmap_release(df_ordmap* m) {
+    DF_STAT(DF_STAT_ORDMAP_RELEASE);
+    if (!m || !*m) return;
 
-    return fits;
+    df_ordmap map = *m;
+    DF_ASSERT(map->ref_count > 0 && "df_ordmap_release: invalid reference count");
+    if (--map->ref_count == 0) {
+        df_ordmap_node_free(map->root);
+        DF_FREE(map);
+    }
+    *m = NULL;
 }
 
-// Fraction parts
-DF_IMPL di_int df_whole_part(df_frac f) {
-    DF_ASSERT(f && "df_whole_part: operand cannot be NULL");
+DF_IMPL size_t df_ordmap_size(df_ordmap m) {
+    DF_ASSERT(m && "df_ordmap_size: map cannot be NULL");
+    DF_STAT(DF_STAT_ORDMAP_SIZE);
+    return m->size;
+}
 
-    // For truncation toward zero, we need to handle negative numbers differently
-    // di_div floors toward negative infinity, but we want truncation toward zero
-    di_int quotient = di_div(f->numerator, f->denominator);
+DF_IMPL bool df_ordmap_get(df_ordmap m, df_frac key, void** value) {
+    DF_ASSERT(m && "df_ordmap_get: map cannot be NULL");
+    DF_ASSERT(key && "df_ordmap_get: key cannot be NULL");
+    DF_STAT(DF_STAT_ORDMAP_GET);
+
+    df_ordmap_entry probe = df_ordmap_probe(key);
+    const df_ordmap_node* node = m->root;
+    while (node) {
+        bool found;
+        size_t i = df_ordmap_lower_bound(node, &probe, &found);
+        if (found) {
+            if (value) *value = node->entries[i].value;
+            return true;
+        }
+        node = node->leaf ? NULL : node->children[i];
+    }
+    return false;
+}
 
-    // If negative and not an exact division, add 1 to get truncation behavior
-    if (df_is_negative(f) && !df_is_integer(f)) {
-        di_int one = di_one();
-        di_int adjusted = di_add(quotient, one);
-        di_release(&quotient);
-        di_release(&one);
-        return adjusted;
+DF_IMPL void df_ordmap_put(df_ordmap m, df_frac key, void* value) {
+    DF_ASSERT(m && "df_ordmap_put: map cannot be NULL");
+    DF_ASSERT(key && "df_ordmap_put: key cannot be NULL");
+    DF_STAT(DF_STAT_ORDMAP_PUT);
+
+    df_ordmap_entry probe = df_ordmap_probe(key);
+    if (!m->root) m->root = df_ordmap_node_new(true);
+    if (m->root->count == 2 * DF_ORDMAP_T - 1) {
+        df_ordmap_node* root = df_ordmap_node_new(false);
+        root->children[0] = m->root;
+        m->root = root;
+        df_ordmap_split(root, 0);
     }
 
-    return quotient;
-}
+    // Split full nodes on the way down so the leaf always has room
+    df_ordmap_node* node = m->root;
+    for (;;) {
+        bool found;
+        size_t i = df_ordmap_lower_bound(node, &probe, &found);
+        if (found) {
+            node->entries[i].value = value;
+            return;
+        }
 
-DF_IMPL df_frac df_fractional_part(df_frac f) {
-    DF_ASSERT(f && "df_fractional_part: operand cannot be NULL");
+        if (node->leaf) {
+            memmove(node->entries + i + 1, node->entries + i, sizeof(df_ordmap_entry) * (node->count - i));
+            probe.key = df_retain(key);
+            probe.value = value;
+            node->entries[i] = probe;
+            node->count++;
+            m->size++;
+            return;
+        }
 
-    if (df_is_integer(f)) {
-        return df_zero();
+        if (node->children[i]->count == 2 * DF_ORDMAP_T - 1) {
+            df_ordmap_split(node, i);
+            continue;  // recheck against the promoted median
+        }
+        node = node->children[i];
     }
+}
 
-    // fractional_part = f - whole_part(f)
-    // This preserves the sign: -2.333... - (-2) = -0.333...
-    di_int whole_int = df_whole_part(f);
-    di_int one = di_one();
-    df_frac whole = df_from_di(whole_int, one);
-    di_release(&whole_int);
-    di_release(&one);
+DF_IMPL bool df_ordmap_remove(df_ordmap m, df_frac key, void** value) {
+    DF_ASSERT(m && "df_ordmap_remove: map cannot be NULL");
+    DF_ASSERT(key && "df_ordmap_remove: key cannot be NULL");
+    DF_STAT(DF_STAT_ORDMAP_REMOVE);
+    if (!m->root) return false;
+
+    df_ordmap_entry probe = df_ordmap_probe(key);
+    df_ordmap_entry removed;
+    bool found = df_ordmap_delete(m->root, &probe, &removed);
+
+    // An emptied internal root hands the tree to its only child
+    if (m->root->count == 0) {
+        df_ordmap_node* old = m->root;
+        m->root = old->leaf ? NULL : old->children[0];
+        DF_FREE(old);
+    }
 
-    df_frac result = df_sub(f, whole);
-    df_release(&whole);
+    if (!found) return false;
+    if (value) *value = removed.value;
+    df_release(&removed.key);
+    m->size--;
+    return true;
+}
 
-    return result;
+DF_IMPL void df_ordmap_range(df_ordmap m, df_frac lo, df_frac hi, df_ordmap_visit_fn visit, void* ctx) {
+    DF_ASSERT(m && "df_ordmap_range: map cannot be NULL");
+    DF_ASSERT(visit && "df_ordmap_range: visit cannot be NULL");
+    DF_STAT(DF_STAT_ORDMAP_RANGE);
+    if (!m->root) return;
+
+    df_ordmap_entry lo_probe, hi_probe;
+    if (lo) lo_probe = df_ordmap_probe(lo);
+    if (hi) hi_probe = df_ordmap_probe(hi);
+    df_ordmap_visit(m->root, lo ? &lo_probe : NULL, hi ? &hi_probe : NULL, visit, ctx);
 }
 
+#if defined(DF_STATS) || defined(DF_USDT)
+#undef di_gcd
+#undef di_mul
+#undef di_div
+#undef di_mod
+#endif
+
 #endif // DF_IMPLEMENTATION
 
 #endif // DYNAMIC_FRACTION_H
\ No newline at end of file
@@ -11,6 +11,9 @@
 #include <stdio.h>
 #include <string.h>
 #include <float.h>
+#ifdef DF_THREADS
+#include <pthread.h>
+#endif
 
 void setUp(void) {
     // Setup code if needed
@@ -375,7 +378,11 @@ void test_copy(void) {
     df_frac f2 = df_copy(f1);
 
     TEST_ASSERT_NOT_NULL(f2);
+#ifdef DF_INTERN
+    TEST_ASSERT_EQUAL_PTR(f1, f2);  // One instance per value
+#else
     TEST_ASSERT_NOT_EQUAL(f1, f2);  // Different pointers
+#endif
     TEST_ASSERT_TRUE(df_eq(f1, f2)); // Same value
 
     df_release(&f1);
@@ -567,6 +574,23 @@ void test_hash(void) {
     TEST_ASSERT_EQUAL_UINT64(hash_a, hash_c);  // Equal values should have equal hashes
     TEST_ASSERT_NOT_EQUAL(hash_a, hash_d);     // Different values should (likely) have different hashes
 
+    // Wide values differing only above bit 64
+    df_frac e = df_from_string("340282366920938463463374607431768211457/3");  // 2^128 + 1
+    df_frac f = df_from_string("340282368188589063691604008928471416833/3");  // 2^128 + 2^100 + 1
+    df_frac g = df_from_string("1020847104565767191074812026785414250499/9");  // Same value as f
+    TEST_ASSERT_NOT_EQUAL(df_hash(e), df_hash(f));
+    TEST_ASSERT_EQUAL_UINT64(df_hash(f), df_hash(g));
+
+    // Hashes do not depend on DI_LIMB_BITS (the interned build uses 16)
+    TEST_ASSERT_EQUAL_UINT64(0xBF138AF83A35FF7Cull, df_hash(f));
+    TEST_ASSERT_EQUAL_UINT64(0xB0FA2265C703BCF5ull, hash_a);
+    df_frac h = df_from_string("-18446744073709551617/65536");  // -(2^64 + 1) / 2^16
+    TEST_ASSERT_EQUAL_UINT64(0x1F83642B45BD2D16ull, df_hash(h));
+    df_release(&h);
+    df_release(&e);
+    df_release(&f);
+    df_release(&g);
+
     df_release(&a);
     df_release(&b);
     df_release(&c);
@@ -630,6 +654,1555 @@ void test_parts(void) {
     df_release(&neg_frac_part);
 }
 
+// Series callbacks used by the binary-splitting tests
+static int64_t series_one(int64_t k, void* ctx) {
+    (void)k;
+    (void)ctx;
+    return 1;
+}
+
+static int64_t series_square(int64_t k, void* ctx) {
+    (void)ctx;
+    return k * k;
+}
+
+static int64_t series_index(int64_t k, void* ctx) {
+    (void)ctx;
+    return k == 0 ? 1 : k;
+}
+
+// Test binary-splitting series summation
+void test_series(void) {
+    // H(10) = 7381/2520
+    df_frac h = df_harmonic(10);
+    char* str = df_to_string(h);
+    TEST_ASSERT_EQUAL_STRING("7381/2520", str);
+    free(str);
+
+    // Must agree with a term-by-term fold
+    df_frac folded = df_zero();
+    for (int64_t k = 1; k <= 10; k++) {
+        df_frac term = df_from_ints(1, k);
+        df_frac next = df_add(folded, term);
+        df_release(&term);
+        df_release(&folded);
+        folded = next;
+    }
+    TEST_ASSERT_TRUE(df_eq(h, folded));
+
+    // sum 1/k^2 for k = 1..10
+    df_frac squares = df_series_sum_i64(1, 11, series_one, series_square, NULL);
+    str = df_to_string(squares);
+    TEST_ASSERT_EQUAL_STRING("1968329/1270080", str);
+    free(str);
+
+    // e partial sum: 1/0! + ... + 1/9! via term ratio 1/k
+    df_frac e = df_series_hypergeometric_i64(0, 10, series_one, series_index, NULL);
+    str = df_to_string(e);
+    TEST_ASSERT_EQUAL_STRING("98641/36288", str);
+    free(str);
+
+    // Empty range
+    df_frac empty = df_series_sum_i64(5, 5, series_one, series_square, NULL);
+    TEST_ASSERT_TRUE(df_is_zero(empty));
+
+    df_release(&h);
+    df_release(&folded);
+    df_release(&squares);
+    df_release(&e);
+    df_release(&empty);
+}
+
+// Test Bernoulli numbers
+void test_bernoulli(void) {
+    const char* expected[] = {"1", "-1/2", "1/6", "0", "-1/30", "0", "1/42", "0", "-1/30", "0", "5/66",
+                              "0", "-691/2730"};
+    for (uint32_t n = 0; n < sizeof(expected) / sizeof(expected[0]); n++) {
+        df_frac b = df_bernoulli(n);
+        char* str = df_to_string(b);
+        TEST_ASSERT_EQUAL_STRING(expected[n], str);
+        free(str);
+        df_release(&b);
+    }
+}
+
+// Test continued-fraction expansion and reconstruction
+void test_continued_fraction(void) {
+    const int64_t expected[] = {4, 2, 6, 7};
+    df_frac f = df_from_ints(415, 93);
+    di_int terms[8];
+
+    size_t n = df_to_cf(f, terms, 8);
+    TEST_ASSERT_EQUAL_INT(4, n);
+    for (size_t i = 0; i < n; i++) {
+        int64_t v;
+        TEST_ASSERT_TRUE(di_to_int64(terms[i], &v));
+        TEST_ASSERT_EQUAL_INT64(expected[i], v);
+    }
+
+    df_frac rebuilt = df_from_cf(terms, n);
+    TEST_ASSERT_TRUE(df_eq(f, rebuilt));
+
+    // Truncated expansion gives a convergent
+    df_frac partial = df_from_cf(terms, 2);
+    char* str = df_to_string(partial);
+    TEST_ASSERT_EQUAL_STRING("9/2", str);
+    free(str);
+
+    for (size_t i = 0; i < n; i++) {
+        di_release(&terms[i]);
+    }
+
+    // Negative values use a floor first term: -415/93 = [-5; 1, 1, 6, 7]
+    df_frac neg = df_from_ints(-415, 93);
+    n = df_to_cf(neg, terms, 8);
+    TEST_ASSERT_EQUAL_INT(5, n);
+    int64_t first;
+    TEST_ASSERT_TRUE(di_to_int64(terms[0], &first));
+    TEST_ASSERT_EQUAL_INT64(-5, first);
+    df_frac neg_rebuilt = df_from_cf(terms, n);
+    TEST_ASSERT_TRUE(df_eq(neg, neg_rebuilt));
+    for (size_t i = 0; i < n; i++) {
+        di_release(&terms[i]);
+    }
+
+    df_release(&f);
+    df_release(&rebuilt);
+    df_release(&partial);
+    df_release(&neg);
+    df_release(&neg_rebuilt);
+}
+
+// Test streaming convergents, including values beyond int64_t
+void test_cf_iter(void) {
+    const char* expected[] = {"4", "9/2", "58/13", "415/93"};
+    df_frac f = df_from_ints(415, 93);
+    df_cf_iter it;
+    di_int term;
+    df_frac conv;
+    size_t count = 0;
+
+    df_cf_iter_init(&it, f);
+    while (df_cf_iter_next(&it, &term, &conv)) {
+        char* str = df_to_string(conv);
+        TEST_ASSERT_EQUAL_STRING(expected[count], str);
+        free(str);
+        di_release(&term);
+        df_release(&conv);
+        count++;
+    }
+    df_cf_iter_free(&it);
+    TEST_ASSERT_EQUAL_INT(4, count);
+
+    // F(121)/F(120) = [1; 1, ..., 1, 2] with 119 terms
+    df_frac fib = df_from_string("8670007398507948658051921/5358359254990966640871840");
+    df_cf_iter_init(&it, fib);
+    df_frac last = NULL;
+    count = 0;
+    while (df_cf_iter_next(&it, &term, &conv)) {
+        int64_t v;
+        TEST_ASSERT_TRUE(di_to_int64(term, &v));
+        TEST_ASSERT_EQUAL_INT64(count == 118 ? 2 : 1, v);
+        di_release(&term);
+        df_release(&last);
+        last = conv;
+        count++;
+    }
+    df_cf_iter_free(&it);
+    TEST_ASSERT_EQUAL_INT(119, count);
+    TEST_ASSERT_TRUE(df_eq(fib, last));
+
+    df_release(&f);
+    df_release(&fib);
+    df_release(&last);
+}
+
+// Test comparisons that the floating-point filter cannot decide
+void test_filtered_cmp(void) {
+    // Differ far below double resolution
+    df_frac a = df_from_string("100000000000000000001/100000000000000000000");
+    df_frac b = df_from_string("100000000000000000002/100000000000000000001");
+    TEST_ASSERT_EQUAL_INT(1, df_cmp(a, b));
+    TEST_ASSERT_EQUAL_INT(-1, df_cmp(b, a));
+    TEST_ASSERT_TRUE(df_lt(b, a));
+    TEST_ASSERT_DOUBLE_WITHIN(1e-12, 1.0, df_to_double(a));
+
+    // Equal values in distinct objects
+    df_frac c = df_from_string("200000000000000000002/200000000000000000000");
+    TEST_ASSERT_EQUAL_INT(0, df_cmp(a, c));
+    TEST_ASSERT_TRUE(df_eq(a, c));
+
+    // Components overflow double, so the filter must step aside: (10^400 + 1) / 10^399
+    di_int p399 = di_one();
+    for (int i = 0; i < 399; i++) {
+        di_int next = di_mul_i32(p399, 10);
+        di_release(&p399);
+        p399 = next;
+    }
+    di_int p400 = di_mul_i32(p399, 10);
+    di_int p400_plus_one = di_add_i32(p400, 1);
+    df_frac big = df_from_di(p400_plus_one, p399);
+    di_release(&p399);
+    di_release(&p400);
+    di_release(&p400_plus_one);
+    df_frac ten = df_from_int(10);
+    df_frac eleven = df_from_int(11);
+    TEST_ASSERT_EQUAL_INT(1, df_cmp(big, ten));
+    TEST_ASSERT_EQUAL_INT(-1, df_cmp(big, eleven));
+
+    // Sign and zero handling
+    df_frac neg = df_from_ints(-1, 3);
+    df_frac zero = df_zero();
+    TEST_ASSERT_EQUAL_INT(-1, df_cmp(neg, zero));
+    TEST_ASSERT_EQUAL_INT(1, df_cmp(zero, neg));
+    TEST_ASSERT_EQUAL_INT(0, df_cmp(zero, zero));
+    TEST_ASSERT_TRUE(df_ne(neg, zero));
+
+    df_release(&a);
+    df_release(&b);
+    df_release(&c);
+    df_release(&big);
+    df_release(&ten);
+    df_release(&eleven);
+    df_release(&neg);
+    df_release(&zero);
+}
+
+// Helper: check a decimal's string form
+static void assert_decimal(const char* expected, df_decimal d) {
+    char* str = df_decimal_to_string(d);
+    TEST_ASSERT_EQUAL_STRING(expected, str);
+    free(str);
+}
+
+// Test decimal fixed-scale arithmetic
+void test_decimal(void) {
+    df_decimal a = df_decimal_from_string("0.1");
+    df_decimal b = df_decimal_from_string("0.20");
+    TEST_ASSERT_EQUAL_INT(1, df_decimal_scale(b));  // normalized to 0.2
+
+    df_decimal sum = df_decimal_add(a, b);
+    assert_decimal("0.3", sum);
+
+    df_decimal price = df_decimal_from_string("19.99");
+    df_decimal qty = df_decimal_from_int(3, 0);
+    df_decimal total = df_decimal_mul(price, qty);
+    assert_decimal("59.97", total);
+
+    // Trailing zeros are stripped: 1.25 + 0.75 = 2
+    df_decimal x = df_decimal_from_string("1.25");
+    df_decimal y = df_decimal_from_string("0.75");
+    df_decimal two = df_decimal_add(x, y);
+    assert_decimal("2", two);
+    TEST_ASSERT_EQUAL_INT(0, df_decimal_scale(two));
+
+    df_decimal tiny = df_decimal_from_int(-5, 3);
+    assert_decimal("-0.005", tiny);
+
+    // Overflow of the int64_t coefficient moves to di_int and back
+    df_decimal max = df_decimal_from_int(INT64_MAX, 2);
+    df_decimal cent = df_decimal_from_string("0.01");
+    df_decimal over = df_decimal_add(max, cent);
+    assert_decimal("92233720368547758.08", over);
+    df_decimal back = df_decimal_sub(over, cent);
+    TEST_ASSERT_EQUAL_INT(0, df_decimal_cmp(back, max));
+    TEST_ASSERT_EQUAL_INT(1, df_decimal_cmp(over, max));
+
+    // Comparison across scales
+    df_decimal p = df_decimal_from_string("1.5");
+    df_decimal q = df_decimal_from_string("1.49");
+    TEST_ASSERT_EQUAL_INT(1, df_decimal_cmp(p, q));
+    TEST_ASSERT_EQUAL_INT(-1, df_decimal_cmp(q, p));
+
+    TEST_ASSERT_NULL(df_decimal_from_string("1.2.3"));
+    TEST_ASSERT_NULL(df_decimal_from_string("abc"));
+
+    df_decimal_release(&a);
+    df_decimal_release(&b);
+    df_decimal_release(&sum);
+    df_decimal_release(&price);
+    df_decimal_release(&qty);
+    df_decimal_release(&total);
+    df_decimal_release(&x);
+    df_decimal_release(&y);
+    df_decimal_release(&two);
+    df_decimal_release(&tiny);
+    df_decimal_release(&max);
+    df_decimal_release(&cent);
+    df_decimal_release(&over);
+    df_decimal_release(&back);
+    df_decimal_release(&p);
+    df_decimal_release(&q);
+}
+
+// Test conversion between decimals and fractions
+void test_decimal_frac(void) {
+    df_frac f = df_from_ints(3, 8);
+    df_decimal d = df_decimal_from_frac(f);
+    TEST_ASSERT_NOT_NULL(d);
+    assert_decimal("0.375", d);
+
+    df_frac back = df_decimal_to_frac(d);
+    TEST_ASSERT_TRUE(df_eq(f, back));
+
+    df_frac third = df_from_ints(1, 3);
+    TEST_ASSERT_NULL(df_decimal_from_frac(third));
+
+    df_frac neg = df_from_ints(-7, 20);
+    df_decimal neg_d = df_decimal_from_frac(neg);
+    assert_decimal("-0.35", neg_d);
+
+    df_release(&f);
+    df_release(&back);
+    df_release(&third);
+    df_release(&neg);
+    df_decimal_release(&d);
+    df_decimal_release(&neg_d);
+}
+
+// Helper: check a fraction's string form
+static void assert_frac(const char* expected, df_frac f) {
+    char* str = df_to_string(f);
+    TEST_ASSERT_EQUAL_STRING(expected, str);
+    free(str);
+}
+
+// Test the dyadic (power-of-two denominator) fast path
+void test_dyadic(void) {
+    df_frac a = df_from_ints(3, 8);
+    df_frac b = df_from_ints(1, 8);
+    df_frac sum = df_add(a, b);
+    assert_frac("1/2", sum);
+
+    // Cancels to an integer
+    df_frac c = df_from_ints(5, 8);
+    df_frac one = df_add(a, c);
+    TEST_ASSERT_TRUE(df_is_integer(one));
+    df_frac zero = df_sub(a, a);
+    TEST_ASSERT_TRUE(df_is_zero(zero));
+    assert_frac("0", zero);
+
+    df_frac prod = df_mul(a, c);  // 15/64
+    assert_frac("15/64", prod);
+
+    df_frac half = df_from_ints(-6, 12);
+    TEST_ASSERT_EQUAL_INT(-1, df_cmp(half, b));
+    TEST_ASSERT_EQUAL_INT(1, df_cmp(a, b));
+
+    // Mixing with a non-dyadic operand falls back to the general path
+    df_frac third = df_from_ints(1, 3);
+    df_frac mixed = df_add(a, third);  // 17/24
+    assert_frac("17/24", mixed);
+
+    // Repeated halving builds a denominator far beyond double range
+    df_frac x = df_from_int(3);
+    for (int i = 0; i < 1100; i++) {
+        df_frac next = df_mul(x, half);
+        df_release(&x);
+        x = next;
+    }
+    double expected = ldexp(1.5, -1100);  // underflows to zero
+    TEST_ASSERT_FALSE(isnan(df_to_double(x)));
+    TEST_ASSERT_EQUAL_DOUBLE(expected, df_to_double(x));
+    df_frac y = df_add(x, x);
+    TEST_ASSERT_EQUAL_INT(1, df_cmp(y, x));
+
+    df_release(&a);
+    df_release(&b);
+    df_release(&sum);
+    df_release(&c);
+    df_release(&one);
+    df_release(&zero);
+    df_release(&prod);
+    df_release(&half);
+    df_release(&third);
+    df_release(&mixed);
+    df_release(&x);
+    df_release(&y);
+}
+
+// Test exact summation of double arrays
+void test_sum_doubles(void) {
+    // Catastrophic cancellation in naive summation
+    double x[] = {1e100, 1.0, -1e100, 0.5, 0.25};
+    df_frac s = df_sum_doubles(x, 5);
+    assert_frac("7/4", s);
+
+    // 0.1 + 0.2 is the exact binary sum, not 3/10
+    double y[] = {0.1, 0.2};
+    df_frac s2 = df_sum_doubles(y, 2);
+    assert_frac("10808639105689191/36028797018963968", s2);
+
+    // Extremes of the exponent range
+    double z[] = {DBL_MAX, DBL_MAX, DBL_TRUE_MIN, -DBL_MAX, -DBL_MAX};
+    df_frac s3 = df_sum_doubles(z, 5);
+    TEST_ASSERT_EQUAL_DOUBLE(DBL_TRUE_MIN, df_to_double(s3));
+
+    df_frac empty = df_sum_doubles(NULL, 0);
+    TEST_ASSERT_TRUE(df_is_zero(empty));
+
+    double bad[] = {1.0, NAN};
+    TEST_ASSERT_NULL(df_sum_doubles(bad, 2));
+
+    df_release(&s);
+    df_release(&s2);
+    df_release(&s3);
+    df_release(&empty);
+}
+
+// Test exact dot products of double arrays
+void test_dot_doubles(void) {
+    // Products that overflow and underflow in double arithmetic
+    double x[] = {ldexp(1.0, 600), 3.0, ldexp(1.0, -600), -ldexp(1.0, 600)};
+    double y[] = {ldexp(1.0, 600), 0.5, ldexp(1.0, -600), ldexp(1.0, 600)};
+    df_frac d = df_dot_doubles(x, y, 4);
+    df_frac expected = df_from_ints(3, 2);
+    di_int one = di_one();
+    di_int pow2 = di_shift_left(one, 1200);
+    df_frac tiny = df_from_di(one, pow2);
+    di_release(&one);
+    di_release(&pow2);
+    df_frac sum = df_add(expected, tiny);
+    TEST_ASSERT_TRUE(df_eq(d, sum));
+
+    // Full 106-bit products: (2^53 - 1)^2
+    double m = 9007199254740991.0;
+    df_frac sq = df_dot_doubles(&m, &m, 1);
+    assert_frac("81129638414606663681390495662081", sq);
+
+    double bad[] = {INFINITY};
+    TEST_ASSERT_NULL(df_dot_doubles(bad, &m, 1));
+
+    df_release(&d);
+    df_release(&expected);
+    df_release(&tiny);
+    df_release(&sum);
+    df_release(&sq);
+}
+
+// Test power-of-two scaling
+void test_ldexp_frexp(void) {
+    df_frac f = df_from_ints(3, 8);
+    df_frac up = df_ldexp(f, 5);  // 12
+    assert_frac("12", up);
+    df_frac down = df_ldexp(f, -2);  // 3/32
+    assert_frac("3/32", down);
+
+    df_frac g = df_from_ints(-12, 7);
+    df_frac gd = df_ldexp(g, -3);  // -3/14
+    assert_frac("-3/14", gd);
+    df_frac gu = df_ldexp(g, 100);
+    df_frac back = df_ldexp(gu, -100);
+    TEST_ASSERT_TRUE(df_eq(g, back));
+
+    int64_t e;
+    df_frac m = df_frexp(g, &e);  // -12/7 = -6/7 * 2^1
+    assert_frac("-6/7", m);
+    TEST_ASSERT_EQUAL_INT64(1, e);
+
+    // Boundary: exact power of two gives mantissa 1/2
+    df_frac eight = df_from_int(8);
+    df_frac m8 = df_frexp(eight, &e);
+    assert_frac("1/2", m8);
+    TEST_ASSERT_EQUAL_INT64(4, e);
+
+    // Bit lengths equal but value below 1/2 needs no correction
+    df_frac t = df_from_ints(5, 7);
+    df_frac mt = df_frexp(t, &e);
+    assert_frac("5/7", mt);
+    TEST_ASSERT_EQUAL_INT64(0, e);
+
+    df_frac zero = df_zero();
+    df_frac mz = df_frexp(zero, &e);
+    TEST_ASSERT_TRUE(df_is_zero(mz));
+    TEST_ASSERT_EQUAL_INT64(0, e);
+
+    df_release(&f);
+    df_release(&up);
+    df_release(&down);
+    df_release(&g);
+    df_release(&gd);
+    df_release(&gu);
+    df_release(&back);
+    df_release(&m);
+    df_release(&eight);
+    df_release(&m8);
+    df_release(&t);
+    df_release(&mt);
+    df_release(&zero);
+    df_release(&mz);
+}
+
+// Test integer rescaling with rounding modes
+void test_rescale(void) {
+    int64_t r;
+    // 7 * 1 / 2 = 3.5 under every mode
+    TEST_ASSERT_TRUE(df_rescale_i64(7, 1, 2, DF_ROUND_FLOOR, &r));
+    TEST_ASSERT_EQUAL_INT64(3, r);
+    TEST_ASSERT_TRUE(df_rescale_i64(7, 1, 2, DF_ROUND_CEIL, &r));
+    TEST_ASSERT_EQUAL_INT64(4, r);
+    TEST_ASSERT_TRUE(df_rescale_i64(-7, 1, 2, DF_ROUND_TRUNC, &r));
+    TEST_ASSERT_EQUAL_INT64(-3, r);
+    TEST_ASSERT_TRUE(df_rescale_i64(-7, 1, 2, DF_ROUND_AWAY, &r));
+    TEST_ASSERT_EQUAL_INT64(-4, r);
+    TEST_ASSERT_TRUE(df_rescale_i64(7, 1, 2, DF_ROUND_HALF_EVEN, &r));
+    TEST_ASSERT_EQUAL_INT64(4, r);
+    TEST_ASSERT_TRUE(df_rescale_i64(5, -1, -2, DF_ROUND_HALF_EVEN, &r));
+    TEST_ASSERT_EQUAL_INT64(2, r);
+    TEST_ASSERT_TRUE(df_rescale_i64(-5, 1, 2, DF_ROUND_HALF_AWAY, &r));
+    TEST_ASSERT_EQUAL_INT64(-3, r);
+
+    // Intermediate product needs 128 bits
+    TEST_ASSERT_TRUE(df_rescale_i64(INT64_MAX, 90000, 1000000, DF_ROUND_FLOOR, &r));
+    TEST_ASSERT_EQUAL_INT64(830103483316929822LL, r);
+    TEST_ASSERT_FALSE(df_rescale_i64(INT64_MAX, 3, 2, DF_ROUND_FLOOR, &r));
+    TEST_ASSERT_TRUE(df_rescale_i64(INT64_MIN, 1, 1, DF_ROUND_FLOOR, &r));
+    TEST_ASSERT_EQUAL_INT64(INT64_MIN, r);
+
+    // Array form agrees with the scalar form
+    int64_t x[] = {0, 1, -1, 45, -45, 90000, 123456789012345LL, INT64_MAX};
+    int64_t out[8];
+    TEST_ASSERT_FALSE(df_rescale_many(x, out, 8, 1000, 90, DF_ROUND_HALF_EVEN));
+    for (int i = 0; i < 7; i++) {
+        TEST_ASSERT_TRUE(df_rescale_i64(x[i], 1000, 90, DF_ROUND_HALF_EVEN, &r));
+        TEST_ASSERT_EQUAL_INT64(r, out[i]);
+    }
+    TEST_ASSERT_EQUAL_INT64(0, out[7]);
+    TEST_ASSERT_TRUE(df_rescale_many(x, out, 7, 1, 90000, DF_ROUND_CEIL));
+    TEST_ASSERT_EQUAL_INT64(1, out[5]);
+    TEST_ASSERT_EQUAL_INT64(0, out[4]);
+}
+
+// Test quantization to a fixed denominator
+void test_quantize(void) {
+    int64_t k;
+    df_frac price = df_from_ints(12345, 1000);  // 12.345
+    TEST_ASSERT_TRUE(df_quantize(price, 100, DF_ROUND_HALF_EVEN, &k));
+    TEST_ASSERT_EQUAL_INT64(1234, k);
+    TEST_ASSERT_TRUE(df_quantize(price, 100, DF_ROUND_HALF_AWAY, &k));
+    TEST_ASSERT_EQUAL_INT64(1235, k);
+    TEST_ASSERT_TRUE(df_quantize(price, 100, DF_ROUND_FLOOR, &k));
+    TEST_ASSERT_EQUAL_INT64(1234, k);
+
+    df_frac neg = df_from_ints(-7, 3);
+    TEST_ASSERT_TRUE(df_quantize(neg, 4, DF_ROUND_FLOOR, &k));  // -9.33 -> -10
+    TEST_ASSERT_EQUAL_INT64(-10, k);
+    TEST_ASSERT_TRUE(df_quantize(neg, 4, DF_ROUND_TRUNC, &k));
+    TEST_ASSERT_EQUAL_INT64(-9, k);
+
+    // Components beyond int64_t take the di_int path
+    df_frac big = df_from_string("100000000000000000000000000001/30000000000000000000000000000");
+    TEST_ASSERT_TRUE(df_quantize(big, 48000, DF_ROUND_HALF_EVEN, &k));  // 160000.0000...
+    TEST_ASSERT_EQUAL_INT64(160000, k);
+    TEST_ASSERT_TRUE(df_quantize(big, 48000, DF_ROUND_CEIL, &k));
+    TEST_ASSERT_EQUAL_INT64(160001, k);
+    df_frac huge = df_from_string("100000000000000000000000000000");
+    TEST_ASSERT_FALSE(df_quantize(huge, 1, DF_ROUND_FLOOR, &k));
+
+    df_frac batch[] = {price, neg, big, huge};
+    int64_t out[4];
+    TEST_ASSERT_FALSE(df_quantize_many(batch, 4, 10, DF_ROUND_HALF_EVEN, out));
+    TEST_ASSERT_EQUAL_INT64(123, out[0]);
+    TEST_ASSERT_EQUAL_INT64(-23, out[1]);
+    TEST_ASSERT_EQUAL_INT64(33, out[2]);
+    TEST_ASSERT_EQUAL_INT64(0, out[3]);
+
+    df_release(&price);
+    df_release(&neg);
+    df_release(&big);
+    df_release(&huge);
+}
+
+// Test exact geometric predicates
+void test_geometry(void) {
+    double a[2] = {0, 0}, b[2] = {1, 0}, c[2] = {0, 1};
+    TEST_ASSERT_EQUAL_INT(1, df_orient2d_d(a, b, c));
+    TEST_ASSERT_EQUAL_INT(-1, df_orient2d_d(a, c, b));
+
+    // Nearly collinear points defeat naive double evaluation
+    double p[2] = {0.5, 0.5};
+    double q[2] = {12, 12};
+    double r[2] = {24, 24};
+    TEST_ASSERT_EQUAL_INT(0, df_orient2d_d(p, q, r));
+    double r2[2] = {24.000000000000004, 24};
+    TEST_ASSERT_EQUAL_INT(-1, df_orient2d_d(p, q, r2));
+
+    double d3a[3] = {0, 0, 0}, d3b[3] = {1, 0, 0}, d3c[3] = {0, 1, 0};
+    double below[3] = {0.25, 0.25, -1e-300}, on[3] = {5, 7, 0};
+    TEST_ASSERT_EQUAL_INT(1, df_orient3d_d(d3a, d3b, d3c, below));
+    TEST_ASSERT_EQUAL_INT(0, df_orient3d_d(d3a, d3b, d3c, on));
+
+    // Unit circle through (1,0), (0,1), (-1,0)
+    double ca[2] = {1, 0}, cb[2] = {0, 1}, cc[2] = {-1, 0};
+    double inside[2] = {0, 0.999999999999}, cocirc[2] = {0, -1}, outside[2] = {0, -1.0000000000000002};
+    TEST_ASSERT_EQUAL_INT(1, df_incircle_d(ca, cb, cc, inside));
+    TEST_ASSERT_EQUAL_INT(0, df_incircle_d(ca, cb, cc, cocirc));
+    TEST_ASSERT_EQUAL_INT(-1, df_incircle_d(ca, cb, cc, outside));
+
+    // Rational coordinates with mixed denominators: points on y = x/3
+    df_frac fa[2] = {df_from_ints(1, 7), df_from_ints(1, 21)};
+    df_frac fb[2] = {df_from_ints(2, 5), df_from_ints(2, 15)};
+    df_frac fc[2] = {df_from_int(9), df_from_int(3)};
+    TEST_ASSERT_EQUAL_INT(0, df_orient2d(fa, fb, fc));
+    df_frac above = df_from_string("300000000000000000000001/100000000000000000000000");
+    df_frac fd[2] = {fc[0], above};
+    TEST_ASSERT_EQUAL_INT(1, df_orient2d(fa, fb, fd));
+
+    // Circle through three rational points, query exactly on it
+    df_frac ua[2] = {df_from_ints(3, 5), df_from_ints(4, 5)};
+    df_frac ub[2] = {df_from_ints(-4, 5), df_from_ints(3, 5)};
+    df_frac uc[2] = {df_from_ints(-3, 5), df_from_ints(-4, 5)};
+    df_frac ud[2] = {df_from_ints(5, 13), df_from_ints(-12, 13)};
+    TEST_ASSERT_EQUAL_INT(0, df_incircle(ua, ub, uc, ud));
+
+    for (int i = 0; i < 2; i++) {
+        df_release(&fa[i]);
+        df_release(&fb[i]);
+        df_release(&fc[i]);
+        df_release(&ua[i]);
+        df_release(&ub[i]);
+        df_release(&uc[i]);
+        df_release(&ud[i]);
+    }
+    df_release(&above);
+}
+
+// Test columnar fraction storage
+void test_column(void) {
+    df_column col = df_column_new(0);
+    df_column_append_ints(col, 6, -8);  // -3/4
+    df_column_append_ints(col, INT64_MIN, 1);
+    df_column_append(col, NULL);
+
+    df_frac big = df_from_string("123456789012345678901234567890/7");
+    df_column_append(col, big);
+    for (int i = 0; i < 100; i++) {
+        df_column_append_ints(col, i, 100);
+    }
+    TEST_ASSERT_EQUAL_UINT64(104, df_column_length(col));
+
+    df_frac v = df_column_get(col, 0);
+    assert_frac("-3/4", v);
+    df_release(&v);
+    v = df_column_get(col, 1);
+    assert_frac("-9223372036854775808", v);
+    df_release(&v);
+    TEST_ASSERT_TRUE(df_column_is_null(col, 2));
+    TEST_ASSERT_NULL(df_column_get(col, 2));
+    v = df_column_get(col, 3);
+    TEST_ASSERT_TRUE(df_eq(v, big));
+    df_release(&v);
+    v = df_column_get(col, 54);
+    assert_frac("1/2", v);
+    df_release(&v);
+
+    // Overwrite inline <-> side table
+    df_frac third = df_from_ints(1, 3);
+    df_column_set(col, 3, third);
+    df_column_set(col, 0, big);
+    df_column_set(col, 2, big);
+    v = df_column_get(col, 3);
+    TEST_ASSERT_TRUE(df_eq(v, third));
+    df_release(&v);
+    v = df_column_get(col, 0);
+    TEST_ASSERT_TRUE(df_eq(v, big));
+    df_release(&v);
+    TEST_ASSERT_FALSE(df_column_is_null(col, 2));
+
+    // Released side table slots are reused
+    for (int i = 0; i < 1000; i++) {
+        df_column_set(col, 5, big);
+        df_column_set(col, 5, third);
+    }
+    TEST_ASSERT_EQUAL_UINT64(3, col->big_count);
+    v = df_column_get(col, 5);
+    TEST_ASSERT_TRUE(df_eq(v, third));
+    df_release(&v);
+
+    // Round trip through df_frac arrays
+    df_frac values[104];
+    df_column_to_fracs(col, values);
+    df_column copy = df_column_from_fracs(values, 104);
+    for (int i = 0; i < 104; i++) {
+        df_frac w = df_column_get(copy, (size_t)i);
+        TEST_ASSERT_TRUE(df_eq(values[i], w));
+        df_release(&w);
+        df_release(&values[i]);
+    }
+
+    df_release(&big);
+    df_release(&third);
+    df_column_release(&copy);
+    df_column_release(&col);
+    TEST_ASSERT_NULL(col);
+}
+
+// Test column aggregation kernels against df_frac arithmetic
+void test_column_aggregates(void) {
+    df_column col = df_column_new(0);
+    df_frac expected = df_zero();
+
+    // Long runs sharing a denominator, a grid change, nulls and big values
+    for (int64_t i = 0; i < 300; i++) {
+        int64_t num = (i * 7919) % 1000 - 500;
+        int64_t den = i < 130 ? 1 : (i < 200 ? 100 : 3 + i % 5);
+        if (i % 97 == 13) {
+            df_column_append(col, NULL);
+            continue;
+        }
+        df_column_append_ints(col, num, den);
+        df_frac v = df_from_ints(num, den);
+        df_frac sum = df_add(expected, v);
+        df_release(&expected);
+        df_release(&v);
+        expected = sum;
+    }
+    df_frac big = df_from_string("-100000000000000000000000000/3");
+    df_column_append(col, big);
+    df_frac sum = df_add(expected, big);
+    df_release(&expected);
+    expected = sum;
+
+    df_frac total = df_column_sum(col);
+    TEST_ASSERT_TRUE(df_eq(expected, total));
+
+    TEST_ASSERT_EQUAL_UINT64(300, df_column_argmin(col));
+    df_frac lo = df_column_min(col);
+    TEST_ASSERT_TRUE(df_eq(lo, big));
+    df_frac hi = df_column_max(col);
+    assert_frac("481", hi);
+    size_t at = df_column_argmax(col);
+    df_frac at_val = df_column_get(col, at);
+    TEST_ASSERT_TRUE(df_eq(hi, at_val));
+
+    // Mean over the 298 non-null entries
+    df_frac mean = df_column_mean(col);
+    df_frac count = df_from_int(298);
+    df_frac check = df_mul(mean, count);
+    TEST_ASSERT_TRUE(df_eq(check, total));
+
+    // Full-width int64 values exercise the 128-bit accumulator
+    df_column wide = df_column_new(0);
+    for (int i = 0; i < 128; i++) df_column_append_ints(wide, INT64_MAX, 1);
+    df_frac wide_sum = df_column_sum(wide);
+    assert_frac("1180591620717411303296", wide_sum);
+
+    df_column empty = df_column_new(0);
+    df_column_append(empty, NULL);
+    TEST_ASSERT_NULL(df_column_min(empty));
+    TEST_ASSERT_NULL(df_column_mean(empty));
+    TEST_ASSERT_EQUAL_UINT64(SIZE_MAX, df_column_argmin(empty));
+    df_frac empty_sum = df_column_sum(empty);
+    TEST_ASSERT_TRUE(df_is_zero(empty_sum));
+
+    df_release(&expected);
+    df_release(&big);
+    df_release(&total);
+    df_release(&lo);
+    df_release(&hi);
+    df_release(&at_val);
+    df_release(&mean);
+    df_release(&count);
+    df_release(&check);
+    df_release(&wide_sum);
+    df_release(&empty_sum);
+    df_column_release(&col);
+    df_column_release(&wide);
+    df_column_release(&empty);
+}
+
+// Test bucketed summation against a left fold
+void test_sum(void) {
+    df_frac values[480];
+    df_frac expected = df_zero();
+    for (int i = 0; i < 480; i++) {
+        // Cents, thirds and halves, then more distinct denominators than buckets
+        int64_t den = i < 400 ? (i % 3 == 0 ? 100 : (i % 3 == 1 ? 3 : 2)) : i - 396;
+        values[i] = df_from_ints(i * 37 - 5000, den);
+        df_frac next = df_add(expected, values[i]);
+        df_release(&expected);
+        expected = next;
+    }
+
+    df_frac total = df_sum(values, 480, 1);
+    TEST_ASSERT_TRUE(df_eq(expected, total));
+
+    // Numerator overflow within one bucket spills to di_int
+    df_frac big[4];
+    for (int i = 0; i < 4; i++) big[i] = df_from_ints(INT64_MAX, 7);
+    df_frac* many = (df_frac*)malloc(sizeof(df_frac) * 4096);
+    for (int i = 0; i < 4096; i++) many[i] = big[i % 4];
+    df_frac spilled = df_sum(many, 4096, 4);
+    df_frac seven = df_from_ints(INT64_MAX, 7);
+    df_frac count = df_from_int(4096);
+    df_frac product = df_mul(seven, count);
+    TEST_ASSERT_TRUE(df_eq(product, spilled));
+
+    df_frac empty = df_sum(NULL, 0, 1);
+    TEST_ASSERT_TRUE(df_is_zero(empty));
+
+    for (int i = 0; i < 480; i++) df_release(&values[i]);
+    for (int i = 0; i < 4; i++) df_release(&big[i]);
+    free(many);
+    df_release(&expected);
+    df_release(&total);
+    df_release(&spilled);
+    df_release(&seven);
+    df_release(&count);
+    df_release(&product);
+    df_release(&empty);
+}
+
+// Test tree reductions are identical for any thread count
+void test_tree_reduction(void) {
+    // Telescoping sum over distinct denominators: 1/(i(i+1)) adds to N/(N+1)
+    enum { N = 1200 };
+    df_frac* terms = (df_frac*)malloc(sizeof(df_frac) * N);
+    for (int i = 0; i < N; i++) terms[i] = df_from_ints(1, (int64_t)(i + 1) * (i + 2));
+
+    df_frac one_thread = df_sum(terms, N, 1);
+    df_frac four_threads = df_sum(terms, N, 4);
+    df_frac odd_threads = df_sum(terms, N, 3);
+    assert_frac("1200/1201", one_thread);
+    TEST_ASSERT_TRUE(df_eq(one_thread, four_threads));
+    TEST_ASSERT_TRUE(df_eq(one_thread, odd_threads));
+
+    // Unit fractions agree with the binary-splitting harmonic number
+    df_frac units[200];
+    for (int i = 0; i < 200; i++) units[i] = df_from_ints(1, i + 1);
+    df_frac h = df_harmonic(200);
+    df_frac h_sum = df_sum(units, 200, 1);
+    TEST_ASSERT_TRUE(df_eq(h, h_sum));
+
+    // Telescoping product: prod (i+2)/(i+1) = N + 1
+    df_frac* ratios = (df_frac*)malloc(sizeof(df_frac) * N);
+    for (int i = 0; i < N; i++) ratios[i] = df_from_ints(i + 2, i + 1);
+    df_frac p1 = df_prod(ratios, N, 1);
+    df_frac p4 = df_prod(ratios, N, 4);
+    assert_frac("1201", p1);
+    TEST_ASSERT_TRUE(df_eq(p1, p4));
+
+    df_frac empty = df_prod(NULL, 0, 1);
+    TEST_ASSERT_TRUE(df_is_one(empty));
+
+    for (int i = 0; i < N; i++) {
+        df_release(&terms[i]);
+        df_release(&ratios[i]);
+    }
+    for (int i = 0; i < 200; i++) df_release(&units[i]);
+    free(terms);
+    free(ratios);
+    df_release(&one_thread);
+    df_release(&four_threads);
+    df_release(&odd_threads);
+    df_release(&h);
+    df_release(&h_sum);
+    df_release(&p1);
+    df_release(&p4);
+    df_release(&empty);
+}
+
+// Test running totals against a serial df_add fold
+void test_prefix_sum(void) {
+    enum { N = 1000 };
+    df_frac* in = (df_frac*)malloc(sizeof(df_frac) * N);
+    for (int i = 0; i < N; i++) {
+        if (i == 9) {
+            in[i] = df_from_string("1/100000000000000000039");
+        } else if (i == 600) {
+            in[i] = df_from_string("-1/100000000000000000039");
+        } else if (i % 97 == 5) {
+            in[i] = df_from_string("100000000000000000000000/7");
+        } else if (i % 7 == 0) {
+            in[i] = df_from_ints(i, 3);
+        } else {
+            in[i] = df_from_ints((i * 37) % 1000 - 500, 100);
+        }
+    }
+
+    df_frac* expected = (df_frac*)malloc(sizeof(df_frac) * N);
+    expected[0] = df_retain(in[0]);
+    for (int i = 1; i < N; i++) expected[i] = df_add(expected[i - 1], in[i]);
+
+    df_frac* out = (df_frac*)malloc(sizeof(df_frac) * N);
+    int thread_counts[] = {1, 3, 4};
+    for (int t = 0; t < 3; t++) {
+        df_prefix_sum(in, out, N, thread_counts[t]);
+        for (int i = 0; i < N; i++) {
+            TEST_ASSERT_TRUE(df_eq(expected[i], out[i]));
+            df_release(&out[i]);
+        }
+    }
+
+    df_frac halves[3] = {df_from_ints(1, 2), df_from_ints(1, 3), df_from_ints(1, 6)};
+    df_prefix_sum(halves, out, 3, 1);
+    assert_frac("1/2", out[0]);
+    assert_frac("5/6", out[1]);
+    assert_frac("1", out[2]);
+
+    for (int i = 0; i < 3; i++) {
+        df_release(&halves[i]);
+        df_release(&out[i]);
+    }
+    for (int i = 0; i < N; i++) {
+        df_release(&in[i]);
+        df_release(&expected[i]);
+    }
+    free(in);
+    free(expected);
+    free(out);
+}
+
+// Test rewriting arrays over a common denominator and back
+void test_common_denominator(void) {
+    df_frac xs[5] = {df_from_ints(1, 2), df_from_ints(-1, 3), df_from_ints(5, 6), df_from_int(7), df_from_ints(1, 2)};
+    di_int ints[5];
+    di_int den = NULL;
+    df_common_denominator(xs, 5, ints, &den);
+
+    int64_t value;
+    int64_t expected[5] = {3, -2, 5, 42, 3};
+    TEST_ASSERT_TRUE(di_to_int64(den, &value));
+    TEST_ASSERT_EQUAL_INT64(6, value);
+    for (int i = 0; i < 5; i++) {
+        TEST_ASSERT_TRUE(di_to_int64(ints[i], &value));
+        TEST_ASSERT_EQUAL_INT64(expected[i], value);
+    }
+
+    df_frac back[5];
+    df_from_common_denominator(ints, 5, den, back);
+    for (int i = 0; i < 5; i++) TEST_ASSERT_TRUE(df_eq(xs[i], back[i]));
+
+    // Primes near 2^32 push the LCM past 64 bits, plus one wide denominator
+    df_frac wide[4] = {df_from_ints(1, 4294967291LL), df_from_ints(2, 4294967279LL), df_from_ints(3, 4294967231LL),
+                       df_from_string("1/100000000000000000039")};
+    di_int wide_ints[4];
+    di_int wide_den = NULL;
+    df_common_denominator(wide, 4, wide_ints, &wide_den);
+    df_frac wide_back[4];
+    df_from_common_denominator(wide_ints, 4, wide_den, wide_back);
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(df_eq(wide[i], wide_back[i]));
+        df_frac check = df_from_di(wide_ints[i], wide_den);
+        TEST_ASSERT_TRUE(df_eq(wide[i], check));
+        df_release(&check);
+    }
+
+    di_int none = NULL;
+    df_common_denominator(NULL, 0, NULL, &none);
+    TEST_ASSERT_TRUE(di_is_one(none));
+
+    for (int i = 0; i < 5; i++) {
+        df_release(&xs[i]);
+        df_release(&back[i]);
+        di_release(&ints[i]);
+    }
+    for (int i = 0; i < 4; i++) {
+        df_release(&wide[i]);
+        df_release(&wide_back[i]);
+        di_release(&wide_ints[i]);
+    }
+    di_release(&den);
+    di_release(&wide_den);
+    di_release(&none);
+}
+
+// Test exact sorting, argsort and selection
+void test_sort_select(void) {
+    // Near-duplicates below double resolution, exact duplicates and a
+    // value too large for a double
+    enum { N = 300 };
+    df_frac xs[N];
+    for (int i = 0; i < N; i++) {
+        if (i == N - 1) {
+            df_frac minus_one = df_from_int(-1);
+            xs[i] = df_ldexp(minus_one, 2000);
+            df_release(&minus_one);
+        } else if (i % 50 == 3) {
+            xs[i] = df_from_string("100000000000000000001/100000000000000000000");
+        } else if (i % 50 == 4) {
+            xs[i] = df_from_string("100000000000000000002/100000000000000000001");
+        } else {
+            xs[i] = df_from_ints((i * 7919) % 101 - 50, (i % 3) + 1);
+        }
+    }
+
+    size_t idx[N];
+    df_argsort(xs, N, idx);
+    TEST_ASSERT_EQUAL_size_t(N - 1, idx[0]);
+    for (int i = 1; i < N; i++) {
+        int c = df_cmp(xs[idx[i - 1]], xs[idx[i]]);
+        TEST_ASSERT_TRUE(c < 0 || (c == 0 && idx[i - 1] < idx[i]));
+    }
+
+    for (size_t k = 0; k < N; k += 37) {
+        df_frac kth = df_select_kth(xs, N, k);
+        TEST_ASSERT_TRUE(df_eq(kth, xs[idx[k]]));
+        df_release(&kth);
+    }
+
+    df_frac sorted[N];
+    for (int i = 0; i < N; i++) sorted[i] = df_retain(xs[i]);
+    df_sort(sorted, N);
+    for (int i = 0; i < N; i++) TEST_ASSERT_TRUE(sorted[i] == xs[idx[i]]);
+
+    df_frac small[4] = {df_from_ints(3, 4), df_from_ints(1, 3), df_from_ints(1, 2), df_from_int(2)};
+    df_frac median = df_median(small, 4);
+    assert_frac("5/8", median);
+    df_frac median3 = df_median(small, 3);
+    assert_frac("1/2", median3);
+
+    for (int i = 0; i < N; i++) {
+        df_release(&xs[i]);
+        df_release(&sorted[i]);
+    }
+    for (int i = 0; i < 4; i++) df_release(&small[i]);
+    df_release(&median);
+    df_release(&median3);
+}
+
+// Helper: number of boundaries <= f by linear scan
+static size_t count_at_or_below(df_frac f, const df_frac* boundaries, size_t m) {
+    size_t count = 0;
+    for (size_t j = 0; j < m; j++) count += df_cmp(boundaries[j], f) <= 0;
+    return count;
+}
+
+// Test bucketing against rational boundaries
+void test_bucketize(void) {
+    enum { N = 400 };
+    df_frac values[N];
+    for (int i = 0; i < N; i++) {
+        if (i % 100 == 7) {
+            values[i] = df_from_string("-100000000000000000000000/3");
+        } else {
+            values[i] = df_from_ints((int64_t)(i - 200) * 997, (i % 6) + 1);
+        }
+    }
+
+    // Thirds, an exact boundary hit and a negative boundary
+    df_frac brackets[4] = {df_from_ints(-5000, 1), df_from_ints(1, 3), df_from_int(10000), df_from_ints(85001, 2)};
+    df_frac exact = df_from_int(10000);
+    df_release(&values[0]);
+    values[0] = df_retain(exact);
+
+    size_t idx[N];
+    df_bucketize(values, N, brackets, 4, idx);
+    for (int i = 0; i < N; i++) TEST_ASSERT_EQUAL_size_t(count_at_or_below(values[i], brackets, 4), idx[i]);
+    TEST_ASSERT_EQUAL_size_t(3, idx[0]);
+    TEST_ASSERT_EQUAL_size_t(0, idx[7]);
+
+    // A boundary whose denominator exceeds 64 bits forces exact search
+    df_frac wide[2] = {df_from_string("1/100000000000000000039"), df_from_int(1)};
+    df_bucketize(values, N, wide, 2, idx);
+    for (int i = 0; i < N; i++) TEST_ASSERT_EQUAL_size_t(count_at_or_below(values[i], wide, 2), idx[i]);
+
+    // Group-by-bucket sums match a fold per bucket
+    df_frac sums[5];
+    df_bucket_sum(values, N, brackets, 4, sums);
+    for (size_t b = 0; b < 5; b++) {
+        df_frac expected = df_zero();
+        for (int i = 0; i < N; i++) {
+            if (count_at_or_below(values[i], brackets, 4) != b) continue;
+            df_frac next = df_add(expected, values[i]);
+            df_release(&expected);
+            expected = next;
+        }
+        TEST_ASSERT_TRUE(df_eq(expected, sums[b]));
+        df_release(&expected);
+    }
+
+    for (int i = 0; i < N; i++) df_release(&values[i]);
+    for (int i = 0; i < 4; i++) df_release(&brackets[i]);
+    for (int i = 0; i < 5; i++) df_release(&sums[i]);
+    df_release(&wide[0]);
+    df_release(&wide[1]);
+    df_release(&exact);
+}
+
+// Test the fraction-keyed hash map
+void test_map(void) {
+    enum { N = 2000 };
+    df_map m = df_map_new();
+    df_frac keys[N];
+    for (int i = 0; i < N; i++) {
+        if (i % 100 == 0) {
+            df_frac base = df_from_string("100000000000000000000000/7");
+            df_frac offset = df_from_int(i);
+            keys[i] = df_add(base, offset);
+            df_release(&base);
+            df_release(&offset);
+        } else {
+            keys[i] = df_from_ints(i - N / 2, (i % 7) + 1);
+        }
+    }
+
+    // Duplicate values among keys: later puts replace earlier values
+    for (int i = 0; i < N; i++) df_map_put(m, keys[i], (void*)(intptr_t)(i + 1));
+    for (int i = 0; i < N; i++) {
+        void* value = NULL;
+        TEST_ASSERT_TRUE(df_map_get(m, keys[i], &value));
+        int last = i;
+        for (int j = i + 1; j < N; j++) {
+            if (df_eq(keys[i], keys[j])) last = j;
+        }
+        TEST_ASSERT_EQUAL_INT(last + 1, (int)(intptr_t)value);
+    }
+
+    // A freshly built equal key finds the same entry
+    df_frac lookup = df_from_ints(-1998, 4);
+    df_frac same = df_from_ints(999, -2);
+    void* a = NULL;
+    void* b = NULL;
+    TEST_ASSERT_TRUE(df_map_get(m, lookup, &a));
+    TEST_ASSERT_TRUE(df_map_get(m, same, &b));
+    TEST_ASSERT_EQUAL_PTR(a, b);
+    TEST_ASSERT_EQUAL_UINT64(df_hash(lookup), df_hash(same));
+    void* c = NULL;
+    TEST_ASSERT_TRUE(df_map_get_ints(m, 1998, -4, &c));
+    TEST_ASSERT_EQUAL_PTR(a, c);
+    TEST_ASSERT_FALSE(df_map_get_ints(m, 1, 1000003, NULL));
+
+    // Iteration visits every key once
+    size_t it = 0;
+    size_t visited = 0;
+    df_frac k;
+    void* v;
+    while (df_map_next(m, &it, &k, &v)) {
+        void* found = NULL;
+        TEST_ASSERT_TRUE(df_map_get(m, k, &found));
+        TEST_ASSERT_EQUAL_PTR(v, found);
+        df_release(&k);
+        visited++;
+    }
+    TEST_ASSERT_EQUAL_size_t(df_map_size(m), visited);
+
+    // Remove every other key, including big ones
+    size_t size = df_map_size(m);
+    for (int i = 0; i < N; i += 2) {
+        if (df_map_remove(m, keys[i], NULL)) size--;
+    }
+    TEST_ASSERT_EQUAL_size_t(size, df_map_size(m));
+    for (int i = 0; i < N; i += 2) TEST_ASSERT_FALSE(df_map_get(m, keys[i], NULL));
+
+    // Memoization through the value slot
+    bool inserted = false;
+    df_frac third = df_from_ints(1, 3);
+    void** slot = df_map_slot(m, third, &inserted);
+    TEST_ASSERT_TRUE(inserted);
+    TEST_ASSERT_NULL(*slot);
+    *slot = (void*)&inserted;
+    slot = df_map_slot(m, third, &inserted);
+    TEST_ASSERT_FALSE(inserted);
+    TEST_ASSERT_EQUAL_PTR(&inserted, *slot);
+
+    for (int i = 0; i < N; i++) df_release(&keys[i]);
+    df_release(&lookup);
+    df_release(&same);
+    df_release(&third);
+    df_map_release(&m);
+    TEST_ASSERT_NULL(m);
+}
+
+// Test the fraction-keyed heap against a sorted order
+void test_heap(void) {
+    enum { N = 500 };
+    df_heap h = df_heap_new();
+    df_frac keys[N];
+    size_t handles[N];
+    for (int i = 0; i < N; i++) {
+        // Repeated values test FIFO ties; the big pair differs beyond doubles
+        if (i % 50 == 1) {
+            keys[i] = df_from_string("100000000000000000002/100000000000000000001");
+        } else if (i % 50 == 2) {
+            keys[i] = df_from_string("100000000000000000001/100000000000000000000");
+        } else {
+            keys[i] = df_from_ints((i * 7919) % 211, (i % 4) + 1);
+        }
+        handles[i] = df_heap_push(h, keys[i], (void*)(intptr_t)i);
+    }
+    TEST_ASSERT_EQUAL_size_t(N, df_heap_size(h));
+
+    // Decrease one key to the front, cancel another
+    df_frac early = df_from_ints(-1, 2);
+    df_heap_update(h, handles[123], early);
+    void* removed = NULL;
+    TEST_ASSERT_TRUE(df_heap_remove(h, handles[77], NULL, &removed));
+    TEST_ASSERT_EQUAL_INT(77, (int)(intptr_t)removed);
+    TEST_ASSERT_FALSE(df_heap_remove(h, handles[77], NULL, NULL));
+
+    df_frac first;
+    void* value;
+    TEST_ASSERT_TRUE(df_heap_pop(h, &first, &value));
+    TEST_ASSERT_EQUAL_INT(123, (int)(intptr_t)value);
+    TEST_ASSERT_TRUE(df_eq(first, early));
+    df_release(&first);
+
+    df_frac prev = NULL;
+    int prev_index = -1;
+    size_t popped = 0;
+    df_frac key;
+    while (df_heap_pop(h, &key, &value)) {
+        int index = (int)(intptr_t)value;
+        if (prev) {
+            int c = df_cmp(prev, key);
+            TEST_ASSERT_TRUE(c < 0 || (c == 0 && prev_index < index));
+        }
+        df_release(&prev);
+        prev = key;
+        prev_index = index;
+        popped++;
+    }
+    TEST_ASSERT_EQUAL_size_t(N - 2, popped);
+    TEST_ASSERT_FALSE(df_heap_peek(h, NULL, NULL));
+
+    for (int i = 0; i < N; i++) df_release(&keys[i]);
+    df_release(&prev);
+    df_release(&early);
+    df_heap_release(&h);
+}
+
+// Helper: collect visited values into an int array
+static bool collect_values(df_frac key, void* value, void* ctx) {
+    (void)key;
+    int* out = (int*)ctx;
+    out[++out[0]] = (int)(intptr_t)value;
+    return true;
+}
+
+// Test the B-tree ordered map
+void test_ordmap(void) {
+    enum { N = 3000 };
+    df_ordmap m = df_ordmap_new();
+    for (int i = 0; i < N; i++) {
+        int k = (i * 1009) % N;  // permutation of 0..N-1
+        df_frac key = df_from_ints(k, 3);
+        df_ordmap_put(m, key, (void*)(intptr_t)k);
+        df_release(&key);
+    }
+    TEST_ASSERT_EQUAL_size_t(N, df_ordmap_size(m));
+
+    // Replacing keeps the size
+    df_frac third = df_from_ints(1, 3);
+    df_ordmap_put(m, third, (void*)(intptr_t)1);
+    TEST_ASSERT_EQUAL_size_t(N, df_ordmap_size(m));
+
+    // Remove all multiples of three, then every k with k % 5 == 1
+    for (int k = 0; k < N; k++) {
+        if (k % 3 != 0 && k % 5 != 1) continue;
+        df_frac key = df_from_ints(k, 3);
+        void* value = NULL;
+        TEST_ASSERT_TRUE(df_ordmap_remove(m, key, &value));
+        TEST_ASSERT_EQUAL_INT(k, (int)(intptr_t)value);
+        TEST_ASSERT_FALSE(df_ordmap_remove(m, key, NULL));
+        df_release(&key);
+    }
+
+    int expected_size = 0;
+    for (int k = 0; k < N; k++) expected_size += k % 3 != 0 && k % 5 != 1;
+    TEST_ASSERT_EQUAL_size_t((size_t)expected_size, df_ordmap_size(m));
+
+    // Range [100/3, 200/3) visits the survivors in order
+    int* seen = (int*)malloc(sizeof(int) * (N + 1));
+    seen[0] = 0;
+    df_frac lo = df_from_ints(100, 3);
+    df_frac hi = df_from_ints(200, 3);
+    df_ordmap_range(m, lo, hi, collect_values, seen);
+    int count = 0;
+    for (int k = 100; k < 200; k++) {
+        if (k % 3 == 0 || k % 5 == 1) continue;
+        TEST_ASSERT_EQUAL_INT(k, seen[++count]);
+    }
+    TEST_ASSERT_EQUAL_INT(count, seen[0]);
+
+    // Unbounded range covers everything, and lookups agree
+    seen[0] = 0;
+    df_ordmap_range(m, NULL, NULL, collect_values, seen);
+    TEST_ASSERT_EQUAL_INT(expected_size, seen[0]);
+    for (int i = 2; i <= seen[0]; i++) TEST_ASSERT_TRUE(seen[i - 1] < seen[i]);
+    void* value = NULL;
+    TEST_ASSERT_TRUE(df_ordmap_get(m, hi, &value));
+    TEST_ASSERT_EQUAL_INT(200, (int)(intptr_t)value);
+    TEST_ASSERT_TRUE(df_ordmap_get(m, lo, NULL));
+    df_frac gone = df_from_ints(99, 3);
+    TEST_ASSERT_FALSE(df_ordmap_get(m, gone, NULL));
+
+    free(seen);
+    df_release(&gone);
+    df_release(&third);
+    df_release(&lo);
+    df_release(&hi);
+    df_ordmap_release(&m);
+}
+
+#ifdef DF_INTERN
+// Test that equal values share one instance that leaves the table with it
+void test_intern(void) {
+    size_t before = df_intern_size();
+
+    df_frac a = df_from_ints(122, 194);
+    df_frac b = df_from_ints(61, 97);
+    df_frac sixty = df_from_ints(60, 97);
+    df_frac one = df_from_ints(1, 97);
+    df_frac c = df_add(sixty, one);
+    TEST_ASSERT_EQUAL_PTR(a, b);
+    TEST_ASSERT_EQUAL_PTR(a, c);
+    TEST_ASSERT_EQUAL_size_t(3, a->ref_count);
+    TEST_ASSERT_EQUAL_size_t(before + 3, df_intern_size());
+
+    // Multi-word values are interned as well
+    df_frac big1 = df_from_string("100000000000000000000000/3");
+    df_frac big2 = df_from_string("200000000000000000000000/6");
+    TEST_ASSERT_EQUAL_PTR(big1, big2);
+    TEST_ASSERT_FALSE(df_eq(big1, a));
+    TEST_ASSERT_EQUAL_UINT64(df_hash(big1), big1->hash);
+
+    df_release(&a);
+    df_release(&b);
+    df_release(&c);
+    df_release(&sixty);
+    df_release(&one);
+    df_release(&big1);
+    df_release(&big2);
+    TEST_ASSERT_EQUAL_size_t(before, df_intern_size());
+
+    // A value built again after its last release is a fresh entry
+    df_frac again = df_from_ints(61, 97);
+    TEST_ASSERT_EQUAL_size_t(1, again->ref_count);
+    df_release(&again);
+}
+#endif
+
+#ifdef DF_STATS
+#ifdef DF_THREADS
+// Helper: Count one addition on another thread
+static void* stats_worker(void* arg) {
+    (void)arg;
+    df_frac x = df_from_ints(1, 5);
+    df_frac y = df_add(x, x);
+    df_release(&x);
+    df_release(&y);
+    return NULL;
+}
+#endif
+
+// Test per-thread operation counters and their aggregation
+void test_stats(void) {
+    df_stats s;
+    df_stats_reset();
+    df_stats_snapshot(&s);
+    TEST_ASSERT_EQUAL_UINT64(0, s.count[DF_STAT_ADD]);
+    TEST_ASSERT_EQUAL_UINT64(0, s.count[DF_STAT_ALLOC]);
+
+    // 1/3 + 1/6 reduces through a GCD; 1/2 + 1/4 is dyadic and skips it
+    df_frac third = df_from_ints(1, 3);
+    df_frac sixth = df_from_ints(1, 6);
+    df_frac half = df_from_ints(1, 2);
+    df_frac quarter = df_from_ints(1, 4);
+    df_stats_reset();
+    df_frac sum = df_add(third, sixth);
+    df_stats_snapshot(&s);
+    TEST_ASSERT_EQUAL_UINT64(1, s.count[DF_STAT_ADD]);
+    TEST_ASSERT_EQUAL_UINT64(3, s.count[DF_STAT_DI_MUL]);
+    TEST_ASSERT_EQUAL_UINT64(1, s.count[DF_STAT_GCD_EXECUTED]);
+    TEST_ASSERT_EQUAL_UINT64(0, s.count[DF_STAT_GCD_TRIVIAL]);
+    TEST_ASSERT_EQUAL_UINT64(2, s.limbs[DF_STAT_ADD][0]);
+    TEST_ASSERT_EQUAL_UINT64(6, s.limbs[DF_STAT_DI_MUL][0]);
+
+    df_stats_reset();
+    df_frac dyadic = df_add(half, quarter);
+    df_stats_snapshot(&s);
+    TEST_ASSERT_EQUAL_UINT64(0, s.count[DF_STAT_GCD_EXECUTED]);
+    TEST_ASSERT_EQUAL_UINT64(0, s.count[DF_STAT_DI_GCD]);
+
+    // Large operands land in a higher size class
+    df_frac big = df_ldexp(third, 2000);
+    df_stats_reset();
+    df_frac product = df_mul(big, big);
+    df_stats_snapshot(&s);
+    TEST_ASSERT_EQUAL_UINT64(0, s.limbs[DF_STAT_MUL][0]);
+    TEST_ASSERT_EQUAL_UINT64(2, s.limbs[DF_STAT_MUL][5] + s.limbs[DF_STAT_MUL][6]);
+    TEST_ASSERT_EQUAL_UINT64(1, s.count[DF_STAT_ALLOC]);
+    TEST_ASSERT_EQUAL_UINT64(sizeof(struct df_frac_internal), s.count[DF_STAT_ALLOC_BYTES]);
+
+    // Every public entry point has a counter
+    df_stats_reset();
+    df_frac negated = df_negate(third);
+    df_map map = df_map_new();
+    df_map_put(map, negated, NULL);
+    df_stats_snapshot(&s);
+    TEST_ASSERT_EQUAL_UINT64(1, s.count[DF_STAT_NEGATE]);
+    TEST_ASSERT_EQUAL_UINT64(1, s.count[DF_STAT_MAP_NEW]);
+    TEST_ASSERT_EQUAL_UINT64(1, s.count[DF_STAT_MAP_PUT]);
+    TEST_ASSERT_EQUAL_UINT64(0, s.count[DF_STAT_ABS]);
+    TEST_ASSERT_EQUAL_STRING("df_map_put", df_stat_name(DF_STAT_MAP_PUT));
+    df_map_release(&map);
+    df_release(&negated);
+
+#ifdef DF_THREADS
+    // Counts from finished threads remain in the totals
+    df_stats_reset();
+    pthread_t worker;
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&worker, NULL, stats_worker, NULL));
+    pthread_join(worker, NULL);
+    df_frac again = df_add(third, third);
+    df_stats_snapshot(&s);
+    TEST_ASSERT_EQUAL_UINT64(2, s.count[DF_STAT_ADD]);
+    df_release(&again);
+
+    // Later threads reuse the finished thread's block
+    size_t blocks = 0;
+    for (df_stats_block* b = df_stats_blocks; b; b = b->next) blocks++;
+    for (int i = 0; i < 16; i++) {
+        TEST_ASSERT_EQUAL_INT(0, pthread_create(&worker, NULL, stats_worker, NULL));
+        pthread_join(worker, NULL);
+    }
+    size_t after = 0;
+    for (df_stats_block* b = df_stats_blocks; b; b = b->next) after++;
+    TEST_ASSERT_EQUAL_UINT64(blocks, after);
+    df_stats_snapshot(&s);
+    TEST_ASSERT_EQUAL_UINT64(18, s.count[DF_STAT_ADD]);
+#endif
+
+    df_stats_reset();
+    df_release(&third);
+    df_release(&sixth);
+    df_release(&half);
+    df_release(&quarter);
+    df_release(&sum);
+    df_release(&dyadic);
+    df_release(&big);
+    df_release(&product);
+    df_stats_snapshot(&s);
+    TEST_ASSERT_EQUAL_UINT64(8, s.count[DF_STAT_FREE]);
+    TEST_ASSERT_EQUAL_STRING("gcd_skipped", df_stat_name(DF_STAT_GCD_SKIPPED));
+
+    // Both dump formats name the counters that were hit
+    FILE* out = tmpfile();
+    TEST_ASSERT_NOT_NULL(out);
+    df_stats_dump(out, true);
+    df_stats_dump(out, false);
+    char text[4096];
+    size_t len = 0;
+    rewind(out);
+    len = fread(text, 1, sizeof(text) - 1, out);
+    text[len] = '\0';
+    fclose(out);
+    TEST_ASSERT_NOT_NULL(strstr(text, "\"free\": 8"));
+    TEST_ASSERT_NOT_NULL(strstr(text, "\"df_add\": 0"));
+    TEST_ASSERT_NOT_NULL(strstr(text, "free_bytes"));
+}
+#endif
+
+#ifdef DF_LATENCY
+// Test latency histograms keyed by operation and operand size
+void test_latency(void) {
+    df_frac third = df_from_ints(1, 3);
+    df_frac big = df_ldexp(third, 2000);
+    df_stats_reset();
+    for (int i = 0; i < 100; i++) {
+        df_frac sum = df_add(third, third);
+        df_release(&sum);
+    }
+    for (int i = 0; i < 3; i++) {
+        df_frac product = df_mul(big, big);
+        df_release(&product);
+    }
+
+    df_latency* h = (df_latency*)malloc(sizeof(df_latency));
+    TEST_ASSERT_NOT_NULL(h);
+    df_latency_snapshot(h);
+    uint64_t small = 0, large = 0;
+    for (size_t b = 0; b < DF_LATENCY_BUCKETS; b++) {
+        small += h->count[DF_STAT_ADD][0][b];
+        large += h->count[DF_STAT_MUL][5][b] + h->count[DF_STAT_MUL][6][b];
+    }
+    TEST_ASSERT_EQUAL_UINT64(100, small);
+    TEST_ASSERT_EQUAL_UINT64(3, large);
+
+    // Quantiles are monotone and capped by the slowest sample
+    uint64_t p50 = df_latency_quantile(h, DF_STAT_ADD, 0, 0.5);
+    uint64_t p99 = df_latency_quantile(h, DF_STAT_ADD, 0, 0.99);
+    uint64_t max = df_latency_quantile(h, DF_STAT_ADD, 0, 1.0);
+    TEST_ASSERT_TRUE(p50 <= p99 && p99 <= max);
+    TEST_ASSERT_EQUAL_UINT64(h->max_ns[DF_STAT_ADD][0], max);
+    TEST_ASSERT_EQUAL_UINT64(0, df_latency_quantile(h, DF_STAT_DIV, 0, 0.5));
+
+    // A zero interval dumps after every timed operation until stopped
+    FILE* out = tmpfile();
+    TEST_ASSERT_NOT_NULL(out);
+    df_latency_dump_every(out, 0, true);
+    df_frac diff = df_sub(big, third);
+    df_latency_dump_every(NULL, 0, false);
+    df_frac again = df_sub(big, third);
+    char text[8192];
+    rewind(out);
+    size_t len = fread(text, 1, sizeof(text) - 1, out);
+    text[len] = '\0';
+    fclose(out);
+    TEST_ASSERT_NOT_NULL(strstr(text, "{\"op\": \"df_add\", \"limbs\": \"<=1\", \"count\": 100,"));
+    TEST_ASSERT_NOT_NULL(strstr(text, "\"op\": \"df_sub\""));
+    TEST_ASSERT_NULL(strstr(strchr(text, '\n') + 1, "\"op\""));
+
+    free(h);
+    df_release(&diff);
+    df_release(&again);
+    df_release(&third);
+    df_release(&big);
+}
+#endif
+
+#ifdef DF_TRACE
+// Test that operations are recorded with values on first sight
+void test_trace(void) {
+    df_frac before = df_from_ints(3, 4);
+    df_frac untraced = df_add(before, before);
+
+    // Kept in the build directory for the replay test
+    TEST_ASSERT_TRUE(df_trace_open("df_trace_test.dft"));
+    df_frac a = df_from_ints(-1, 3);
+    df_frac big = df_from_string("100000000000000000000000/7");
+    df_frac sum = df_add(a, before);
+    df_frac product = df_mul(sum, big);
+    df_frac neg = df_negate(product);
+    TEST_ASSERT_EQUAL_INT(1, df_cmp(big, neg));
+    TEST_ASSERT_FALSE(df_eq(a, before));
+    df_release(&sum);
+    df_release(&product);
+    df_trace_close();
+
+    FILE* in = fopen("df_trace_test.dft", "rb");
+    TEST_ASSERT_NOT_NULL(in);
+    unsigned char buf[256];
+    size_t len = fread(buf, 1, sizeof(buf), in);
+    fclose(in);
+
+    // Magic, then -1/3 and 3/4 as small values ahead of the addition
+    const unsigned char head[] = {'D', 'F', 'T', 'R', 'A', 'C', 'E', '1',
+                                  DF_TRACE_VALUE, 1, 0, 1, 6,
+                                  DF_TRACE_VALUE, 2, 0, 6, 8,
+                                  DF_TRACE_ADD, 1, 2, 3};
+    TEST_ASSERT_TRUE(len > sizeof(head));
+    TEST_ASSERT(memcmp(head, buf, sizeof(head)) == 0);
+
+    // The big operand is written as text before the multiplication
+    const unsigned char big_value[] = {DF_TRACE_VALUE, 4, 1, 26};
+    TEST_ASSERT(memcmp(big_value, buf + sizeof(head), sizeof(big_value)) == 0);
+    TEST_ASSERT(memcmp("100000000000000000000000/7", buf + sizeof(head) + sizeof(big_value), 26) == 0);
+
+    // cmp of 4 with 6 gave 1 (zigzag 2), then the two releases
+    const unsigned char tail[] = {DF_TRACE_CMP, 4, 6, 2, DF_TRACE_EQ, 1, 2, 0,
+                                  DF_TRACE_RELEASE, 3, DF_TRACE_RELEASE, 5};
+    TEST_ASSERT(memcmp(tail, buf + len - sizeof(tail), sizeof(tail)) == 0);
+
+    df_release(&before);
+    df_release(&untraced);
+    df_release(&a);
+    df_release(&big);
+    df_release(&neg);
+}
+#endif
+
 int main(void) {
     UNITY_BEGIN();
 
@@ -673,5 +2246,88 @@ int main(void) {
     RUN_TEST(test_fits);
     RUN_TEST(test_parts);
 
+    // Series tests
+    RUN_TEST(test_series);
+    RUN_TEST(test_bernoulli);
+
+    // Continued fraction tests
+    RUN_TEST(test_continued_fraction);
+    RUN_TEST(test_cf_iter);
+
+    // Filtered comparison tests
+    RUN_TEST(test_filtered_cmp);
+
+    // Decimal tests
+    RUN_TEST(test_decimal);
+    RUN_TEST(test_decimal_frac);
+
+    // Dyadic fraction tests
+    RUN_TEST(test_dyadic);
+
+    // Exact accumulation tests
+    RUN_TEST(test_sum_doubles);
+    RUN_TEST(test_dot_doubles);
+
+    // Power-of-two scaling tests
+    RUN_TEST(test_ldexp_frexp);
+
+    // Rounding tests
+    RUN_TEST(test_rescale);
+
+    // Quantization tests
+    RUN_TEST(test_quantize);
+
+    // Geometric predicate tests
+    RUN_TEST(test_geometry);
+
+    // Column tests
+    RUN_TEST(test_column);
+
+    // Column aggregation tests
+    RUN_TEST(test_column_aggregates);
+
+    // Bulk reduction tests
+    RUN_TEST(test_sum);
+    RUN_TEST(test_tree_reduction);
+
+    // Prefix sum tests
+    RUN_TEST(test_prefix_sum);
+
+    // Common denominator tests
+    RUN_TEST(test_common_denominator);
+
+    // Sort and selection tests
+    RUN_TEST(test_sort_select);
+
+    // Bucketing tests
+    RUN_TEST(test_bucketize);
+
+    // Hash map tests
+    RUN_TEST(test_map);
+
+    // Ordered container tests
+    RUN_TEST(test_heap);
+    RUN_TEST(test_ordmap);
+
+#ifdef DF_INTERN
+    // Interning tests
+    RUN_TEST(test_intern);
+#endif
+
+#ifdef DF_STATS
+    // Statistics tests
+    RUN_TEST(test_stats);
+#endif
+
+#ifdef DF_LATENCY
+    // Latency histogram tests
+    RUN_TEST(test_latency);
+#endif
+
+#ifdef DF_TRACE
+    // Tracing tests
+    RUN_TEST(test_trace);
+#endif
+
     return UNITY_END();
 }
\ No newline at end of file